@@ -0,0 +1,211 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "PhiloxSIMD.h"
+#include "Uniform.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace at {
+
+/**
+ * Note [Alias tables]
+ * ~~~~~~~~~~~~~~~~~~~
+ * Refer to: Vose, "A Linear Algorithm for Generating Random Numbers with
+ * a Given Distribution", IEEE TSE 17 (1991).
+ *
+ * A categorical distribution over n outcomes becomes n columns, column i
+ * holding outcome i up to a threshold and one other outcome, its alias,
+ * above it. A sample takes two 32-bit words: the first picks a column as
+ * the high half of word * n, the second is a coin that keeps i when it is
+ * below the column's threshold and takes the alias otherwise. Sampling is
+ * O(1) whatever the distribution, and building the table is O(n).
+ *
+ * Multiply-shift gives column i to either floor(2^32 / n) or
+ * ceil(2^32 / n) words, not quite 1 / n each. The builder sizes every
+ * column by its actual share of the words, so this bias is absorbed into
+ * the thresholds. The only error left is rounding each threshold to
+ * 32 bits, at most 2^-33 of a column.
+ *
+ * Threshold and alias share one 64-bit entry, so a sample reads one
+ * place in the table. Bulk sampling takes the words in groups of 16: the
+ * first eight pick the columns of eight samples and the next eight are
+ * their coins. The eight entries are fetched with two AVX2 gathers.
+ * philox_simd_engine runs this on next32's registers, 16 samples per
+ * block. Other engines buffer words through detail::random_bits, so any
+ * engine gives the same samples as its words would on philox_simd_engine.
+ * A count that is not a multiple of eight still draws the whole group of
+ * its last samples, and for philox_simd_engine the whole block.
+ */
+
+namespace detail {
+
+/**
+ * The high halves of the eight products x * n
+ */
+static inline __m256i multiply_high(__m256i x, __m256i n) {
+  // mul_epu32 multiplies the even lanes, so the odd ones are shifted down first
+  __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, n), 32);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), n);
+  return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+} // namespace detail
+
+class alias_table {
+public:
+  /**
+   * Outcome i has probability weights[i] / sum(weights). Weights must be
+   * finite and non-negative with a positive sum, and there must be fewer
+   * than 2^31 of them, the gathers take signed indices.
+   */
+  inline explicit alias_table(const std::vector<double>& weights) : n_(static_cast<uint32_t>(weights.size())) {
+    if (weights.empty() || weights.size() > 0x7FFFFFFFULL) {
+      throw std::runtime_error("alias_table needs between 1 and 2^31 - 1 weights");
+    }
+    double sum = 0;
+    for (double w : weights) {
+      if (!(w >= 0.0 && std::isfinite(w))) {
+        throw std::runtime_error("alias_table weights must be finite and non-negative");
+      }
+      sum += w;
+    }
+    if (!(sum > 0.0 && std::isfinite(sum))) {
+      throw std::runtime_error("alias_table weights must have a finite positive sum");
+    }
+    // mass of every outcome and capacity of every column, both in words
+    std::vector<double> mass(n_), capacity(n_);
+    std::vector<uint32_t> small, large;
+    for (uint32_t i = 0; i < n_; i++) {
+      mass[i] = weights[i] / sum * 4294967296.0;
+      capacity[i] = static_cast<double>(column_start(i + 1) - column_start(i));
+      (mass[i] < capacity[i] ? small : large).push_back(i);
+    }
+    table_.resize(n_);
+    while (!small.empty() && !large.empty()) {
+      uint32_t s = small.back(), l = large.back();
+      small.pop_back();
+      // s keeps mass[s] of its column and l fills the rest
+      table_[s] = entry(mass[s] / capacity[s], s, l);
+      mass[l] -= capacity[s] - mass[s];
+      if (mass[l] < capacity[l]) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    // whatever is left is full up to rounding
+    for (uint32_t i : small) {
+      table_[i] = entry(1.0, i, i);
+    }
+    for (uint32_t i : large) {
+      table_[i] = entry(1.0, i, i);
+    }
+  }
+
+  inline uint32_t size() const {
+    return n_;
+  }
+
+  /**
+   * One sample, a column word then a coin word
+   */
+  template <typename engine_t>
+  inline uint32_t operator()(engine_t& gen) const {
+    uint32_t column = static_cast<uint32_t>((static_cast<uint64_t>(detail::random_word(gen)) * n_) >> 32);
+    uint32_t coin = detail::random_word(gen);
+    uint64_t e = table_[column];
+    return coin < static_cast<uint32_t>(e) ? column : static_cast<uint32_t>(e >> 32);
+  }
+
+  /**
+   * Writes count samples to dst, see Note [Alias tables]
+   */
+  template <typename engine_t>
+  inline void sample(engine_t& gen, uint32_t* dst, uint64_t count) const {
+    uint32_t words[kUniformBatch];
+    for (uint64_t i = 0; i < count; i += kUniformBatch / 2) {
+      uint64_t samples = std::min<uint64_t>(kUniformBatch / 2, count - i);
+      uint64_t groups = (samples + 7) / 8;
+      detail::random_bits(gen, words, 16 * groups);
+      for (uint64_t g = 0; g < groups; g++) {
+        __m256i columns = _mm256_loadu_si256((const __m256i*)(words + 16 * g));
+        __m256i coins = _mm256_loadu_si256((const __m256i*)(words + 16 * g + 8));
+        store(dst + i + 8 * g, std::min<uint64_t>(8, samples - 8 * g), lookup(columns, coins));
+      }
+    }
+  }
+
+  inline void sample(philox_simd_engine& gen, uint32_t* dst, uint64_t count) const {
+    for (uint64_t i = 0; i < count; i += 16) {
+      __m256i out[4];
+      gen.next32(out[0], out[1], out[2], out[3]);
+      store(dst + i, std::min<uint64_t>(8, count - i), lookup(out[0], out[1]));
+      if (i + 8 < count) {
+        store(dst + i + 8, std::min<uint64_t>(8, count - i - 8), lookup(out[2], out[3]));
+      }
+    }
+  }
+
+private:
+  uint32_t n_;
+  // threshold in the low half, alias in the high half
+  std::vector<uint64_t> table_;
+
+  /**
+   * First word of column i, ceil(i * 2^32 / n)
+   */
+  inline uint64_t column_start(uint64_t i) const {
+    return ((i << 32) + n_ - 1) / n_;
+  }
+
+  /**
+   * Keeps column i with probability keep and takes alias otherwise
+   */
+  static inline uint64_t entry(double keep, uint32_t i, uint32_t alias) {
+    // keep can come out a hair below 0 after the subtractions above
+    double threshold = std::round(std::max(0.0, keep) * 4294967296.0);
+    if (threshold >= 4294967296.0) {
+      // always kept, whatever the coin
+      return 0xFFFFFFFFULL | (static_cast<uint64_t>(i) << 32);
+    }
+    return static_cast<uint64_t>(threshold) | (static_cast<uint64_t>(alias) << 32);
+  }
+
+  inline __m256i lookup(__m256i column_words, __m256i coins) const {
+    __m256i columns = detail::multiply_high(column_words, _mm256_set1_epi32(static_cast<int>(n_)));
+    const long long* table = reinterpret_cast<const long long*>(table_.data());
+    __m256i lo = _mm256_i32gather_epi64(table, _mm256_castsi256_si128(columns), 8);
+    __m256i hi = _mm256_i32gather_epi64(table, _mm256_extracti128_si256(columns, 1), 8);
+    // thresholds to the low 128 bits and aliases to the high ones
+    const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    lo = _mm256_permutevar8x32_epi32(lo, split);
+    hi = _mm256_permutevar8x32_epi32(hi, split);
+    __m256i thresholds = _mm256_permute2x128_si256(lo, hi, 0x20);
+    __m256i aliases = _mm256_permute2x128_si256(lo, hi, 0x31);
+    // coin >= threshold, unsigned, takes the alias
+    __m256i taken = _mm256_cmpeq_epi32(_mm256_max_epu32(coins, thresholds), coins);
+    return _mm256_blendv_epi8(columns, aliases, taken);
+  }
+
+  static inline void store(uint32_t* dst, uint64_t count, __m256i v) {
+    if (count == 8) {
+      _mm256_storeu_si256((__m256i*)dst, v);
+    } else {
+      uint32_t lanes[8];
+      _mm256_storeu_si256((__m256i*)lanes, v);
+      std::copy(lanes, lanes + count, dst);
+    }
+  }
+};
+
+} // namespace at
@@ -0,0 +1,385 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "PhiloxSIMD.h"
+#include "SIMDMath.h"
+#include "Uniform.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace at {
+
+/**
+ * Note [Bernoulli masks]
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ * Element i of a mask is 1 with probability p. All three layouts are made
+ * from 32-bit mask words, bit j of word k being element 32 * k + j:
+ *
+ *   bernoulli_bits:  the mask words themselves, (n + 31) / 32 of them, with
+ *                    the bits past n in the last word cleared
+ *   bernoulli_bytes: one uint8_t 0 or 1 per element
+ *   bernoulli_float: one float 0 or scale per element, e.g. 1 / (1 - p)
+ *                    for the kept elements of dropout
+ *
+ * so the three give the same mask from engines in the same state.
+ *
+ * p = 0.5 uses the random words as mask words, one bit per element.
+ * Any other p compares one word per element against t = round(p * 2^32),
+ * making element i a 1 when word i < t, so p is exact to within 2^-33.
+ * For philox_simd_engine each next32 block is one mask word: four
+ * compares and four movemasks on its registers. Other engines
+ * buffer words through detail::random_bits, which for philox_simd_engine
+ * at p = 0.5 also drops the rest of the last block. p = 0 and p = 1 draw
+ * nothing, p outside [0, 1] throws.
+ *
+ * Byte and float masks expand mask words in registers: the word is
+ * broadcast, every lane picks out its bit with an and, and a compare turns
+ * that into a full lane mask.
+ */
+
+/**
+ * Note [Geometric skipping]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~
+ * For small p most of a mask is zeros, and bernoulli_indices produces
+ * the positions of the ones directly instead. The number of zeros before
+ * the next one is geometric, G = floor(log(u) / log(1 - p)) for u uniform
+ * in (0, 1], so each selected element costs one uniform and one log rather
+ * than 1 / p mask elements.
+ *
+ * The uniforms come from uniform_float over (0, 1], so any engine works
+ * and philox_simd_engine converts straight out of next32. The logs are
+ * simd::log eight at a time; only the running sum of the gaps is scalar.
+ * Batches hold the expected number of gaps still needed, so short arrays
+ * don't pay for kUniformBatch logs. Leftover gaps of the last batch are
+ * dropped. A gap costs about as much as three to four elements of
+ * bernoulli_bits plus a scan of its set bits, so skipping is the faster
+ * way to get indices below p = 0.25 or so.
+ *
+ * A float uniform has 24 bits, so a gap is never longer than about 16.6 / p
+ * (probability 2^-24), and gaps beyond 2^24 are rounded to a float. Neither
+ * matters unless p is below about 10^-6.
+ */
+
+/**
+ * Note [Bernoulli mask ranges]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * philox_simd_engine is counter based, so any mask word can be made on its
+ * own: for p = 0.5 word k is word k % 32 of the block at offset
+ * 8 * (k / 32), for any other p it is the block at offset 8 * k. The
+ * *_range functions take (seed, subsequence, offset) in place of an engine
+ * and make elements [begin, begin + n) of the mask that bernoulli_bits,
+ * bernoulli_bytes or bernoulli_float give from
+ *
+ *   philox_simd_engine(seed, subsequence, offset)
+ *
+ * e.g. so that the backward pass of dropout can remake the mask of the
+ * forward pass, any part of it on any thread, rather than store it. The
+ * mask words are made kBernoulliWords at a time, each batch from an engine
+ * started at its first word; a batch not starting on a block at p = 0.5
+ * draws its first block in full.
+ */
+
+namespace detail {
+
+// mask words per chunk of the byte and float masks, a whole next32 block at
+// p = 0.5 so that they draw the same words as bernoulli_bits
+constexpr uint64_t kBernoulliWords = 32;
+
+static inline void check_probability(double p) {
+  if (!(p >= 0.0 && p <= 1.0)) {
+    throw std::runtime_error("bernoulli probability must be between 0 and 1");
+  }
+}
+
+/**
+ * round(p * 2^32), where 2^32 means every element is 1
+ */
+static inline uint64_t bernoulli_threshold(double p) {
+  check_probability(p);
+  return static_cast<uint64_t>(std::llround(std::ldexp(p, 32)));
+}
+
+/**
+ * Writes count mask words to dst for a threshold strictly between 0 and 2^32
+ */
+template <typename engine_t>
+static inline void bernoulli_words(engine_t& gen, uint32_t* dst, uint64_t count, uint64_t threshold) {
+  if (threshold == (1ULL << 31)) {
+    random_bits(gen, dst, count);
+    return;
+  }
+  const uint32_t t = static_cast<uint32_t>(threshold);
+  uint32_t bits[kUniformBatch];
+  for (uint64_t i = 0; i < count; i += kUniformBatch / 32) {
+    uint64_t words = std::min<uint64_t>(kUniformBatch / 32, count - i);
+    random_bits(gen, bits, 32 * words);
+    for (uint64_t k = 0; k < words; k++) {
+      uint32_t mask = 0;
+      for (int j = 0; j < 32; j++) {
+        mask |= static_cast<uint32_t>(bits[32 * k + j] < t) << j;
+      }
+      dst[i + k] = mask;
+    }
+  }
+}
+
+static inline void bernoulli_words(philox_simd_engine& gen, uint32_t* dst, uint64_t count, uint64_t threshold) {
+  if (threshold == (1ULL << 31)) {
+    random_bits(gen, dst, count);
+    return;
+  }
+  // word < t unsigned, as a signed compare with both sign bits flipped
+  const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000U));
+  const __m256i t = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(threshold) ^ 0x80000000U));
+  auto mask_word = [&](const __m256i (&out)[4]) {
+    uint32_t mask = 0;
+    for (int j = 0; j < 4; j++) {
+      __m256i below = _mm256_cmpgt_epi32(t, _mm256_xor_si256(out[j], sign));
+      mask |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(below))) << (8 * j);
+    }
+    return mask;
+  };
+  __m256i out[2][4];
+  uint64_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    gen.next32_unrolled(out);
+    dst[i] = mask_word(out[0]);
+    dst[i + 1] = mask_word(out[1]);
+  }
+  if (i < count) {
+    gen.next32(out[0][0], out[0][1], out[0][2], out[0][3]);
+    dst[i] = mask_word(out[0]);
+  }
+}
+
+/**
+ * Mask words for any threshold, including all zeros and all ones
+ */
+template <typename engine_t>
+static inline void bernoulli_mask_words(engine_t& gen, uint32_t* dst, uint64_t count, uint64_t threshold) {
+  if (threshold == 0 || threshold == (1ULL << 32)) {
+    std::fill(dst, dst + count, threshold == 0 ? 0U : 0xFFFFFFFFU);
+  } else {
+    bernoulli_words(gen, dst, count, threshold);
+  }
+}
+
+/**
+ * Mask words [first, first + count) of the mask of (seed, subsequence,
+ * offset), see Note [Bernoulli mask ranges]
+ */
+static inline void bernoulli_mask_words_at(uint64_t seed, uint64_t subsequence, uint64_t offset, uint32_t* dst, uint64_t first,
+                                           uint64_t count, uint64_t threshold) {
+  if (threshold != (1ULL << 31)) {
+    philox_simd_engine gen(seed, subsequence, offset + 8 * first);
+    bernoulli_mask_words(gen, dst, count, threshold);
+    return;
+  }
+  philox_simd_engine gen(seed, subsequence, offset + 8 * (first / 32));
+  uint64_t skip = first % 32, i = 0;
+  if (skip != 0) {
+    uint32_t block[32];
+    random_bits(gen, block, 32);
+    i = std::min<uint64_t>(count, 32 - skip);
+    std::copy(block + skip, block + skip + i, dst);
+  }
+  random_bits(gen, dst + i, count - i);
+}
+
+/**
+ * 32 bytes, byte j is bit j of mask
+ */
+static inline __m256i expand_bytes(uint32_t mask) {
+  // byte j of every lane takes byte j / 8 of the mask, then keeps bit j % 8 of it
+  const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                          2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+  const __m256i bit = _mm256_set1_epi64x(static_cast<int64_t>(0x8040201008040201ULL));
+  __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(mask)), spread);
+  __m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit), bit);
+  return _mm256_and_si256(set, _mm256_set1_epi8(1));
+}
+
+/**
+ * 8 floats, float j is scale if bit j of mask is set and 0 otherwise
+ */
+static inline __m256 expand_floats(uint32_t mask, __m256 scale) {
+  const __m256i bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  __m256i set = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bit), bit);
+  return _mm256_and_ps(_mm256_castsi256_ps(set), scale);
+}
+
+} // namespace detail
+
+/**
+ * Writes the (n + 31) / 32 words of a packed mask to dst,
+ * see Note [Bernoulli masks]
+ */
+template <typename engine_t>
+static inline void bernoulli_bits(engine_t& gen, uint32_t* dst, uint64_t n, double p) {
+  uint64_t threshold = detail::bernoulli_threshold(p);
+  uint64_t words = (n + 31) / 32;
+  detail::bernoulli_mask_words(gen, dst, words, threshold);
+  if (n % 32) {
+    dst[words - 1] &= (1U << (n % 32)) - 1;
+  }
+}
+
+/**
+ * Writes n bytes, each 1 with probability p and 0 otherwise,
+ * see Note [Bernoulli masks]
+ */
+template <typename engine_t>
+static inline void bernoulli_bytes(engine_t& gen, uint8_t* dst, uint64_t n, double p) {
+  uint64_t threshold = detail::bernoulli_threshold(p);
+  uint32_t masks[detail::kBernoulliWords];
+  for (uint64_t i = 0; i < n; i += 32 * detail::kBernoulliWords) {
+    uint64_t count = std::min<uint64_t>(32 * detail::kBernoulliWords, n - i);
+    detail::bernoulli_mask_words(gen, masks, (count + 31) / 32, threshold);
+    uint64_t j = 0;
+    for (; j + 32 <= count; j += 32) {
+      _mm256_storeu_si256((__m256i*)(dst + i + j), detail::expand_bytes(masks[j / 32]));
+    }
+    for (; j < count; j++) {
+      dst[i + j] = (masks[j / 32] >> (j % 32)) & 1;
+    }
+  }
+}
+
+/**
+ * Writes n floats, each scale with probability p and 0 otherwise,
+ * see Note [Bernoulli masks]
+ */
+template <typename engine_t>
+static inline void bernoulli_float(engine_t& gen, float* dst, uint64_t n, double p, float scale = 1.0f) {
+  uint64_t threshold = detail::bernoulli_threshold(p);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  uint32_t masks[detail::kBernoulliWords];
+  for (uint64_t i = 0; i < n; i += 32 * detail::kBernoulliWords) {
+    uint64_t count = std::min<uint64_t>(32 * detail::kBernoulliWords, n - i);
+    detail::bernoulli_mask_words(gen, masks, (count + 31) / 32, threshold);
+    uint64_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+      _mm256_storeu_ps(dst + i + j, detail::expand_floats(masks[j / 32] >> (j % 32), scale_v));
+    }
+    for (; j < count; j++) {
+      dst[i + j] = ((masks[j / 32] >> (j % 32)) & 1) ? scale : 0.0f;
+    }
+  }
+}
+
+/**
+ * Writes the (n + 31) / 32 words of elements [begin, begin + n) of the
+ * packed mask of (seed, subsequence, offset), bit j of word k being element
+ * begin + 32 * k + j, see Note [Bernoulli mask ranges]
+ */
+static inline void bernoulli_bits_range(uint64_t seed, uint64_t subsequence, uint64_t offset, uint32_t* dst, uint64_t begin, uint64_t n,
+                                        double p) {
+  uint64_t threshold = detail::bernoulli_threshold(p);
+  uint64_t words = (n + 31) / 32;
+  uint64_t shift = begin % 32;
+  uint32_t masks[detail::kBernoulliWords + 1];
+  for (uint64_t k = 0; k < words; k += detail::kBernoulliWords) {
+    uint64_t count = std::min<uint64_t>(detail::kBernoulliWords, words - k);
+    if (shift == 0) {
+      detail::bernoulli_mask_words_at(seed, subsequence, offset, dst + k, begin / 32 + k, count, threshold);
+      continue;
+    }
+    // every output word straddles two mask words
+    detail::bernoulli_mask_words_at(seed, subsequence, offset, masks, begin / 32 + k, count + 1, threshold);
+    for (uint64_t j = 0; j < count; j++) {
+      dst[k + j] = (masks[j] >> shift) | (masks[j + 1] << (32 - shift));
+    }
+  }
+  if (n % 32) {
+    dst[words - 1] &= (1U << (n % 32)) - 1;
+  }
+}
+
+/**
+ * dst[i] = src[i] * scale where element begin + i of the mask of (seed,
+ * subsequence, offset) is 1 and 0 otherwise, for i in [0, n), see
+ * Note [Bernoulli mask ranges]. The same as bernoulli_float with scale
+ * times src, without the mask ever being stored.
+ */
+static inline void bernoulli_mul_range(uint64_t seed, uint64_t subsequence, uint64_t offset, const float* src, float* dst, uint64_t begin,
+                                       uint64_t n, double p, float scale = 1.0f) {
+  uint64_t threshold = detail::bernoulli_threshold(p);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  uint32_t masks[detail::kBernoulliWords];
+  const uint64_t end = begin + n;
+  for (uint64_t g = begin; g < end;) {
+    uint64_t first = g / 32;
+    uint64_t stop = std::min(end, 32 * (first + detail::kBernoulliWords));
+    detail::bernoulli_mask_words_at(seed, subsequence, offset, masks, first, (stop + 31) / 32 - first, threshold);
+    // element j of the stream is bit j % 32 of masks[j / 32 - first]
+    uint64_t j = g;
+    for (; j < stop && j % 8 != 0; j++) {
+      dst[j - begin] = src[j - begin] * (((masks[j / 32 - first] >> (j % 32)) & 1) ? scale : 0.0f);
+    }
+    for (; j + 8 <= stop; j += 8) {
+      __m256 kept = detail::expand_floats(masks[j / 32 - first] >> (j % 32), scale_v);
+      _mm256_storeu_ps(dst + (j - begin), _mm256_mul_ps(kept, _mm256_loadu_ps(src + (j - begin))));
+    }
+    for (; j < stop; j++) {
+      dst[j - begin] = src[j - begin] * (((masks[j / 32 - first] >> (j % 32)) & 1) ? scale : 0.0f);
+    }
+    g = stop;
+  }
+}
+
+/**
+ * Replaces the contents of indices with the positions in [0, n) of the
+ * ones of a mask, in increasing order, see Note [Geometric skipping]
+ */
+template <typename engine_t>
+static inline void bernoulli_indices(engine_t& gen, uint64_t n, double p, std::vector<uint64_t>& indices) {
+  detail::check_probability(p);
+  indices.clear();
+  if (p == 0.0 || n == 0) {
+    return;
+  }
+  if (p == 1.0) {
+    indices.resize(n);
+    for (uint64_t i = 0; i < n; i++) {
+      indices[i] = i;
+    }
+    return;
+  }
+  indices.reserve(static_cast<size_t>(n * p + 4 * std::sqrt(n * p) + 1));
+  const __m256 scale = _mm256_set1_ps(static_cast<float>(1.0 / std::log1p(-p)));
+  // keeps the conversion to uint64_t defined, NaN from 0 * inf becomes 0
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 longest = _mm256_set1_ps(9.2e18f);
+  float gaps[kUniformBatch];
+  uint64_t pos = 0;
+  for (;;) {
+    // the expected number of gaps left plus a margin, in multiples of 32
+    double expected = (n - pos) * p;
+    uint64_t batch = std::min<uint64_t>(kUniformBatch, (static_cast<uint64_t>(expected + std::sqrt(expected)) + 32) & ~31ULL);
+    uniform_float(gen, gaps, batch, 0.0f, 1.0f, uniform_interval::open_closed);
+    for (uint64_t j = 0; j < batch; j += 8) {
+      __m256 g = _mm256_mul_ps(simd::log(_mm256_loadu_ps(gaps + j)), scale);
+      _mm256_storeu_ps(gaps + j, _mm256_min_ps(_mm256_max_ps(g, zero), longest));
+    }
+    for (uint64_t j = 0; j < batch; j++) {
+      uint64_t gap = static_cast<uint64_t>(gaps[j]);
+      if (gap >= n - pos) {
+        return;
+      }
+      pos += gap;
+      indices.push_back(pos++);
+    }
+  }
+}
+
+} // namespace at
@@ -0,0 +1,524 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "SIMDMath.h"
+#include "Uniform.h"
+#include "Ziggurat.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace at {
+
+/**
+ * Note [Gamma, Poisson and binomial sampling]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Refer to: Marsaglia & Tsang, "A Simple Method for Generating Gamma
+ * Variables", ACM TOMS 26 (2000); Hormann, "The Transformed Rejection
+ * Method for Generating Poisson Random Variables", IME 12 (1993);
+ * Kachitvichyanukul & Schmeiser, "Binomial Random Variate Generation",
+ * CACM 31 (1988).
+ *
+ * All three are rejection samplers whose first test accepts most draws:
+ *
+ *   gamma_float  Marsaglia-Tsang, d * (1 + c x)^3 for a normal x, kept
+ *                when u < 1 - 0.0331 x^4, about 98% of the time for
+ *                alpha >= 1. alpha < 1 samples alpha + 1 and multiplies
+ *                by u^(1 / alpha).
+ *   poisson      PTRS for lambda >= 10, kept when us >= 0.07 and
+ *                v <= v_r, about 86% of the time or more.
+ *   binomial     BTPE for n * min(p, 1 - p) >= 10, kept when the point
+ *                falls in the central triangle, between about 60% and 90%
+ *                of the time depending on n * p.
+ *
+ * That first test runs on eight floats (gamma) or four doubles (poisson,
+ * binomial). Lanes that fail it are finished by the scalar algorithm
+ * from the paper, which starts from the lane's own draws and draws more
+ * as needed. Below the PTRS and BTPE thresholds the Poisson and binomial
+ * go through a table of the cumulative distribution scaled to 2^32, and
+ * a 32-bit word counts how many entries it is at or above: one word and a
+ * compare per likely outcome for eight samples at a time. Outcomes past
+ * the point where the table reaches 1 - 2^-33 are folded into the last
+ * one.
+ *
+ * Everything is drawn through detail::word_buffer (Note [Ziggurat
+ * sampling]), eight words at a time for the vector paths and one at a
+ * time for the fallbacks, so any engine in this repo can drive them.
+ * Normals come from the ziggurat, uniforms from the mantissa conversions
+ * of Note [Uniform real conversion], as floats in (0, 1] or as doubles
+ * in (0, 1] from pairs of words. Samples are made eight or four at a
+ * time, so the last group may draw for a few samples that are not
+ * written. The buffer draws kUniformBatch words at a time and skips the
+ * up to seven words left in it when eight are needed, so a call handed an
+ * engine drops what is left of its last batch: gamma_float(gen, dst, 8)
+ * takes 256 words from gen however few the eight samples use. Small calls
+ * should pass the same detail::word_buffer each time instead, which keeps
+ * the leftover words for the next call. The inversion tables take exactly
+ * one word per sample either way.
+ */
+
+namespace detail {
+
+template <typename engine_t>
+static inline __m256 uniform_float8(word_buffer<engine_t>& words, const uniform_params<float>& p) {
+  return uniform_float_avx2<true>(_mm256_loadu_si256((const __m256i*)words.next8()), p);
+}
+
+template <typename engine_t>
+static inline __m256d uniform_double4(word_buffer<engine_t>& words, const uniform_params<double>& p) {
+  return uniform_double_avx2<true>(_mm256_loadu_si256((const __m256i*)words.next8()), p);
+}
+
+/**
+ * The low halves of four 64-bit lanes
+ */
+static inline __m128i low_halves(__m256i x) {
+  return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+
+/**
+ * Stores count of the lanes, all of them when count is at least the lane count
+ */
+static inline void store_lanes(float* dst, uint64_t count, __m256 v) {
+  if (count >= 8) {
+    _mm256_storeu_ps(dst, v);
+  } else {
+    float lanes[8];
+    _mm256_storeu_ps(lanes, v);
+    std::copy(lanes, lanes + count, dst);
+  }
+}
+
+static inline void store_lanes(uint32_t* dst, uint64_t count, __m128i v) {
+  if (count >= 4) {
+    _mm_storeu_si128((__m128i*)dst, v);
+  } else {
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, v);
+    std::copy(lanes, lanes + count, dst);
+  }
+}
+
+/**
+ * Cumulative distribution of the outcomes 0, 1, ..., scaled to 2^32, for
+ * sampling by inversion. The probabilities are given as p(0) and the ratios
+ * p(j) / p(j - 1), and the table stops at the last outcome or when it
+ * reaches 1.
+ */
+class inversion_table {
+public:
+  template <typename ratio_t>
+  inline inversion_table(double p0, uint64_t last, const ratio_t& ratio) {
+    double pmf = p0, cdf = p0;
+    for (uint64_t j = 0; j < last; j++) {
+      double threshold = std::round(cdf * 4294967296.0);
+      if (threshold >= 4294967296.0) {
+        break;
+      }
+      thresholds_.push_back(static_cast<uint32_t>(threshold));
+      pmf *= ratio(j + 1);
+      cdf += pmf;
+    }
+  }
+
+  inline bool empty() const {
+    return thresholds_.empty();
+  }
+
+  inline uint32_t operator()(uint32_t word) const {
+    uint32_t k = 0;
+    for (uint32_t threshold : thresholds_) {
+      k += word >= threshold;
+    }
+    return k;
+  }
+
+  inline __m256i operator()(__m256i words) const {
+    __m256i k = _mm256_setzero_si256();
+    for (uint32_t threshold : thresholds_) {
+      // word >= threshold, unsigned, is -1
+      __m256i t = _mm256_set1_epi32(static_cast<int>(threshold));
+      k = _mm256_sub_epi32(k, _mm256_cmpeq_epi32(_mm256_max_epu32(words, t), words));
+    }
+    return k;
+  }
+
+private:
+  std::vector<uint32_t> thresholds_;
+};
+
+/**
+ * Writes count samples of table to dst, or zeros if it is empty. flip_n
+ * turns every k into flip_n - k when it is not 0.
+ */
+template <typename engine_t>
+static inline void sample_inversion(engine_t& gen, uint32_t* dst, uint64_t count, const inversion_table& table, uint32_t flip_n = 0) {
+  if (table.empty()) {
+    std::fill(dst, dst + count, flip_n);
+    return;
+  }
+  const __m256i n_v = _mm256_set1_epi32(static_cast<int>(flip_n));
+  uint32_t words[kUniformBatch];
+  for (uint64_t i = 0; i < count; i += kUniformBatch) {
+    uint64_t batch = std::min<uint64_t>(kUniformBatch, count - i);
+    random_bits(gen, words, batch);
+    uint64_t j = 0;
+    for (; j + 8 <= batch; j += 8) {
+      __m256i k = table(_mm256_loadu_si256((const __m256i*)(words + j)));
+      if (flip_n) {
+        k = _mm256_sub_epi32(n_v, k);
+      }
+      _mm256_storeu_si256((__m256i*)(dst + i + j), k);
+    }
+    for (; j < batch; j++) {
+      uint32_t k = table(words[j]);
+      dst[i + j] = flip_n ? flip_n - k : k;
+    }
+  }
+}
+
+struct log_factorial_table {
+  double values[128];
+
+  inline log_factorial_table() {
+    for (int k = 0; k < 128; k++) {
+      values[k] = std::lgamma(k + 1.0);
+    }
+  }
+};
+
+/**
+ * log(k!) for a whole number k, from a table below 128 and the Stirling
+ * series above, which is within an ulp or two there and much faster than
+ * std::lgamma
+ */
+static inline double log_factorial(double k) {
+  static const log_factorial_table table;
+  if (k < 128.0) {
+    return table.values[static_cast<int>(k)];
+  }
+  double x = k + 1.0, r2 = 1.0 / (x * x);
+  // 0.5 * log(2 pi)
+  return (x - 0.5) * std::log(x) - x + 0.91893853320467274178 + (1.0 / 12.0 - r2 * (1.0 / 360.0 - r2 / 1260.0)) / x;
+}
+
+/**
+ * Marsaglia-Tsang for x and u, drawing more if they are rejected
+ */
+template <typename engine_t>
+static inline float gamma_scalar(const ziggurat_tables& t, word_buffer<engine_t>& words, double d, double c, double x, double u) {
+  for (;;) {
+    double s = 1.0 + c * x;
+    if (s > 0.0) {
+      double v = s * s * s;
+      if (u < 1.0 - 0.0331 * x * x * x * x || std::log(u) < 0.5 * x * x + d * (1.0 - v + std::log(v))) {
+        return static_cast<float>(d * v);
+      }
+    }
+    x = ziggurat_normal_scalar(t, words, words.next());
+    u = words.uniform();
+  }
+}
+
+struct ptrs_params {
+  double lambda, log_lambda, a, b, log_alpha, v_r;
+
+  inline explicit ptrs_params(double lambda_) : lambda(lambda_), log_lambda(std::log(lambda_)) {
+    b = 0.931 + 2.53 * std::sqrt(lambda);
+    a = -0.059 + 0.02483 * b;
+    log_alpha = std::log(1.1239 + 1.1328 / (b - 3.4));
+    v_r = 0.9277 - 3.6224 / (b - 2.0);
+  }
+};
+
+/**
+ * PTRS for u in [-0.5, 0.5) and v in (0, 1], drawing more if they are rejected
+ */
+template <typename engine_t>
+static inline uint32_t ptrs_scalar(const ptrs_params& p, word_buffer<engine_t>& words, double u, double v) {
+  for (;; u = words.uniform() - 0.5, v = words.uniform()) {
+    double us = 0.5 - std::fabs(u);
+    double k = std::floor((2.0 * p.a / us + p.b) * u + p.lambda + 0.43);
+    if (us >= 0.07 && v <= p.v_r) {
+      return static_cast<uint32_t>(k);
+    }
+    if (k < 0.0 || (us < 0.013 && v > us)) {
+      continue;
+    }
+    if (std::log(v) + p.log_alpha - std::log(p.a / (us * us) + p.b) <= -p.lambda + k * p.log_lambda - log_factorial(k)) {
+      return static_cast<uint32_t>(k);
+    }
+  }
+}
+
+struct btpe_params {
+  double n, r, q, nrq, m, p1, xm, xl, xr, c, lambda_l, lambda_r, p2, p3, p4, log_f_m, log_rq;
+
+  inline btpe_params(uint32_t n_, double r_) : n(n_), r(r_), q(1.0 - r_), nrq(n_ * r_ * (1.0 - r_)) {
+    double fm = n * r + r;
+    m = std::floor(fm);
+    p1 = std::floor(2.195 * std::sqrt(nrq) - 4.6 * q) + 0.5;
+    xm = m + 0.5;
+    xl = xm - p1;
+    xr = xm + p1;
+    c = 0.134 + 20.5 / (15.3 + m);
+    double a = (fm - xl) / (fm - xl * r);
+    lambda_l = a * (1.0 + a / 2.0);
+    a = (xr - fm) / (xr * q);
+    lambda_r = a * (1.0 + a / 2.0);
+    p2 = p1 * (1.0 + 2.0 * c);
+    p3 = p2 + c / lambda_l;
+    p4 = p3 + c / lambda_r;
+    log_f_m = log_factorial(m) + log_factorial(n - m);
+    log_rq = std::log(r / q);
+  }
+};
+
+/**
+ * BTPE for u in (0, p4] and v in (0, 1], drawing more if they are rejected.
+ * The final test compares against log(f(y) / f(m)) from log_factorial,
+ * in place of both the paper's recurrence near the mode and its truncated
+ * Stirling corrections away from it.
+ */
+template <typename engine_t>
+static inline uint32_t btpe_scalar(const btpe_params& p, word_buffer<engine_t>& words, double u, double v) {
+  for (;; u = words.uniform() * p.p4, v = words.uniform()) {
+    double y;
+    if (u <= p.p1) {
+      // triangle
+      return static_cast<uint32_t>(std::floor(p.xm - p.p1 * v + u));
+    } else if (u <= p.p2) {
+      // parallelograms
+      double x = p.xl + (u - p.p1) / p.c;
+      v = v * p.c + 1.0 - std::fabs(p.m - x + 0.5) / p.p1;
+      if (v > 1.0) {
+        continue;
+      }
+      y = std::floor(x);
+    } else if (u <= p.p3) {
+      // left exponential tail
+      y = std::floor(p.xl + std::log(v) / p.lambda_l);
+      if (y < 0.0) {
+        continue;
+      }
+      v = v * (u - p.p2) * p.lambda_l;
+    } else {
+      // right exponential tail
+      y = std::floor(p.xr - std::log(v) / p.lambda_r);
+      if (y > p.n) {
+        continue;
+      }
+      v = v * (u - p.p3) * p.lambda_r;
+    }
+    double k = std::fabs(y - p.m);
+    double log_v = std::log(v);
+    if (k > 20.0 && k < p.nrq / 2.0 - 1.0) {
+      // squeeze on log(f(y) / f(m))
+      double rho = (k / p.nrq) * ((k * (k / 3.0 + 0.625) + 1.0 / 6.0) / p.nrq + 0.5);
+      double t = -k * k / (2.0 * p.nrq);
+      if (log_v < t - rho) {
+        return static_cast<uint32_t>(y);
+      }
+      if (log_v > t + rho) {
+        continue;
+      }
+    }
+    // the exact log(f(y) / f(m))
+    if (log_v <= p.log_f_m - log_factorial(y) - log_factorial(p.n - y) + (y - p.m) * p.log_rq) {
+      return static_cast<uint32_t>(y);
+    }
+  }
+}
+
+} // namespace detail
+
+/**
+ * Writes n gamma distributed floats with shape alpha and the given scale
+ * drawn through words, see Note [Gamma, Poisson and binomial sampling]
+ */
+template <typename engine_t>
+static inline void gamma_float(detail::word_buffer<engine_t>& words, float* dst, uint64_t n, float alpha, float scale = 1.0f) {
+  if (!(alpha > 0.0f && std::isfinite(alpha))) {
+    throw std::runtime_error("gamma shape must be positive and finite");
+  }
+  const detail::ziggurat_tables& t = detail::ziggurat();
+  const detail::uniform_params<float> open(0.0f, 1.0f, uniform_interval::open_closed);
+  const bool boost = alpha < 1.0f;
+  const double d = (boost ? alpha + 1.0 : alpha) - 1.0 / 3.0;
+  const double c = 1.0 / std::sqrt(9.0 * d);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 d_v = _mm256_set1_ps(static_cast<float>(d));
+  const __m256 c_v = _mm256_set1_ps(static_cast<float>(c));
+  const __m256 squeeze = _mm256_set1_ps(0.0331f);
+  const __m256 inv_alpha = _mm256_set1_ps(1.0f / alpha);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  for (uint64_t i = 0; i < n; i += 8) {
+    __m256 x = detail::ziggurat_normal8(t, words);
+    __m256 u = detail::uniform_float8(words, open);
+    __m256 s = _mm256_fmadd_ps(c_v, x, one);
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 result = _mm256_mul_ps(d_v, _mm256_mul_ps(_mm256_mul_ps(s, s), s));
+    __m256 accepted = _mm256_and_ps(_mm256_cmp_ps(s, _mm256_setzero_ps(), _CMP_GT_OQ),
+                                    _mm256_cmp_ps(u, _mm256_fnmadd_ps(squeeze, _mm256_mul_ps(x2, x2), one), _CMP_LT_OQ));
+    int rejected = ~_mm256_movemask_ps(accepted) & 0xFF;
+    if (rejected) {
+      float xs[8], us[8], lanes[8];
+      _mm256_storeu_ps(xs, x);
+      _mm256_storeu_ps(us, u);
+      _mm256_storeu_ps(lanes, result);
+      while (rejected) {
+        int lane = __builtin_ctz(rejected);
+        rejected &= rejected - 1;
+        lanes[lane] = detail::gamma_scalar(t, words, d, c, xs[lane], us[lane]);
+      }
+      result = _mm256_loadu_ps(lanes);
+    }
+    if (boost) {
+      __m256 w = detail::uniform_float8(words, open);
+      result = _mm256_mul_ps(result, simd::exp(_mm256_mul_ps(simd::log(w), inv_alpha)));
+    }
+    detail::store_lanes(dst + i, n - i, _mm256_mul_ps(result, scale_v));
+  }
+}
+
+/**
+ * Writes n gamma distributed floats with shape alpha and the given scale,
+ * see Note [Gamma, Poisson and binomial sampling]
+ */
+template <typename engine_t>
+static inline void gamma_float(engine_t& gen, float* dst, uint64_t n, float alpha, float scale = 1.0f) {
+  detail::word_buffer<engine_t> words(gen);
+  gamma_float(words, dst, n, alpha, scale);
+}
+
+/**
+ * Writes n Poisson distributed counts with mean lambda drawn through
+ * words, see Note [Gamma, Poisson and binomial sampling]
+ */
+template <typename engine_t>
+static inline void poisson(detail::word_buffer<engine_t>& words, uint32_t* dst, uint64_t n, double lambda) {
+  if (!(lambda >= 0.0 && lambda < 2147483648.0)) {
+    throw std::runtime_error("poisson mean must be between 0 and 2^31");
+  }
+  if (lambda < 10.0) {
+    detail::inversion_table table(std::exp(-lambda), 1024, [lambda](uint64_t j) { return lambda / j; });
+    detail::sample_inversion(words, dst, n, table);
+    return;
+  }
+  const detail::ptrs_params p(lambda);
+  const detail::uniform_params<double> open(0.0, 1.0, uniform_interval::open_closed);
+  const __m256d half = _mm256_set1_pd(0.5);
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d two_a = _mm256_set1_pd(2.0 * p.a);
+  const __m256d b = _mm256_set1_pd(p.b);
+  const __m256d shift = _mm256_set1_pd(p.lambda + 0.43);
+  const __m256d us_min = _mm256_set1_pd(0.07);
+  const __m256d v_r = _mm256_set1_pd(p.v_r);
+  for (uint64_t i = 0; i < n; i += 4) {
+    // u in [-0.5, 0.5)
+    __m256d u = _mm256_sub_pd(half, detail::uniform_double4(words, open));
+    __m256d v = detail::uniform_double4(words, open);
+    __m256d us = _mm256_sub_pd(half, _mm256_andnot_pd(sign, u));
+    __m256d k = _mm256_floor_pd(_mm256_fmadd_pd(_mm256_add_pd(_mm256_div_pd(two_a, us), b), u, shift));
+    __m256d accepted = _mm256_and_pd(_mm256_cmp_pd(us, us_min, _CMP_GE_OQ), _mm256_cmp_pd(v, v_r, _CMP_LE_OQ));
+    __m128i result = detail::low_halves(simd::double_to_int64(k));
+    int rejected = ~_mm256_movemask_pd(accepted) & 0xF;
+    if (rejected) {
+      double ul[4], vl[4];
+      uint32_t lanes[4];
+      _mm256_storeu_pd(ul, u);
+      _mm256_storeu_pd(vl, v);
+      _mm_storeu_si128((__m128i*)lanes, result);
+      while (rejected) {
+        int lane = __builtin_ctz(rejected);
+        rejected &= rejected - 1;
+        lanes[lane] = detail::ptrs_scalar(p, words, ul[lane], vl[lane]);
+      }
+      result = _mm_loadu_si128((const __m128i*)lanes);
+    }
+    detail::store_lanes(dst + i, n - i, result);
+  }
+}
+
+/**
+ * Writes n Poisson distributed counts with mean lambda,
+ * see Note [Gamma, Poisson and binomial sampling]
+ */
+template <typename engine_t>
+static inline void poisson(engine_t& gen, uint32_t* dst, uint64_t n, double lambda) {
+  detail::word_buffer<engine_t> words(gen);
+  poisson(words, dst, n, lambda);
+}
+
+/**
+ * Writes count binomially distributed counts of successes in n trials with
+ * probability p drawn through words, see Note [Gamma, Poisson and binomial
+ * sampling]
+ */
+template <typename engine_t>
+static inline void binomial(detail::word_buffer<engine_t>& words, uint32_t* dst, uint64_t count, uint32_t n, double p) {
+  if (!(p >= 0.0 && p <= 1.0)) {
+    throw std::runtime_error("binomial probability must be between 0 and 1");
+  }
+  // sample the rarer of success and failure and flip if that was failure
+  const double r = std::min(p, 1.0 - p);
+  const uint32_t flip_n = p > 0.5 ? n : 0;
+  if (n * r < 10.0) {
+    const double s = r / (1.0 - r);
+    detail::inversion_table table(std::pow(1.0 - r, n), n, [n, s](uint64_t j) { return (n - j + 1.0) / j * s; });
+    detail::sample_inversion(words, dst, count, table, flip_n);
+    return;
+  }
+  const detail::btpe_params bp(n, r);
+  const detail::uniform_params<double> open(0.0, 1.0, uniform_interval::open_closed);
+  const __m256d p1 = _mm256_set1_pd(bp.p1);
+  const __m256d p4 = _mm256_set1_pd(bp.p4);
+  const __m256d xm = _mm256_set1_pd(bp.xm);
+  const __m128i n_v = _mm_set1_epi32(static_cast<int>(flip_n));
+  for (uint64_t i = 0; i < count; i += 4) {
+    __m256d u = _mm256_mul_pd(detail::uniform_double4(words, open), p4);
+    __m256d v = detail::uniform_double4(words, open);
+    // the triangle, y = floor(xm - p1 v + u)
+    __m256d y = _mm256_floor_pd(_mm256_add_pd(_mm256_fnmadd_pd(p1, v, xm), u));
+    __m128i result = detail::low_halves(simd::double_to_int64(y));
+    int rejected = ~_mm256_movemask_pd(_mm256_cmp_pd(u, p1, _CMP_LE_OQ)) & 0xF;
+    if (rejected) {
+      double ul[4], vl[4];
+      uint32_t lanes[4];
+      _mm256_storeu_pd(ul, u);
+      _mm256_storeu_pd(vl, v);
+      _mm_storeu_si128((__m128i*)lanes, result);
+      while (rejected) {
+        int lane = __builtin_ctz(rejected);
+        rejected &= rejected - 1;
+        lanes[lane] = detail::btpe_scalar(bp, words, ul[lane], vl[lane]);
+      }
+      result = _mm_loadu_si128((const __m128i*)lanes);
+    }
+    if (flip_n) {
+      result = _mm_sub_epi32(n_v, result);
+    }
+    detail::store_lanes(dst + i, count - i, result);
+  }
+}
+
+/**
+ * Writes count binomially distributed counts of successes in n trials with
+ * probability p, see Note [Gamma, Poisson and binomial sampling]
+ */
+template <typename engine_t>
+static inline void binomial(engine_t& gen, uint32_t* dst, uint64_t count, uint32_t n, double p) {
+  detail::word_buffer<engine_t> words(gen);
+  binomial(words, dst, count, n, p);
+}
+
+} // namespace at
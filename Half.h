@@ -0,0 +1,319 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "Normal.h"
+#include "PhiloxSIMD.h"
+#include "Uniform.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace at {
+
+/**
+ * Note [Half precision output]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * fp16 (1 sign, 5 exponent, 10 mantissa bits) and bfloat16 (1 sign, 8
+ * exponent, 7 mantissa bits) values are stored as uint16_t and written
+ * straight from philox_simd_engine's registers, with no float32 buffer
+ * in between.
+ *
+ * Uniforms take 16 bits each, output 2i from the low half of word i and
+ * 2i + 1 from the high half, the same bits as reading the stream as
+ * 16-bit integers. The top 11 (fp16) or 8 (bfloat16) of those bits are the
+ * significand of a float from the mantissa trick of Note [Uniform real
+ * conversion], x = k * 2^-11 or k * 2^-8, which is exact in the narrow
+ * type, so [0, 1) converts without rounding and never reaches 1. lo and hi
+ * are rounded to the narrow type first, x * (hi - lo) + lo is an FMA in
+ * float, and the clamp is to the narrow values next to the ends, so that
+ * rounding the result can't reach an excluded end. A next32 block gives
+ * 64 outputs.
+ *
+ * Normals are Box-Muller on full 32-bit words exactly as normal_float,
+ * see Note [Box-Muller normals], and rounded; a 16-bit uniform would cut
+ * the tails off at |z| = 3.9. normal_half(gen, ...) is normal_float(gen,
+ * ...) rounded to nearest, 32 outputs per block.
+ *
+ * Rounding to nearest even is F16C's vcvtps2ph for fp16 and AVX-512
+ * BF16's vcvtneps2bf16 for bfloat16 when the compiler targets them.
+ * Without F16C every lane goes through float_to_half, and without AVX-512
+ * BF16 an add of 0x7FFF plus the lowest kept bit rounds bfloat16 in AVX2
+ * registers. vcvtneps2bf16 flushes float denormals to zero and the
+ * fallback doesn't, neither handles NaN the same way; neither case comes
+ * up in these kernels. As in Normal.h, a partial block at the end is drawn
+ * in full and the unused part dropped.
+ */
+
+namespace detail {
+
+/**
+ * float to fp16, rounding to nearest even, overflowing to inf
+ */
+static inline uint16_t float_to_half(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t abs = x & 0x7FFFFFFF;
+  if (abs > 0x7F800000) {
+    return static_cast<uint16_t>(sign | 0x7E00);
+  }
+  if (abs >= 0x477FF000) {
+    // 65520 and up round to inf
+    return static_cast<uint16_t>(sign | 0x7C00);
+  }
+  if (abs < 0x38800000) {
+    // below 2^-14 the result is a denormal, k * 2^-24, and the product is exact
+    float a;
+    memcpy(&a, &abs, sizeof(a));
+    return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(a * 16777216.0f)));
+  }
+  // rebias the exponent by 127 - 15 and round off 13 mantissa bits, a carry
+  // runs into the exponent
+  uint32_t h = (abs - 0x38000000) >> 13;
+  uint32_t rest = abs & 0x1FFF;
+  h += rest > 0x1000 || (rest == 0x1000 && (h & 1));
+  return static_cast<uint16_t>(sign | h);
+}
+
+static inline float half_to_float(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  uint32_t exponent = (h >> 10) & 0x1F;
+  uint32_t mantissa = h & 0x3FF;
+  uint32_t bits;
+  if (exponent == 0) {
+    float f = mantissa * (1.0f / 16777216.0f);
+    memcpy(&bits, &f, sizeof(bits));
+    bits |= sign;
+  } else if (exponent == 31) {
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+/**
+ * float to bfloat16, rounding to nearest even
+ */
+static inline uint16_t float_to_bfloat16(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  if ((x & 0x7FFFFFFF) > 0x7F800000) {
+    return static_cast<uint16_t>((x >> 16) | 0x40);
+  }
+  return static_cast<uint16_t>((x + 0x7FFF + ((x >> 16) & 1)) >> 16);
+}
+
+static inline float bfloat16_to_float(uint16_t b) {
+  uint32_t bits = static_cast<uint32_t>(b) << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+/**
+ * The next value of a 16-bit sign-magnitude format up or down from bits,
+ * the same for fp16 and bfloat16
+ */
+static inline uint16_t step_16(uint16_t bits, bool up) {
+  bool negative = (bits & 0x8000) != 0;
+  if ((bits & 0x7FFF) == 0) {
+    return up ? 0x0001 : 0x8001;
+  }
+  return static_cast<uint16_t>(up != negative ? bits + 1 : bits - 1);
+}
+
+struct half_format {
+  // significant bits, the implicit one included
+  static constexpr int kDigits = 11;
+
+  static inline uint16_t from_float(float f) {
+    return float_to_half(f);
+  }
+
+  static inline float to_float(uint16_t h) {
+    return half_to_float(h);
+  }
+
+  static inline __m128i convert8(__m256 x) {
+#ifdef __F16C__
+    return _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+    float lanes[8];
+    uint16_t halves[8];
+    _mm256_storeu_ps(lanes, x);
+    for (int i = 0; i < 8; i++) {
+      halves[i] = float_to_half(lanes[i]);
+    }
+    return _mm_loadu_si128((const __m128i*)halves);
+#endif
+  }
+};
+
+struct bfloat16_format {
+  static constexpr int kDigits = 8;
+
+  static inline uint16_t from_float(float f) {
+    return float_to_bfloat16(f);
+  }
+
+  static inline float to_float(uint16_t b) {
+    return bfloat16_to_float(b);
+  }
+
+  static inline __m128i convert8(__m256 x) {
+#if defined(__AVX512BF16__) && defined(__AVX512VL__)
+    __m128bh b = _mm256_cvtneps_pbh(x);
+    __m128i result;
+    memcpy(&result, &b, sizeof(result));
+    return result;
+#else
+    __m256i bits = _mm256_castps_si256(x);
+    __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    bits = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7FFF))), 16);
+    return _mm_packus_epi32(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+#endif
+  }
+};
+
+/**
+ * [lo, hi) or (lo, hi] with lo and hi rounded to the format and the clamp
+ * to the format's values next to them
+ */
+template <typename format_t>
+static inline uniform_params<float> uniform_16_params(float lo, float hi, uniform_interval interval) {
+  uint16_t lo_bits = format_t::from_float(lo), hi_bits = format_t::from_float(hi);
+  float lo_16 = format_t::to_float(lo_bits), hi_16 = format_t::to_float(hi_bits);
+  if (!(lo_16 < hi_16) || !std::isfinite(hi_16 - lo_16)) {
+    throw std::runtime_error("uniform bounds must stay ordered and finite once rounded to 16 bits");
+  }
+  uniform_params<float> p(lo_16, hi_16, interval);
+  if (interval == uniform_interval::closed_open) {
+    p.upper = format_t::to_float(step_16(hi_bits, false));
+  } else {
+    p.lower = format_t::to_float(step_16(lo_bits, true));
+  }
+  return p;
+}
+
+/**
+ * The 16 outputs of eight words, in draw order
+ */
+template <typename format_t, bool OPEN_CLOSED>
+static inline __m256i uniform_16(__m256i bits, const uniform_params<float>& p) {
+  const __m256i digits = _mm256_set1_epi32(static_cast<int>(0xFFFFFFFFU << (32 - format_t::kDigits)));
+  __m256 low = uniform_float_avx2<OPEN_CLOSED>(_mm256_and_si256(_mm256_slli_epi32(bits, 16), digits), p);
+  __m256 high = uniform_float_avx2<OPEN_CLOSED>(_mm256_and_si256(bits, digits), p);
+  __m128i l = format_t::convert8(low);
+  __m128i h = format_t::convert8(high);
+  return _mm256_setr_m128i(_mm_unpacklo_epi16(l, h), _mm_unpackhi_epi16(l, h));
+}
+
+template <typename format_t, bool OPEN_CLOSED>
+static inline void uniform_16_block(philox_simd_engine& gen, uint16_t* dst, const uniform_params<float>& p) {
+  __m256i out[4];
+  gen.next32(out[0], out[1], out[2], out[3]);
+  for (int j = 0; j < 4; j++) {
+    _mm256_storeu_si256((__m256i*)(dst + 16 * j), uniform_16<format_t, OPEN_CLOSED>(out[j], p));
+  }
+}
+
+template <typename format_t, bool OPEN_CLOSED>
+static inline void uniform_16_fill(philox_simd_engine& gen, uint16_t* dst, uint64_t n, const uniform_params<float>& p) {
+  uint64_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    uniform_16_block<format_t, OPEN_CLOSED>(gen, dst + i, p);
+  }
+  if (i < n) {
+    uint16_t tail[64];
+    uniform_16_block<format_t, OPEN_CLOSED>(gen, tail, p);
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+template <typename format_t>
+static inline void uniform_16(philox_simd_engine& gen, uint16_t* dst, uint64_t n, float lo, float hi, uniform_interval interval) {
+  const uniform_params<float> p = uniform_16_params<format_t>(lo, hi, interval);
+  if (interval == uniform_interval::closed_open) {
+    uniform_16_fill<format_t, false>(gen, dst, n, p);
+  } else {
+    uniform_16_fill<format_t, true>(gen, dst, n, p);
+  }
+}
+
+/**
+ * Writes the 32 outputs of one next32 block to dst, normal_float_block
+ * rounded
+ */
+template <typename format_t>
+static inline void normal_16_block(philox_simd_engine& gen, uint16_t* dst, __m256 mean, __m256 stddev) {
+  const uniform_params<float> open(0.0f, 1.0f, uniform_interval::open_closed);
+  const uniform_params<float> closed(0.0f, 1.0f, uniform_interval::closed_open);
+  __m256i out[4];
+  gen.next32(out[0], out[1], out[2], out[3]);
+  for (int j = 0; j < 4; j += 2) {
+    __m256 z0, z1;
+    box_muller(uniform_float_avx2<true>(out[j], open), uniform_float_avx2<false>(out[j + 1], closed), mean, stddev, z0, z1);
+    _mm256_storeu_si256((__m256i*)(dst + 8 * j), _mm256_setr_m128i(format_t::convert8(z0), format_t::convert8(z1)));
+  }
+}
+
+template <typename format_t>
+static inline void normal_16(philox_simd_engine& gen, uint16_t* dst, uint64_t n, float mean, float stddev) {
+  const __m256 mean_v = _mm256_set1_ps(mean);
+  const __m256 stddev_v = _mm256_set1_ps(stddev);
+  uint64_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    normal_16_block<format_t>(gen, dst + i, mean_v, stddev_v);
+  }
+  if (i < n) {
+    uint16_t tail[32];
+    normal_16_block<format_t>(gen, tail, mean_v, stddev_v);
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+} // namespace detail
+
+/**
+ * Writes n uniform fp16 values, see Note [Half precision output]
+ */
+static inline void uniform_half(philox_simd_engine& gen, uint16_t* dst, uint64_t n, float lo = 0.0f, float hi = 1.0f,
+                                uniform_interval interval = uniform_interval::closed_open) {
+  detail::uniform_16<detail::half_format>(gen, dst, n, lo, hi, interval);
+}
+
+/**
+ * Writes n uniform bfloat16 values, see Note [Half precision output]
+ */
+static inline void uniform_bfloat16(philox_simd_engine& gen, uint16_t* dst, uint64_t n, float lo = 0.0f, float hi = 1.0f,
+                                    uniform_interval interval = uniform_interval::closed_open) {
+  detail::uniform_16<detail::bfloat16_format>(gen, dst, n, lo, hi, interval);
+}
+
+/**
+ * Writes n normally distributed fp16 values, see Note [Half precision output]
+ */
+static inline void normal_half(philox_simd_engine& gen, uint16_t* dst, uint64_t n, float mean = 0.0f, float stddev = 1.0f) {
+  detail::normal_16<detail::half_format>(gen, dst, n, mean, stddev);
+}
+
+/**
+ * Writes n normally distributed bfloat16 values, see Note [Half precision output]
+ */
+static inline void normal_bfloat16(philox_simd_engine& gen, uint16_t* dst, uint64_t n, float mean = 0.0f, float stddev = 1.0f) {
+  detail::normal_16<detail::bfloat16_format>(gen, dst, n, mean, stddev);
+}
+
+} // namespace at
@@ -7,6 +7,7 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
 #include <cmath>
 
 namespace at {
@@ -42,6 +43,28 @@ public:
     return y;
   }
 
+  /**
+   * Hands the next n words to fn(i, word), see
+   * Note [Fused generate and transform]
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    for (uint64_t i = 0; i < n; i++) {
+      fn(i, (*this)());
+    }
+  }
+
+  /**
+   * Writes len bytes of the next words to dst, see Note [Random bytes]
+   */
+  inline void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (uint64_t i = 0; i < len; i += 4) {
+      uint32_t word = (*this)();
+      memcpy(out + i, &word, len - i < 4 ? len - i : 4);
+    }
+  }
+
 private:
   int left_;
   uint32_t next_;
@@ -0,0 +1,129 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "PhiloxSIMD.h"
+#include "SIMDMath.h"
+#include "Uniform.h"
+#include <algorithm>
+
+namespace at {
+
+/**
+ * Note [Box-Muller normals]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Two uniforms u1 in (0, 1] and u2 in [0, 1) give two independent
+ * standard normals
+ *
+ *   z0 = sqrt(-2 log u1) cos(2 pi u2),   z1 = sqrt(-2 log u1) sin(2 pi u2)
+ *
+ * u1 excludes 0 so the log stays finite; the largest |z| is then
+ * sqrt(-2 log 2^-24) ~ 5.8 for float and sqrt(-2 log 2^-53) ~ 8.6 for
+ * double. Uniforms come from the conversions in Uniform.h, the log and
+ * sincos from SIMDMath.h, and mean + stddev * z is a single FMA right
+ * before the store.
+ *
+ * One philox_simd_engine::next32 block is 32 words. For float, words
+ * 0-7 are u1 and 8-15 are u2 of eight pairs, written as the eight z0
+ * followed by the eight z1, and words 16-31 do the same for the next 16
+ * outputs. For double each uniform takes two words (see Note [Uniform real
+ * conversion]), so a block holds eight pairs and produces 16 doubles.
+ * A partial block at the end is drawn in full and the unused part dropped.
+ */
+
+namespace detail {
+
+static inline void box_muller(__m256 u1, __m256 u2, __m256 mean, __m256 stddev, __m256& z0, __m256& z1) {
+  __m256 radius = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), simd::log(u1)));
+  radius = _mm256_mul_ps(radius, stddev);
+  __m256 s, c;
+  simd::sincos_2pi(u2, s, c);
+  z0 = _mm256_fmadd_ps(radius, c, mean);
+  z1 = _mm256_fmadd_ps(radius, s, mean);
+}
+
+static inline void box_muller(__m256d u1, __m256d u2, __m256d mean, __m256d stddev, __m256d& z0, __m256d& z1) {
+  __m256d radius = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_set1_pd(-2.0), simd::log(u1)));
+  radius = _mm256_mul_pd(radius, stddev);
+  __m256d s, c;
+  simd::sincos_2pi(u2, s, c);
+  z0 = _mm256_fmadd_pd(radius, c, mean);
+  z1 = _mm256_fmadd_pd(radius, s, mean);
+}
+
+/**
+ * Writes the 32 floats of one next32 block to dst
+ */
+static inline void normal_float_block(philox_simd_engine& gen, float* dst, __m256 mean, __m256 stddev) {
+  const uniform_params<float> open(0.0f, 1.0f, uniform_interval::open_closed);
+  const uniform_params<float> closed(0.0f, 1.0f, uniform_interval::closed_open);
+  __m256i out[4];
+  gen.next32(out[0], out[1], out[2], out[3]);
+  for (int j = 0; j < 4; j += 2) {
+    __m256 z0, z1;
+    box_muller(uniform_float_avx2<true>(out[j], open), uniform_float_avx2<false>(out[j + 1], closed), mean, stddev, z0, z1);
+    _mm256_storeu_ps(dst + 8 * j, z0);
+    _mm256_storeu_ps(dst + 8 * j + 8, z1);
+  }
+}
+
+/**
+ * Writes the 16 doubles of one next32 block to dst
+ */
+static inline void normal_double_block(philox_simd_engine& gen, double* dst, __m256d mean, __m256d stddev) {
+  const uniform_params<double> open(0.0, 1.0, uniform_interval::open_closed);
+  const uniform_params<double> closed(0.0, 1.0, uniform_interval::closed_open);
+  __m256i out[4];
+  gen.next32(out[0], out[1], out[2], out[3]);
+  for (int j = 0; j < 4; j += 2) {
+    __m256d z0, z1;
+    box_muller(uniform_double_avx2<true>(out[j], open), uniform_double_avx2<false>(out[j + 1], closed), mean, stddev, z0, z1);
+    _mm256_storeu_pd(dst + 4 * j, z0);
+    _mm256_storeu_pd(dst + 4 * j + 4, z1);
+  }
+}
+
+} // namespace detail
+
+/**
+ * Writes n normally distributed floats, see Note [Box-Muller normals]
+ */
+static inline void normal_float(philox_simd_engine& gen, float* dst, uint64_t n, float mean = 0.0f, float stddev = 1.0f) {
+  const __m256 mean_v = _mm256_set1_ps(mean);
+  const __m256 stddev_v = _mm256_set1_ps(stddev);
+  uint64_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    detail::normal_float_block(gen, dst + i, mean_v, stddev_v);
+  }
+  if (i < n) {
+    float tail[32];
+    detail::normal_float_block(gen, tail, mean_v, stddev_v);
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+/**
+ * Writes n normally distributed doubles, see Note [Box-Muller normals]
+ */
+static inline void normal_double(philox_simd_engine& gen, double* dst, uint64_t n, double mean = 0.0, double stddev = 1.0) {
+  const __m256d mean_v = _mm256_set1_pd(mean);
+  const __m256d stddev_v = _mm256_set1_pd(stddev);
+  uint64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    detail::normal_double_block(gen, dst + i, mean_v, stddev_v);
+  }
+  if (i < n) {
+    double tail[16];
+    detail::normal_double_block(gen, tail, mean_v, stddev_v);
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+} // namespace at
@@ -7,6 +7,7 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
 #include <cmath>
 
 namespace at {
@@ -25,6 +26,28 @@ public:
       return pcg32_random_r();
   }
 
+  /**
+   * Hands the next n words to fn(i, word), see
+   * Note [Fused generate and transform]
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    for (uint64_t i = 0; i < n; i++) {
+      fn(i, static_cast<uint32_t>(pcg32_random_r()));
+    }
+  }
+
+  /**
+   * Writes len bytes of the next words to dst, see Note [Random bytes]
+   */
+  inline void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (uint64_t i = 0; i < len; i += 4) {
+      uint32_t word = static_cast<uint32_t>(pcg32_random_r());
+      memcpy(out + i, &word, len - i < 4 ? len - i : 4);
+    }
+  }
+
   void advance(uint64_t delta) {
     uint64_t cur_mult = PCG_DEFAULT_MULTIPLIER_64;
     uint64_t cur_plus = rng.inc;
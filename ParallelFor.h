@@ -0,0 +1,44 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace at {
+
+namespace detail {
+
+/**
+ * Calls fn(task) for every task in [0, tasks) on up to num_threads threads,
+ * the calling thread being one of them
+ */
+template <typename fn_t>
+static inline void parallel_for(uint64_t tasks, uint64_t num_threads, const fn_t& fn) {
+  std::atomic<uint64_t> next(0);
+  auto worker = [&]() {
+    for (uint64_t task = next++; task < tasks; task = next++) {
+      fn(task);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (uint64_t i = 1; i < std::min(num_threads, tasks); i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+} // namespace detail
+
+} // namespace at
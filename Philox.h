@@ -7,6 +7,10 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
+#if defined(__BMI2__) && !defined(__x86_64__) && !defined(__CUDA_ARCH__)
+#include <x86intrin.h>
+#endif
 #include "splitmix64.h"
 
 #include "Array.h"
@@ -115,6 +119,43 @@ public:
     return ret;
   }
 
+  /**
+   * Hands the next n words of operator() to fn(i, word) with the blocks
+   * drawn two at a time, see Note [Fused generate and transform]
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    uint64_t i = 0;
+    // what operator() has left of its current block comes first
+    for (; i < n && STATE != 0; i++) {
+      fn(i, (*this)());
+    }
+    UINT4 out[2];
+    for (; i + 8 <= n; i += 8) {
+      next_unrolled(out);
+      for (int u = 0; u < 2; u++) {
+        for (int j = 0; j < 4; j++) {
+          fn(i + 4 * u + j, out[u][j]);
+        }
+      }
+    }
+    for (; i < n; i++) {
+      fn(i, (*this)());
+    }
+  }
+
+  /**
+   * Writes len bytes of operator()'s words to dst, see Note [Random bytes]
+   */
+  inline void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    generate_transform(len / 4, [out](uint64_t i, uint32_t word) { memcpy(out + 4 * i, &word, 4); });
+    if (len % 4 != 0) {
+      uint32_t word = (*this)();
+      memcpy(out + (len & ~3ULL), &word, len % 4);
+    }
+  }
+
   inline UINT4 next() {
     UINT4 counter_ = counter;
     UINT2 key_ = key;
@@ -142,6 +183,34 @@ public:
     return counter_;
   }
 
+  /**
+   * Produces the same blocks as N back to back next() calls, where out[u]
+   * holds what the u-th call would have returned.
+   *
+   * next() pushes a single counter through ten serially dependent rounds.
+   * Here the rounds of N consecutive counters are interleaved, giving the
+   * out-of-order core N independent multiply chains to overlap. This is
+   * the fast path for builds without AVX2; N = 2 or 4 keeps all the state
+   * in general purpose registers.
+   */
+  template <int N>
+  inline void next_unrolled(UINT4 (&out)[N]) {
+    UINT2 key_ = key;
+    for (int u = 0; u < N; u++) {
+      out[u] = counter;
+      incr();
+    }
+    for (int j = 0; j < 9; j++) {
+      for (int u = 0; u < N; u++) {
+        out[u] = single_round(out[u], key_);
+      }
+      key_[0] += (kPhilox10A); key_[1] += (kPhilox10B);
+    }
+    for (int u = 0; u < N; u++) {
+      out[u] = single_round(out[u], key_);
+    }
+  }
+
   /**
    * Function that Skips N 128 bit numbers in a subsequence
    */
@@ -199,6 +268,10 @@ private:
     #ifdef __CUDA_ARCH__
       *result_high = __umulhi(a, b);
       return a*b;
+    #elif defined(__BMI2__) && !defined(__x86_64__)
+      // flag-free widening multiply, on x86-64 the 64-bit product below
+      // already lowers to a single imul
+      return _mulx_u32(a, b, result_high);
     #else
       const uint64_t product = static_cast<uint64_t>(a) * b;
       *result_high = static_cast<uint32_t>(product >> 32);
@@ -0,0 +1,167 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "Philox.h"
+#include "PhiloxSIMDStreams.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace at {
+
+/**
+ * Note [Reproducing CUDA Philox draws on the host]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * PyTorch's CUDA distribution kernels launch grid_dim blocks of block_dim
+ * threads and run a grid-stride loop, unrolled kCudaUnroll times, in
+ * which every thread draws one 128-bit block per iteration whether or not
+ * all of its elements are in range:
+ *
+ *   idx = blockIdx.x * blockDim.x + threadIdx.x;
+ *   philox_engine gen(seed, idx, offset);
+ *   for (linear = idx; linear < rounded_numel; linear += stride * kCudaUnroll) {
+ *     rand = gen.next();
+ *     for (ii = 0; ii < kCudaUnroll; ii++)
+ *       if (linear + ii * stride < numel) out[linear + ii * stride] = rand[ii];
+ *   }
+ *
+ * with stride = grid_dim * block_dim. So element e is word ii of block r
+ * of thread t, where
+ *
+ *   r = e / (stride * 4), ii = e / stride % 4, t = e % stride
+ *
+ * and afterwards the generator's offset has to move past everything any
+ * thread drew, ceil(numel / (stride * 4)) blocks. That increment is what
+ * philox_cuda_offset_increment returns.
+ *
+ * Units: offsets here count 128-bit blocks, as everywhere else in this
+ * repo. PyTorch's philox_offset counts 32-bit values the way curand_init
+ * does and is always a multiple of 4, so pass philox_offset / 4 and
+ * advance PyTorch's offset by 4 * philox_cuda_offset_increment.
+ *
+ * The host fill keeps the GPU's thread order in the lanes: eight
+ * consecutive CUDA threads become the eight lanes of a
+ * philox_simd_streams_engine, and each output word of next32 is then a
+ * contiguous run of eight elements. Two engines run side by side so every
+ * store covers a full 64-byte line. Threads are independent, so a range of
+ * CUDA threads can be filled by each host thread in any order and the
+ * result doesn't depend on how the range was split.
+ */
+constexpr int kCudaUnroll = 4;
+
+struct philox_cuda_launch {
+  uint32_t grid_dim;
+  uint32_t block_dim;
+
+  inline uint64_t threads() const {
+    return static_cast<uint64_t>(grid_dim) * block_dim;
+  }
+};
+
+/**
+ * Number of 128-bit blocks every CUDA thread draws for numel elements,
+ * see Note [Reproducing CUDA Philox draws on the host]
+ */
+static inline uint64_t philox_cuda_offset_increment(uint64_t numel, const philox_cuda_launch& launch) {
+  uint64_t per_iteration = launch.threads() * kCudaUnroll;
+  return (numel + per_iteration - 1) / per_iteration;
+}
+
+namespace detail {
+
+/**
+ * Stores the eight lanes of v at dst[e..e + 8), dropping the ones past numel
+ */
+static inline void philox_cuda_store(uint32_t* dst, uint64_t numel, uint64_t e, __m256i v) {
+  if (e + 8 <= numel) {
+    _mm256_storeu_si256((__m256i*)(dst + e), v);
+  } else if (e < numel) {
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, v);
+    memcpy(dst + e, lanes, (numel - e) * sizeof(uint32_t));
+  }
+}
+
+} // namespace detail
+
+/**
+ * Writes the elements owned by CUDA threads [first_thread, last_thread)
+ * of a launch over numel elements. Returns the offset increment.
+ */
+static inline uint64_t philox_cuda_fill(uint32_t* dst, uint64_t numel,
+                                        uint64_t seed, uint64_t offset,
+                                        const philox_cuda_launch& launch,
+                                        uint64_t first_thread, uint64_t last_thread) {
+  const int lanes = philox_simd_streams_engine::kLanes;
+  uint64_t stride = launch.threads();
+  if (stride == 0) {
+    throw std::runtime_error("CUDA launch must have at least one thread");
+  }
+  uint64_t blocks = philox_cuda_offset_increment(numel, launch);
+  last_thread = std::min(last_thread, stride);
+
+  uint64_t t = first_thread;
+  for (; t + 2 * lanes <= last_thread; t += 2 * lanes) {
+    philox_simd_streams_engine lo, hi;
+    for (int lane = 0; lane < lanes; lane++) {
+      lo.set_stream(lane, seed, t + lane, offset);
+      hi.set_stream(lane, seed, t + lanes + lane, offset);
+    }
+    for (uint64_t r = 0; r < blocks; r++) {
+      __m256i a[4], b[4];
+      lo.next32(a[0], a[1], a[2], a[3]);
+      hi.next32(b[0], b[1], b[2], b[3]);
+      for (int ii = 0; ii < kCudaUnroll; ii++) {
+        uint64_t e = (r * kCudaUnroll + ii) * stride + t;
+        detail::philox_cuda_store(dst, numel, e, a[ii]);
+        detail::philox_cuda_store(dst, numel, e + lanes, b[ii]);
+      }
+    }
+  }
+  for (; t + lanes <= last_thread; t += lanes) {
+    philox_simd_streams_engine gen;
+    for (int lane = 0; lane < lanes; lane++) {
+      gen.set_stream(lane, seed, t + lane, offset);
+    }
+    for (uint64_t r = 0; r < blocks; r++) {
+      __m256i a[4];
+      gen.next32(a[0], a[1], a[2], a[3]);
+      for (int ii = 0; ii < kCudaUnroll; ii++) {
+        detail::philox_cuda_store(dst, numel, (r * kCudaUnroll + ii) * stride + t, a[ii]);
+      }
+    }
+  }
+  // fewer than eight threads left, e.g. a block_dim that isn't a multiple of 8
+  for (; t < last_thread; t++) {
+    philox_engine gen(seed, t, offset);
+    for (uint64_t r = 0; r < blocks; r++) {
+      UINT4 rand = gen.next();
+      for (int ii = 0; ii < kCudaUnroll; ii++) {
+        uint64_t e = (r * kCudaUnroll + ii) * stride + t;
+        if (e < numel) {
+          dst[e] = rand[ii];
+        }
+      }
+    }
+  }
+  return blocks;
+}
+
+/**
+ * Writes all numel elements of the launch. Returns the offset increment.
+ */
+static inline uint64_t philox_cuda_fill(uint32_t* dst, uint64_t numel,
+                                        uint64_t seed, uint64_t offset,
+                                        const philox_cuda_launch& launch) {
+  return philox_cuda_fill(dst, numel, seed, offset, launch, 0, launch.threads());
+}
+
+} // namespace at
@@ -7,6 +7,7 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
 #include <x86intrin.h>
 #include "splitmix64.h"
 
@@ -124,6 +125,7 @@ public:
     __m256i key1 = _mm256_set1_epi32(key[1]);
     for (int j = 0; j < 10; j++) {
       single_round(counter0, counter1, counter2, counter3, key0, key1);
+      bump_key(key0, key1);
     }
 
 #if UNSHUFFLE
@@ -136,6 +138,138 @@ public:
     out3 = counter3;
   }
 
+  /**
+   * Produces the same values as N back to back next32 calls, where out[u]
+   * holds what the u-th call would have returned.
+   *
+   * next32 runs its ten rounds as one dependent chain: every round's
+   * _mm256_mul_epu32 waits on the previous round. Here the N blocks are
+   * independent counter sets sharing the key schedule, and their rounds
+   * are interleaved so the multiplies of one block hide the latency of
+   * the others. N = 2 or 4 is the useful range; beyond that the 4 * N
+   * live vectors no longer fit in the register file.
+   */
+  template <int N>
+  inline void next32_unrolled(__m256i (&out)[N][4]) {
+    if (__builtin_expect(counter[0] <= 4294967295U - 8 * N, 1)) {
+      __m256i base0 = _mm256_add_epi32(_mm256_set1_epi32(counter[0]), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+      __m256i counter1 = _mm256_set1_epi32(counter[1]);
+      __m256i counter2 = _mm256_set1_epi32(counter[2]);
+      __m256i counter3 = _mm256_set1_epi32(counter[3]);
+      for (int u = 0; u < N; u++) {
+        out[u][0] = _mm256_add_epi32(base0, _mm256_set1_epi32(8 * u));
+        out[u][1] = counter1;
+        out[u][2] = counter2;
+        out[u][3] = counter3;
+      }
+      counter[0] += 8 * N;
+
+      __m256i key0 = _mm256_set1_epi32(key[0]);
+      __m256i key1 = _mm256_set1_epi32(key[1]);
+      for (int j = 0; j < 10; j++) {
+        for (int u = 0; u < N; u++) {
+          single_round(out[u][0], out[u][1], out[u][2], out[u][3], key0, key1);
+        }
+        bump_key(key0, key1);
+      }
+
+#if UNSHUFFLE
+      for (int u = 0; u < N; u++) {
+        transpose(out[u][0], out[u][1], out[u][2], out[u][3]);
+      }
+#endif
+    } else {
+      // the low counter word wraps somewhere in these N blocks, let next32 carry it
+      for (int u = 0; u < N; u++) {
+        next32(out[u][0], out[u][1], out[u][2], out[u][3]);
+      }
+    }
+  }
+
+  /**
+   * Note [Fused generate and transform]
+   * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   * generate_transform(n, fn) draws n random words and hands them straight
+   * to fn, which scales, masks or adds them to something and writes its own
+   * output. Nothing is stored in between, so with fn inlined the engine and
+   * the transform compile into one loop with the words in registers.
+   *
+   * The vector engines call fn(i, words, count) once per block, where
+   * words is the four registers of a next32 call, i is the index of its
+   * first word and count is how many of its words are part of the n,
+   * 4 * kLanes except in a partial block at the end, which is drawn in
+   * full. Here the words are the same as random_bits gives, i.e. next32
+   * blocks independent of what operator() has buffered, and whole blocks
+   * are drawn two at a time with next32_unrolled.
+   *
+   * The scalar engines (philox_engine, pcg_engine, mt19937_engine,
+   * rdrand_engine and xoshiro256starstar_engine) call fn(i, word) for
+   * words 0 to n - 1, which are the next n values operator() (next() for
+   * xoshiro) would have returned, and leave the engine where those calls
+   * would have.
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    __m256i out[2][4];
+    uint64_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+      next32_unrolled(out);
+      fn(i, out[0], static_cast<uint64_t>(32));
+      fn(i + 32, out[1], static_cast<uint64_t>(32));
+    }
+    for (; i < n; i += 32) {
+      next32(out[0][0], out[0][1], out[0][2], out[0][3]);
+      fn(i, out[0], n - i < 32 ? n - i : 32);
+    }
+  }
+
+  /**
+   * Note [Random bytes]
+   * ~~~~~~~~~~~~~~~~~~~
+   * fill_bytes(dst, len) writes len random bytes to dst, which needs no
+   * alignment. The bytes are the engine's words in the order operator()
+   * returns them, each stored little endian, so every engine draws
+   * (len + word size - 1) / word size words and the only bytes dropped are
+   * the unused ones of the last word. philox_simd_engine and philox_engine
+   * first use up what operator() has buffered of the current block, write
+   * whole blocks straight from the registers and draw the rest through
+   * operator(), which keeps what is left of the block for later calls.
+   * philox_vec_engine has no such buffer and draws its last block in full,
+   * like its generate_transform.
+   */
+  inline void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (; len >= 4 && STATE != 0; out += 4, len -= 4) {
+      uint32_t word = (*this)();
+      memcpy(out, &word, 4);
+    }
+    if (STATE == 0) {
+      __m256i block[2][4];
+      for (; len >= 256; out += 256, len -= 256) {
+        next32_unrolled(block);
+        for (int u = 0; u < 2; u++) {
+          for (int j = 0; j < 4; j++) {
+            _mm256_storeu_si256((__m256i*)(out + 128 * u + 32 * j), block[u][j]);
+          }
+        }
+      }
+      for (; len >= 128; out += 128, len -= 128) {
+        next32(block[0][0], block[0][1], block[0][2], block[0][3]);
+        for (int j = 0; j < 4; j++) {
+          _mm256_storeu_si256((__m256i*)(out + 32 * j), block[0][j]);
+        }
+      }
+    }
+    for (; len >= 4; out += 4, len -= 4) {
+      uint32_t word = (*this)();
+      memcpy(out, &word, 4);
+    }
+    if (len != 0) {
+      uint32_t word = (*this)();
+      memcpy(out, &word, len);
+    }
+  }
+
   inline uint32_t operator()() {
     if(STATE == 0) {
       __m256i a, b, c, d;
@@ -202,8 +336,8 @@ private:
   UINT2 key;
   uint32_t STATE;
 
-  void single_round(__m256i& ctr0, __m256i& ctr1, __m256i& ctr2, __m256i& ctr3,
-                    __m256i& key0, __m256i& key1) {
+  inline void single_round(__m256i& ctr0, __m256i& ctr1, __m256i& ctr2, __m256i& ctr3,
+                           const __m256i& key0, const __m256i& key1) {
     __m256i lohi0a = _mm256_mul_epu32(ctr0, _mm256_set1_epi32(kPhiloxSA));
     __m256i lohi0b = _mm256_mul_epu32(_mm256_srli_epi64(ctr0, 32), _mm256_set1_epi32(kPhiloxSA));
     __m256i lohi1a = _mm256_mul_epu32(ctr2, _mm256_set1_epi32(kPhiloxSB));
@@ -232,7 +366,9 @@ private:
 
     // ctr3 = lo0
     ctr3 = lo0;
+  }
 
+  inline void bump_key(__m256i& key0, __m256i& key1) {
     key0 = _mm256_add_epi32(key0, _mm256_set1_epi32(kPhilox10A));
     key1 = _mm256_add_epi32(key1, _mm256_set1_epi32(kPhilox10B));
   }
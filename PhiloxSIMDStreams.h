@@ -0,0 +1,221 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "Array.h"
+#include <cmath>
+#include <iostream>
+
+namespace at {
+
+// typedefs for holding vector data
+namespace {
+
+typedef at::detail::Array<uint32_t, 4> UINT4;
+typedef at::detail::Array<uint32_t, 2> UINT2;
+
+} // anonymous namespace
+
+/**
+ * Note [Philox SIMD streams engine]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * philox_simd_engine broadcasts one key and eight consecutive counters
+ * across the lanes of a __m256i, so all eight lanes serve a single stream.
+ * This engine instead gives every lane its own key and its own 128-bit
+ * counter, i.e. lane i behaves exactly like
+ *
+ *   philox_engine(seeds[i], subsequences[i], offsets[i])
+ *
+ * and a single next32 call advances all eight independent streams by one
+ * 128-bit block. Lane i of out0..out3 holds words 0..3 of the block that
+ * philox_engine::next() would have returned for stream i, so no transpose
+ * is needed to match the scalar engine.
+ *
+ * This is meant for batches of small independent requests, each with its
+ * own seed and offset: load eight requests with set_stream, draw, reload.
+ */
+class philox_simd_streams_engine {
+public:
+  static const int kLanes = 8;
+
+  /**
+   * Lane i starts at (seed, subsequence = i, offset = 0).
+   */
+  inline explicit philox_simd_streams_engine(uint64_t seed = 67280421310721) {
+    for (int i = 0; i < kLanes; i++) {
+      set_stream(i, seed, i, 0);
+    }
+  }
+
+  inline philox_simd_streams_engine(const uint64_t* seeds,
+                                    const uint64_t* subsequences,
+                                    const uint64_t* offsets) {
+    for (int i = 0; i < kLanes; i++) {
+      set_stream(i, seeds[i], subsequences[i], offsets[i]);
+    }
+  }
+
+  /**
+   * Points a single lane at a new stream without touching the others
+   */
+  inline void set_stream(int lane, uint64_t seed, uint64_t subsequence = 0, uint64_t offset = 0) {
+    key0[lane] = static_cast<uint32_t>(seed);
+    key1[lane] = static_cast<uint32_t>(seed >> 32);
+    UINT4 counter(0);
+    counter[2] = static_cast<uint32_t>(subsequence);
+    counter[3] = static_cast<uint32_t>(subsequence >> 32);
+    incr_n(counter, offset);
+    counter0[lane] = counter[0];
+    counter1[lane] = counter[1];
+    counter2[lane] = counter[2];
+    counter3[lane] = counter[3];
+  }
+
+  /**
+   * Produces one 128-bit block for every lane's stream and advances
+   * each lane's counter by one
+   */
+  inline void next32(__m256i& out0, __m256i& out1, __m256i& out2, __m256i& out3) {
+    __m256i ctr0 = _mm256_loadu_si256((__m256i*)counter0);
+    __m256i ctr1 = _mm256_loadu_si256((__m256i*)counter1);
+    __m256i ctr2 = _mm256_loadu_si256((__m256i*)counter2);
+    __m256i ctr3 = _mm256_loadu_si256((__m256i*)counter3);
+    __m256i k0 = _mm256_loadu_si256((__m256i*)key0);
+    __m256i k1 = _mm256_loadu_si256((__m256i*)key1);
+
+    out0 = ctr0;
+    out1 = ctr1;
+    out2 = ctr2;
+    out3 = ctr3;
+    for (int j = 0; j < 10; j++) {
+      single_round(out0, out1, out2, out3, k0, k1);
+    }
+
+    incr(ctr0, ctr1, ctr2, ctr3);
+    _mm256_storeu_si256((__m256i*)counter0, ctr0);
+    _mm256_storeu_si256((__m256i*)counter1, ctr1);
+    _mm256_storeu_si256((__m256i*)counter2, ctr2);
+    _mm256_storeu_si256((__m256i*)counter3, ctr3);
+  }
+
+  /**
+   * Hands n words to fn(i, words, count) one next32 block at a time, lane
+   * i of the words coming from stream i, see
+   * Note [Fused generate and transform]
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    __m256i out[4];
+    for (uint64_t i = 0; i < n; i += 4 * kLanes) {
+      next32(out[0], out[1], out[2], out[3]);
+      fn(i, out, n - i < 4 * kLanes ? n - i : static_cast<uint64_t>(4 * kLanes));
+    }
+  }
+
+private:
+  uint32_t counter0[kLanes];
+  uint32_t counter1[kLanes];
+  uint32_t counter2[kLanes];
+  uint32_t counter3[kLanes];
+  uint32_t key0[kLanes];
+  uint32_t key1[kLanes];
+
+  /**
+   * Function that Skips N 128 bit numbers in a subsequence
+   */
+  static inline void incr_n(UINT4& counter, uint64_t n) {
+    uint32_t nlo = static_cast<uint32_t>(n);
+    uint32_t nhi = static_cast<uint32_t>(n >> 32);
+    counter[0] += nlo;
+    // if overflow in x has occured, carry over to nhi
+    if (counter[0] < nlo) {
+      nhi++;
+      // if overflow in nhi has occured during carry over,
+      // propagate that overflow to y and exit to increment z
+      // otherwise return
+      counter[1] += nhi;
+      if(nhi != 0) {
+        if (nhi <= counter[1]) {
+          return;
+        }
+      }
+    } else {
+      // if overflow in y has occured during addition,
+      // exit to increment z
+      // otherwise return
+      counter[1] += nhi;
+      if (nhi <= counter[1]) {
+        return;
+      }
+    }
+    if (++counter[2])
+      return;
+    ++counter[3];
+  }
+
+  /**
+   * Skips one 128 bit number in every lane. A word carries into the next
+   * one only in lanes where it wrapped around to zero.
+   */
+  static inline void incr(__m256i& ctr0, __m256i& ctr1, __m256i& ctr2, __m256i& ctr3) {
+    const __m256i zero = _mm256_setzero_si256();
+    ctr0 = _mm256_add_epi32(ctr0, _mm256_set1_epi32(1));
+    // carry is all ones in wrapped lanes, so subtracting it adds one
+    __m256i carry = _mm256_cmpeq_epi32(ctr0, zero);
+    ctr1 = _mm256_sub_epi32(ctr1, carry);
+    carry = _mm256_and_si256(carry, _mm256_cmpeq_epi32(ctr1, zero));
+    ctr2 = _mm256_sub_epi32(ctr2, carry);
+    carry = _mm256_and_si256(carry, _mm256_cmpeq_epi32(ctr2, zero));
+    ctr3 = _mm256_sub_epi32(ctr3, carry);
+  }
+
+  static inline void single_round(__m256i& ctr0, __m256i& ctr1, __m256i& ctr2, __m256i& ctr3,
+                                  __m256i& key0, __m256i& key1) {
+    __m256i lohi0a = _mm256_mul_epu32(ctr0, _mm256_set1_epi32(kPhiloxSA));
+    __m256i lohi0b = _mm256_mul_epu32(_mm256_srli_epi64(ctr0, 32), _mm256_set1_epi32(kPhiloxSA));
+    __m256i lohi1a = _mm256_mul_epu32(ctr2, _mm256_set1_epi32(kPhiloxSB));
+    __m256i lohi1b = _mm256_mul_epu32(_mm256_srli_epi64(ctr2, 32), _mm256_set1_epi32(kPhiloxSB));
+
+    lohi0a = _mm256_shuffle_epi32(lohi0a, 0xD8);
+    lohi0b = _mm256_shuffle_epi32(lohi0b, 0xD8);
+    lohi1a = _mm256_shuffle_epi32(lohi1a, 0xD8);
+    lohi1b = _mm256_shuffle_epi32(lohi1b, 0xD8);
+
+    __m256i lo0 = _mm256_unpacklo_epi32(lohi0a, lohi0b);
+    __m256i hi0 = _mm256_unpackhi_epi32(lohi0a, lohi0b);
+    __m256i lo1 = _mm256_unpacklo_epi32(lohi1a, lohi1b);
+    __m256i hi1 = _mm256_unpackhi_epi32(lohi1a, lohi1b);
+
+    // ctr0 = hi1 ^ ctr[1] ^ key[0]
+    ctr0 = _mm256_xor_si256(ctr1, key0);
+    ctr0 = _mm256_xor_si256(ctr0, hi1);
+
+    // ctr1 = lo1
+    ctr1 = lo1;
+
+    // ctr2 = hi0 ^ ctr[3] ^ key[1];
+    ctr2 = _mm256_xor_si256(ctr3, key1);
+    ctr2 = _mm256_xor_si256(ctr2, hi0);
+
+    // ctr3 = lo0
+    ctr3 = lo0;
+
+    key0 = _mm256_add_epi32(key0, _mm256_set1_epi32(kPhilox10A));
+    key1 = _mm256_add_epi32(key1, _mm256_set1_epi32(kPhilox10B));
+  }
+
+  static const uint32_t kPhilox10A = 0x9E3779B9;
+  static const uint32_t kPhilox10B = 0xBB67AE85;
+  static const uint32_t kPhiloxSA = 0xD2511F53;
+  static const uint32_t kPhiloxSB = 0xCD9E8D57;
+};
+
+
+} // namespace at
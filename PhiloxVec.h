@@ -0,0 +1,263 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <x86intrin.h>
+#endif
+
+#include "Array.h"
+#include <cmath>
+#include <iostream>
+
+namespace at {
+
+// typedefs for holding vector data
+namespace {
+
+typedef at::detail::Array<uint32_t, 4> UINT4;
+typedef at::detail::Array<uint32_t, 2> UINT2;
+
+} // anonymous namespace
+
+namespace detail {
+
+/**
+ * GCC ignores vector_size on typedefs whose size depends on a template
+ * parameter, so each supported lane count spells out its vector types here.
+ * vec_t holds LANES 32-bit words and wide_t is the same register viewed as
+ * LANES / 2 64-bit words.
+ *
+ * mul_even is the one operation vector extensions cannot express: a
+ * 32x32->64 multiply of the low half of every 64-bit word. Written
+ * generically, GCC can't tell that the high halves are zero and emits a
+ * full 64x64 product (three pmuludq per vector, or vpmullq), so it maps to
+ * pmuludq whenever the target has a register of that width and falls back
+ * to the generic form otherwise.
+ */
+template <int LANES> struct philox_vec_types;
+
+template <> struct philox_vec_types<4> {
+  typedef uint32_t vec_t __attribute__((vector_size(16)));
+  typedef uint64_t wide_t __attribute__((vector_size(16)));
+  static inline void mul_even(const wide_t& a, uint32_t b, wide_t& product) {
+#if defined(__SSE2__)
+    product = (wide_t)_mm_mul_epu32((__m128i)a, _mm_set1_epi32(b));
+#else
+    product = (a & 0xFFFFFFFFULL) * static_cast<uint64_t>(b);
+#endif
+  }
+};
+
+template <> struct philox_vec_types<8> {
+  typedef uint32_t vec_t __attribute__((vector_size(32)));
+  typedef uint64_t wide_t __attribute__((vector_size(32)));
+  static inline void mul_even(const wide_t& a, uint32_t b, wide_t& product) {
+#if defined(__AVX2__)
+    product = (wide_t)_mm256_mul_epu32((__m256i)a, _mm256_set1_epi32(b));
+#else
+    product = (a & 0xFFFFFFFFULL) * static_cast<uint64_t>(b);
+#endif
+  }
+};
+
+template <> struct philox_vec_types<16> {
+  typedef uint32_t vec_t __attribute__((vector_size(64)));
+  typedef uint64_t wide_t __attribute__((vector_size(64)));
+  static inline void mul_even(const wide_t& a, uint32_t b, wide_t& product) {
+#if defined(__AVX512F__)
+    // the maskz form sidesteps a spurious GCC 12 -Wuninitialized in _mm512_mul_epu32
+    product = (wide_t)_mm512_maskz_mul_epu32(0xFF, (__m512i)a, _mm512_set1_epi32(b));
+#else
+    product = (a & 0xFFFFFFFFULL) * static_cast<uint64_t>(b);
+#endif
+  }
+};
+
+} // namespace detail
+
+/**
+ * Note [Philox vector extension engine]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Same algorithm and output layout as philox_simd_engine (with UNSHUFFLE
+ * set to 0), written with GCC/Clang vector extensions instead of _mm256_*
+ * intrinsics and templated on the number of lanes:
+ *
+ *   philox_vec_engine<4>   one 128-bit vector per word, SSE2
+ *   philox_vec_engine<8>   one 256-bit vector per word, AVX2
+ *   philox_vec_engine<16>  one 512-bit vector per word, AVX-512
+ *
+ * The compiler picks the instructions for whatever -march is in effect and
+ * splits vectors wider than the target into several registers, so any lane
+ * count builds everywhere. philox_vec_engine<8> produces exactly the same
+ * values as philox_simd_engine::next32.
+ *
+ * Everything but the widening multiply (see philox_vec_types) is plain
+ * vector arithmetic. The multiply treats even and odd words separately as
+ * 64-bit products and puts the low and high halves back together with
+ * masks and shifts, which lowers to the same shift/blend sequence a hand
+ * written kernel would use.
+ */
+template <int LANES>
+class philox_vec_engine {
+public:
+  typedef typename detail::philox_vec_types<LANES>::vec_t vec_t;
+  typedef typename detail::philox_vec_types<LANES>::wide_t wide_t;
+  static const int kLanes = LANES;
+
+  inline explicit philox_vec_engine(uint64_t seed = 67280421310721,
+                                    uint64_t subsequence = 0,
+                                    uint64_t offset = 0) {
+    key[0] = static_cast<uint32_t>(seed);
+    key[1] = static_cast<uint32_t>(seed >> 32);
+    counter = UINT4(0);
+    counter[2] = static_cast<uint32_t>(subsequence);
+    counter[3] = static_cast<uint32_t>(subsequence >> 32);
+    incr_n(offset);
+  }
+
+  /**
+   * Produces 4 * LANES randoms: lane i of out0..out3 holds the block for
+   * counter + i, and the counter advances by LANES
+   */
+  inline void next32(vec_t& out0, vec_t& out1, vec_t& out2, vec_t& out3) {
+    vec_t counter0 = vec_t(), counter1 = vec_t(), counter2 = vec_t(), counter3 = vec_t();
+    if (__builtin_expect(counter[0] <= 4294967295U - LANES, 1)) {
+      for (int i = 0; i < LANES; i++) {
+        counter0[i] = counter[0] + i;
+      }
+      counter1 += counter[1];
+      counter2 += counter[2];
+      counter3 += counter[3];
+      counter[0] += LANES;
+    } else {
+      for (int i = 0; i < LANES; i++) {
+        counter0[i] = counter[0];
+        counter1[i] = counter[1];
+        counter2[i] = counter[2];
+        counter3[i] = counter[3];
+        incr();
+      }
+    }
+
+    vec_t key0 = vec_t() + key[0];
+    vec_t key1 = vec_t() + key[1];
+    for (int j = 0; j < 10; j++) {
+      single_round(counter0, counter1, counter2, counter3, key0, key1);
+      key0 += kPhilox10A;
+      key1 += kPhilox10B;
+    }
+
+    out0 = counter0;
+    out1 = counter1;
+    out2 = counter2;
+    out3 = counter3;
+  }
+
+  /**
+   * Hands n words to fn(i, words, count) one next32 block at a time, see
+   * Note [Fused generate and transform]
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    vec_t out[4];
+    for (uint64_t i = 0; i < n; i += 4 * LANES) {
+      next32(out[0], out[1], out[2], out[3]);
+      fn(i, out, n - i < 4 * LANES ? n - i : static_cast<uint64_t>(4 * LANES));
+    }
+  }
+
+  /**
+   * Writes len bytes of next32's words to dst, see Note [Random bytes]
+   */
+  inline void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    generate_transform((len + 3) / 4, [out, len](uint64_t i, const vec_t (&words)[4], uint64_t count) {
+      memcpy(out + 4 * i, words, 4 * count < len - 4 * i ? 4 * count : len - 4 * i);
+    });
+  }
+
+  /**
+   * Function that Skips N 128 bit numbers in a subsequence
+   */
+  inline void incr_n(uint64_t n) {
+    uint32_t nlo = static_cast<uint32_t>(n);
+    uint32_t nhi = static_cast<uint32_t>(n >> 32);
+    counter[0] += nlo;
+    // if overflow in x has occured, carry over to nhi
+    if (counter[0] < nlo) {
+      nhi++;
+      // if overflow in nhi has occured during carry over,
+      // propagate that overflow to y and exit to increment z
+      // otherwise return
+      counter[1] += nhi;
+      if(nhi != 0) {
+        if (nhi <= counter[1]) {
+          return;
+        }
+      }
+    } else {
+      // if overflow in y has occured during addition,
+      // exit to increment z
+      // otherwise return
+      counter[1] += nhi;
+      if (nhi <= counter[1]) {
+        return;
+      }
+    }
+    if (++counter[2])
+      return;
+    ++counter[3];
+  }
+
+  /**
+   * Function that Skips one 128 bit number in a subsequence
+   */
+  inline void incr() {
+    if (++counter[0] == 0) {
+      if (++counter[1] == 0) {
+        if (++counter[2] == 0) {
+          ++counter[3];
+        }
+      }
+    }
+  }
+
+private:
+  UINT4 counter;
+  UINT2 key;
+
+  static inline void mulhilo32(const vec_t& a, uint32_t b, vec_t& lo, vec_t& hi) {
+    const uint64_t low_half = 0xFFFFFFFFULL;
+    wide_t even, odd;
+    detail::philox_vec_types<LANES>::mul_even((wide_t)a, b, even);
+    detail::philox_vec_types<LANES>::mul_even((wide_t)a >> 32, b, odd);
+    lo = (vec_t)((even & low_half) | (odd << 32));
+    hi = (vec_t)((even >> 32) | (odd & ~low_half));
+  }
+
+  static inline void single_round(vec_t& ctr0, vec_t& ctr1, vec_t& ctr2, vec_t& ctr3,
+                                  const vec_t& key0, const vec_t& key1) {
+    vec_t lo0, hi0, lo1, hi1;
+    mulhilo32(ctr0, kPhiloxSA, lo0, hi0);
+    mulhilo32(ctr2, kPhiloxSB, lo1, hi1);
+    ctr0 = hi1 ^ ctr1 ^ key0;
+    ctr1 = lo1;
+    ctr2 = hi0 ^ ctr3 ^ key1;
+    ctr3 = lo0;
+  }
+
+  static const uint32_t kPhilox10A = 0x9E3779B9;
+  static const uint32_t kPhilox10B = 0xBB67AE85;
+  static const uint32_t kPhiloxSA = 0xD2511F53;
+  static const uint32_t kPhiloxSB = 0xCD9E8D57;
+};
+
+
+} // namespace at
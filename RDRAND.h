@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdint.h>
+#if defined(__RDRND__) || defined(__RDSEED__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+namespace at {
+
+/**
+ * Note [Hardware entropy]
+ * ~~~~~~~~~~~~~~~~~~~~~~~
+ * RDRAND reads the output of the CPU's DRBG, which is reseeded from the
+ * on-chip entropy source, and RDSEED reads the conditioned entropy source
+ * itself. Both set the carry flag on success and can fail transiently
+ * when the hardware is drained, more so under contention from many cores.
+ * Following Intel's DRNG software implementation guide:
+ *
+ * - RDRAND is retried up to kRdrandRetries times. Running out of retries
+ *   means the hardware is broken, so it throws.
+ * - RDSEED can legitimately run dry for a while, so it is retried with a
+ *   pause up to kRdseedRetries times before falling back to the kernel
+ *   (getrandom on Linux, std::random_device elsewhere).
+ *
+ * Builds without -mrdrnd / -mrdseed (or -march=native on a CPU lacking
+ * them) compile the same interface on top of the fallback.
+ */
+constexpr int kRdrandRetries = 10;
+constexpr int kRdseedRetries = 100;
+
+/**
+ * 64 bits from the kernel CSPRNG
+ */
+static inline uint64_t getrandom64() {
+  uint64_t value;
+#ifdef __linux__
+  if (getrandom(&value, sizeof(value), 0) != sizeof(value)) {
+    throw std::runtime_error("getrandom failed");
+  }
+#else
+  std::random_device rd;
+  value = (static_cast<uint64_t>(rd()) << 32) | rd();
+#endif
+  return value;
+}
+
+/**
+ * 64 bits of RDRAND output, see Note [Hardware entropy]
+ */
+static inline uint64_t rdrand64() {
+#ifdef __RDRND__
+  unsigned long long value;
+  for (int i = 0; i < kRdrandRetries; i++) {
+    if (_rdrand64_step(&value)) {
+      return value;
+    }
+  }
+  throw std::runtime_error("RDRAND failed to return a value");
+#else
+  return getrandom64();
+#endif
+}
+
+/**
+ * A 64-bit seed straight from the entropy source, see Note [Hardware entropy]
+ */
+static inline uint64_t hardware_seed() {
+#ifdef __RDSEED__
+  unsigned long long value;
+  for (int i = 0; i < kRdseedRetries; i++) {
+    if (_rdseed64_step(&value)) {
+      return value;
+    }
+    _mm_pause();
+  }
+#endif
+  return getrandom64();
+}
+
+/**
+ * Random engine on top of RDRAND. Draws are batched kBatch words at a time
+ * so operator() is a buffer read on the fast path.
+ */
+class rdrand_engine {
+public:
+  static const int kBatch = 32;
+
+  inline rdrand_engine() : pos_(kBatch) {}
+
+  inline uint64_t operator()() {
+    if (pos_ == kBatch) {
+      fill(buffer_, kBatch);
+      pos_ = 0;
+    }
+    return buffer_[pos_++];
+  }
+
+  /**
+   * Hands the next n words of operator() to fn(i, word), see
+   * Note [Fused generate and transform]
+   */
+  template <typename fn_t>
+  inline void generate_transform(uint64_t n, const fn_t& fn) {
+    for (uint64_t i = 0; i < n; i++) {
+      fn(i, (*this)());
+    }
+  }
+
+  /**
+   * Writes len bytes of the next words of operator() to dst, see
+   * Note [Random bytes]
+   */
+  inline void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (uint64_t i = 0; i < len; i += 8) {
+      uint64_t word = (*this)();
+      memcpy(out + i, &word, len - i < 8 ? len - i : 8);
+    }
+  }
+
+  /**
+   * Writes n 64-bit words directly, bypassing the buffer
+   */
+  inline void fill(uint64_t* dst, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      dst[i] = rdrand64();
+    }
+  }
+
+private:
+  uint64_t buffer_[kBatch];
+  int pos_;
+};
+
+} // namespace at
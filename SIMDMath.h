@@ -0,0 +1,512 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+namespace at {
+namespace simd {
+
+/**
+ * Note [SIMD math]
+ * ~~~~~~~~~~~~~~~~
+ * Vectorized elementary functions for turning random bits into
+ * distributions without leaving the vector registers. They are overloaded
+ * on the register type, so simd::log(x) works on __m256 and __m256d alike.
+ *
+ * log:  the argument is split into 2^k * m with m in [sqrt(1/2), sqrt(2)).
+ *       float evaluates log(m) with the Cephes logf polynomial, double with
+ *       the fdlibm rational approximation in s = (m - 1) / (m + 1), and k
+ *       is added back as k * ln2 in two parts. Zero gives -inf, negative
+ *       inputs and NaN give NaN, +inf gives +inf and denormals are scaled
+ *       into the normal range first.
+ *
+ * sincos_2pi: sin and cos of 2 * pi * turns. Working in turns makes the
+ *       range reduction exact: turns - round(4 * turns) / 4 is computed
+ *       without rounding for any finite input, and the remaining angle in
+ *       [-pi/4, pi/4] goes through the Cephes sin/cos polynomials before
+ *       the quadrant swaps and negates the results. This is exactly what
+ *       Box-Muller needs, with the angle drawn as a uniform in [0, 1).
+ *       The quadrant is taken from a 32-bit conversion, so |turns| has to
+ *       stay below 2^29.
+ *
+ * sincos: sin and cos of an angle in radians. The quadrant q is x * 2/pi
+ *       rounded, and x - q * pi/2 is computed Cody-Waite style with pi/2
+ *       split in three parts and one FMA per part; the first step is exact.
+ *       That keeps the result accurate for float |x| < 2^16 and double
+ *       |x| < 2^30. There is no Payne-Hanek reduction for larger arguments.
+ *
+ * exp:  e^x = 2^q * e^r with q = round(x / ln2) and r = x - q * ln2, ln2
+ *       again in two parts. e^r is the Cephes expf polynomial for float and
+ *       the Cephes exp rational function for double. 2^q is applied as two
+ *       factors so that results in the denormal range and the overflow to
+ *       +inf round only once; NaN passes through.
+ *
+ * sqrt: the hardware instruction, which is correctly rounded.
+ *
+ * Each function has __m256 and __m256d versions, and __m512 and __m512d
+ * ones when AVX-512F is enabled. The AVX-512 versions use getexp/getmant in
+ * log and scalef in exp. They run the same polynomials and give the same
+ * error bounds. All of them need FMA. The worst errors in ulp below were
+ * measured against libm evaluated in double (for float) and long double
+ * (for double), over 2^25 random inputs per function. check_simd_math
+ * checks the same bounds on dense sweeps:
+ *
+ *              float    double
+ *   log         0.80     0.81    all positive inputs, denormals included
+ *   exp         1.26     1.73    the whole finite range, denormal results included
+ *   sincos      1.58     1.58    |x| < 2^16 (float), |x| < 2^30 (double)
+ *   sqrt        0.5      0.5
+ */
+
+// float
+
+static inline __m256 log(__m256 x) {
+  const __m256 min_normal = _mm256_set1_ps(1.17549435e-38f);
+  __m256 denormal = _mm256_cmp_ps(x, min_normal, _CMP_LT_OQ);
+  __m256 y = _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(33554432.0f)), denormal);
+
+  // y = 2^e * m with m in [0.5, 1)
+  __m256i bits = _mm256_castps_si256(y);
+  __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126));
+  e = _mm256_sub_epi32(e, _mm256_and_si256(_mm256_castps_si256(denormal), _mm256_set1_epi32(25)));
+  __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)),
+                                                 _mm256_set1_epi32(0x3F000000)));
+
+  // move m to [sqrt(1/2), sqrt(2)) and subtract 1
+  __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+  e = _mm256_add_epi32(e, _mm256_castps_si256(small));
+  m = _mm256_add_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_and_ps(small, m));
+  __m256 ef = _mm256_cvtepi32_ps(e);
+
+  __m256 z = _mm256_mul_ps(m, m);
+  __m256 p = _mm256_set1_ps(7.0376836292e-2f);
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.1514610310e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.1676998740e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.2420140846e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.4249322787e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.6668057665e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(2.0000714765e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-2.4999993993e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(3.3333331174e-1f));
+  p = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+
+  // ln2 = 0.693359375 - 2.12194440e-4, the first part exact in ef * ln2
+  p = _mm256_fmadd_ps(ef, _mm256_set1_ps(-2.12194440e-4f), p);
+  p = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), p);
+  __m256 result = _mm256_fmadd_ps(ef, _mm256_set1_ps(0.693359375f), _mm256_add_ps(m, p));
+
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 inf = _mm256_set1_ps(__builtin_inff());
+  result = _mm256_blendv_ps(result, _mm256_set1_ps(-__builtin_inff()), _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+  result = _mm256_blendv_ps(result, inf, _mm256_cmp_ps(x, inf, _CMP_EQ_OQ));
+  return _mm256_blendv_ps(result, _mm256_set1_ps(__builtin_nanf("")), _mm256_cmp_ps(x, zero, _CMP_NGE_UQ));
+}
+
+static inline __m256 exp(__m256 x) {
+  // max and min return their second operand when either is NaN, so NaN passes through
+  x = _mm256_min_ps(_mm256_set1_ps(89.0f), _mm256_max_ps(_mm256_set1_ps(-104.0f), x));
+  __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(0.693359375f), x);
+  r = _mm256_fnmadd_ps(q, _mm256_set1_ps(-2.12194440e-4f), r);
+
+  __m256 z = _mm256_mul_ps(r, r);
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, z, _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+  // 2^q in two factors, the first product is exact and the second rounds once
+  __m256i n = _mm256_cvtps_epi32(q);
+  __m256i n1 = _mm256_srai_epi32(n, 1);
+  __m256i n2 = _mm256_sub_epi32(n, n1);
+  __m256 scale1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n1, _mm256_set1_epi32(127)), 23));
+  __m256 scale2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n2, _mm256_set1_epi32(127)), 23));
+  return _mm256_mul_ps(_mm256_mul_ps(p, scale1), scale2);
+}
+
+/**
+ * sin and cos of r in [-pi/4, pi/4], rotated by q quarter turns
+ */
+static inline void sincos_quadrant(__m256 r, __m256i qi, __m256& s, __m256& c) {
+  __m256 z = _mm256_mul_ps(r, r);
+  __m256 sp = _mm256_set1_ps(-1.9515295891e-4f);
+  sp = _mm256_fmadd_ps(sp, z, _mm256_set1_ps(8.3321608736e-3f));
+  sp = _mm256_fmadd_ps(sp, z, _mm256_set1_ps(-1.6666654611e-1f));
+  __m256 sin_r = _mm256_fmadd_ps(_mm256_mul_ps(sp, z), r, r);
+  __m256 cp = _mm256_set1_ps(2.443315711809948e-5f);
+  cp = _mm256_fmadd_ps(cp, z, _mm256_set1_ps(-1.388731625493765e-3f));
+  cp = _mm256_fmadd_ps(cp, z, _mm256_set1_ps(4.166664568298827e-2f));
+  __m256 cos_r = _mm256_fmadd_ps(_mm256_mul_ps(cp, z), z, _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), _mm256_set1_ps(1.0f)));
+
+  // quadrant q: odd quadrants swap sin and cos, sin is negated in 2 and 3, cos in 1 and 2
+  __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(qi, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+  __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(qi, _mm256_set1_epi32(2)), 30));
+  __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(qi, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+  s = _mm256_xor_ps(_mm256_blendv_ps(sin_r, cos_r, swap), sin_sign);
+  c = _mm256_xor_ps(_mm256_blendv_ps(cos_r, sin_r, swap), cos_sign);
+}
+
+static inline void sincos_2pi(__m256 turns, __m256& s, __m256& c) {
+  __m256 quarters = _mm256_mul_ps(turns, _mm256_set1_ps(4.0f));
+  __m256 q = _mm256_round_ps(quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  // exact, |r| <= pi / 4
+  __m256 r = _mm256_mul_ps(_mm256_sub_ps(quarters, q), _mm256_set1_ps(1.57079632679489662f));
+  sincos_quadrant(r, _mm256_cvtps_epi32(q), s, c);
+}
+
+static inline void sincos(__m256 x, __m256& s, __m256& c) {
+  __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.636619772367581343f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  // Cody-Waite: pi / 2 in three parts, the first step is exact
+  __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(1.570796371e+00f), x);
+  r = _mm256_fnmadd_ps(q, _mm256_set1_ps(-4.371138829e-08f), r);
+  r = _mm256_fnmadd_ps(q, _mm256_set1_ps(-1.715124510e-15f), r);
+  sincos_quadrant(r, _mm256_cvtps_epi32(q), s, c);
+}
+
+static inline __m256 sqrt(__m256 x) {
+  return _mm256_sqrt_ps(x);
+}
+
+// double
+
+/**
+ * Converts 64-bit integers below 2^51 in magnitude, which AVX2 can't do
+ * directly, by adding them to the bit pattern of 1.5 * 2^52
+ */
+static inline __m256d int64_to_double(__m256i k) {
+  const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+  return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(k, _mm256_castpd_si256(magic))), magic);
+}
+
+static inline __m256d log(__m256d x) {
+  const __m256d min_normal = _mm256_set1_pd(2.2250738585072014e-308);
+  __m256d denormal = _mm256_cmp_pd(x, min_normal, _CMP_LT_OQ);
+  __m256d y = _mm256_blendv_pd(x, _mm256_mul_pd(x, _mm256_set1_pd(18014398509481984.0)), denormal);
+
+  // y = 2^k * m with m in [1, 2)
+  __m256i bits = _mm256_castpd_si256(y);
+  __m256i k = _mm256_sub_epi64(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(1023));
+  k = _mm256_sub_epi64(k, _mm256_and_si256(_mm256_castpd_si256(denormal), _mm256_set1_epi64x(54)));
+  __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFULL)),
+                                                  _mm256_set1_epi64x(0x3FF0000000000000ULL)));
+
+  // move m to [sqrt(1/2), sqrt(2)), both steps exact
+  __m256d large = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+  k = _mm256_sub_epi64(k, _mm256_castpd_si256(large));
+  m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), large);
+  __m256d f = _mm256_sub_pd(m, _mm256_set1_pd(1.0));
+  __m256d kd = int64_to_double(k);
+
+  __m256d s = _mm256_div_pd(f, _mm256_add_pd(f, _mm256_set1_pd(2.0)));
+  __m256d z = _mm256_mul_pd(s, s);
+  __m256d w = _mm256_mul_pd(z, z);
+  __m256d t1 = _mm256_fmadd_pd(w, _mm256_set1_pd(1.531383769920937332e-01), _mm256_set1_pd(2.222219843214978396e-01));
+  t1 = _mm256_fmadd_pd(w, t1, _mm256_set1_pd(3.999999999940941908e-01));
+  t1 = _mm256_mul_pd(w, t1);
+  __m256d t2 = _mm256_fmadd_pd(w, _mm256_set1_pd(1.479819860511658591e-01), _mm256_set1_pd(1.818357216161805012e-01));
+  t2 = _mm256_fmadd_pd(w, t2, _mm256_set1_pd(2.857142874366239149e-01));
+  t2 = _mm256_fmadd_pd(w, t2, _mm256_set1_pd(6.666666666666735130e-01));
+  t2 = _mm256_mul_pd(z, t2);
+  __m256d R = _mm256_add_pd(t1, t2);
+
+  // k * ln2_hi - ((hfsq - (s * (hfsq + R) + k * ln2_lo)) - f)
+  __m256d hfsq = _mm256_mul_pd(_mm256_set1_pd(0.5), _mm256_mul_pd(f, f));
+  __m256d inner = _mm256_fmadd_pd(s, _mm256_add_pd(hfsq, R), _mm256_mul_pd(kd, _mm256_set1_pd(1.90821492927058770002e-10)));
+  __m256d result = _mm256_sub_pd(_mm256_mul_pd(kd, _mm256_set1_pd(6.93147180369123816490e-01)),
+                                 _mm256_sub_pd(_mm256_sub_pd(hfsq, inner), f));
+
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d inf = _mm256_set1_pd(__builtin_inf());
+  result = _mm256_blendv_pd(result, _mm256_set1_pd(-__builtin_inf()), _mm256_cmp_pd(x, zero, _CMP_EQ_OQ));
+  result = _mm256_blendv_pd(result, inf, _mm256_cmp_pd(x, inf, _CMP_EQ_OQ));
+  return _mm256_blendv_pd(result, _mm256_set1_pd(__builtin_nan("")), _mm256_cmp_pd(x, zero, _CMP_NGE_UQ));
+}
+
+/**
+ * The inverse of int64_to_double for integral x below 2^51 in magnitude
+ */
+static inline __m256i double_to_int64(__m256d x) {
+  const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+  return _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(x, magic)), _mm256_castpd_si256(magic));
+}
+
+static inline __m256d exp(__m256d x) {
+  // see the float version for NaN
+  x = _mm256_min_pd(_mm256_set1_pd(710.0), _mm256_max_pd(_mm256_set1_pd(-746.0), x));
+  __m256d q = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634074)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256d r = _mm256_fnmadd_pd(q, _mm256_set1_pd(6.93145751953125e-1), x);
+  r = _mm256_fnmadd_pd(q, _mm256_set1_pd(1.42860682030941723212e-6), r);
+
+  // Cephes exp: e^r = 1 + 2 r P(r^2) / (Q(r^2) - r P(r^2))
+  __m256d z = _mm256_mul_pd(r, r);
+  __m256d p = _mm256_set1_pd(1.26177193074810590878e-4);
+  p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(3.02994407707441961300e-2));
+  p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(9.99999999999999999910e-1));
+  p = _mm256_mul_pd(p, r);
+  __m256d d = _mm256_set1_pd(3.00198505138664455042e-6);
+  d = _mm256_fmadd_pd(d, z, _mm256_set1_pd(2.52448340349684104192e-3));
+  d = _mm256_fmadd_pd(d, z, _mm256_set1_pd(2.27265548208155028766e-1));
+  d = _mm256_fmadd_pd(d, z, _mm256_set1_pd(2.00000000000000000009e0));
+  __m256d y = _mm256_fmadd_pd(_mm256_set1_pd(2.0), _mm256_div_pd(p, _mm256_sub_pd(d, p)), _mm256_set1_pd(1.0));
+
+  // 2^q in two factors, see the float version. AVX2 has no 64-bit arithmetic shift, so q is halved as a double
+  __m256d q1 = _mm256_round_pd(_mm256_mul_pd(q, _mm256_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  __m256i n1 = double_to_int64(q1);
+  __m256i n2 = double_to_int64(_mm256_sub_pd(q, q1));
+  __m256d scale1 = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(n1, _mm256_set1_epi64x(1023)), 52));
+  __m256d scale2 = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(n2, _mm256_set1_epi64x(1023)), 52));
+  return _mm256_mul_pd(_mm256_mul_pd(y, scale1), scale2);
+}
+
+static inline void sincos_quadrant(__m256d r, __m256i qi, __m256d& s, __m256d& c) {
+  __m256d z = _mm256_mul_pd(r, r);
+  __m256d sp = _mm256_set1_pd(1.58962301576546568060e-10);
+  sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(-2.50507477628578072866e-8));
+  sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(2.75573136213857245213e-6));
+  sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(-1.98412698295895385996e-4));
+  sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(8.33333333332211858878e-3));
+  sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(-1.66666666666666307295e-1));
+  __m256d sin_r = _mm256_fmadd_pd(_mm256_mul_pd(sp, z), r, r);
+  __m256d cp = _mm256_set1_pd(-1.13585365213876817300e-11);
+  cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(2.08757008419747316778e-9));
+  cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(-2.75573141792967388112e-7));
+  cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(2.48015872888517045348e-5));
+  cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(-1.38888888888730564116e-3));
+  cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(4.16666666666665929218e-2));
+  __m256d cos_r = _mm256_fmadd_pd(_mm256_mul_pd(cp, z), z, _mm256_fnmadd_pd(z, _mm256_set1_pd(0.5), _mm256_set1_pd(1.0)));
+
+  // see the float version for the quadrant fix up
+  __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(qi, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1)));
+  __m256d sin_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(qi, _mm256_set1_epi64x(2)), 62));
+  __m256d cos_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(qi, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(2)), 62));
+  s = _mm256_xor_pd(_mm256_blendv_pd(sin_r, cos_r, swap), sin_sign);
+  c = _mm256_xor_pd(_mm256_blendv_pd(cos_r, sin_r, swap), cos_sign);
+}
+
+static inline void sincos_2pi(__m256d turns, __m256d& s, __m256d& c) {
+  __m256d quarters = _mm256_mul_pd(turns, _mm256_set1_pd(4.0));
+  __m256d q = _mm256_round_pd(quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  // exact, |r| <= pi / 4
+  __m256d r = _mm256_mul_pd(_mm256_sub_pd(quarters, q), _mm256_set1_pd(1.57079632679489661923));
+  sincos_quadrant(r, _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q)), s, c);
+}
+
+static inline void sincos(__m256d x, __m256d& s, __m256d& c) {
+  __m256d q = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(0.63661977236758134308)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  // see the float version
+  __m256d r = _mm256_fnmadd_pd(q, _mm256_set1_pd(1.5707963267948966), x);
+  r = _mm256_fnmadd_pd(q, _mm256_set1_pd(6.123233995736766e-17), r);
+  r = _mm256_fnmadd_pd(q, _mm256_set1_pd(-1.4973849048591698e-33), r);
+  sincos_quadrant(r, _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q)), s, c);
+}
+
+static inline __m256d sqrt(__m256d x) {
+  return _mm256_sqrt_pd(x);
+}
+
+#ifdef __AVX512F__
+// float, AVX-512. getexp and getmant take denormals apart directly and
+// scalef applies 2^q with a single rounding.
+//
+// GCC 12 builds the unmasked AVX-512 intrinsics, such as _mm512_srli_epi32
+// or _mm512_getexp_ps, on the masked builtin with _mm512_undefined_*() as
+// the pass-through, a self-initialized variable that sets off a spurious
+// -Wmaybe-uninitialized once inlined. The maskz forms with a full mask
+// compute the same thing with zero as the pass-through, so they are used
+// here and in Uniform.h.
+
+static inline __m512 log(__m512 x) {
+  // x = 2^e * m with m in [1, 2), then m in [sqrt(1/2), sqrt(2))
+  __m512 m = _mm512_maskz_getmant_ps(0xFFFF, x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+  __m512 ef = _mm512_maskz_getexp_ps(0xFFFF, x);
+  __mmask16 large = _mm512_cmp_ps_mask(m, _mm512_set1_ps(1.41421356237309504880f), _CMP_GT_OQ);
+  m = _mm512_mask_mul_ps(m, large, m, _mm512_set1_ps(0.5f));
+  ef = _mm512_mask_add_ps(ef, large, ef, _mm512_set1_ps(1.0f));
+  m = _mm512_sub_ps(m, _mm512_set1_ps(1.0f));
+
+  // see the AVX2 version
+  __m512 z = _mm512_mul_ps(m, m);
+  __m512 p = _mm512_set1_ps(7.0376836292e-2f);
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-1.1514610310e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(1.1676998740e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-1.2420140846e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(1.4249322787e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-1.6668057665e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(2.0000714765e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-2.4999993993e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(3.3333331174e-1f));
+  p = _mm512_mul_ps(_mm512_mul_ps(p, m), z);
+  p = _mm512_fmadd_ps(ef, _mm512_set1_ps(-2.12194440e-4f), p);
+  p = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), p);
+  __m512 result = _mm512_fmadd_ps(ef, _mm512_set1_ps(0.693359375f), _mm512_add_ps(m, p));
+
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 inf = _mm512_set1_ps(__builtin_inff());
+  result = _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, zero, _CMP_EQ_OQ), _mm512_set1_ps(-__builtin_inff()));
+  result = _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, inf, _CMP_EQ_OQ), inf);
+  return _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, zero, _CMP_NGE_UQ), _mm512_set1_ps(__builtin_nanf("")));
+}
+
+static inline __m512 exp(__m512 x) {
+  x = _mm512_maskz_min_ps(0xFFFF, _mm512_set1_ps(89.0f), _mm512_maskz_max_ps(0xFFFF, _mm512_set1_ps(-104.0f), x));
+  __m512 q = _mm512_maskz_roundscale_ps(0xFFFF, _mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r = _mm512_fnmadd_ps(q, _mm512_set1_ps(0.693359375f), x);
+  r = _mm512_fnmadd_ps(q, _mm512_set1_ps(-2.12194440e-4f), r);
+
+  __m512 z = _mm512_mul_ps(r, r);
+  __m512 p = _mm512_set1_ps(1.9875691500e-4f);
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+  p = _mm512_fmadd_ps(p, z, _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+  return _mm512_maskz_scalef_ps(0xFFFF, p, q);
+}
+
+static inline void sincos_quadrant(__m512 r, __m512i qi, __m512& s, __m512& c) {
+  __m512 z = _mm512_mul_ps(r, r);
+  __m512 sp = _mm512_set1_ps(-1.9515295891e-4f);
+  sp = _mm512_fmadd_ps(sp, z, _mm512_set1_ps(8.3321608736e-3f));
+  sp = _mm512_fmadd_ps(sp, z, _mm512_set1_ps(-1.6666654611e-1f));
+  __m512 sin_r = _mm512_fmadd_ps(_mm512_mul_ps(sp, z), r, r);
+  __m512 cp = _mm512_set1_ps(2.443315711809948e-5f);
+  cp = _mm512_fmadd_ps(cp, z, _mm512_set1_ps(-1.388731625493765e-3f));
+  cp = _mm512_fmadd_ps(cp, z, _mm512_set1_ps(4.166664568298827e-2f));
+  __m512 cos_r = _mm512_fmadd_ps(_mm512_mul_ps(cp, z), z, _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), _mm512_set1_ps(1.0f)));
+
+  // see the AVX2 version for the quadrant fix up
+  __mmask16 swap = _mm512_test_epi32_mask(qi, _mm512_set1_epi32(1));
+  __m512i sin_sign = _mm512_maskz_slli_epi32(0xFFFF, _mm512_and_si512(qi, _mm512_set1_epi32(2)), 30);
+  __m512i cos_sign = _mm512_maskz_slli_epi32(0xFFFF, _mm512_and_si512(_mm512_add_epi32(qi, _mm512_set1_epi32(1)), _mm512_set1_epi32(2)), 30);
+  s = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, sin_r, cos_r)), sin_sign));
+  c = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, cos_r, sin_r)), cos_sign));
+}
+
+static inline void sincos_2pi(__m512 turns, __m512& s, __m512& c) {
+  __m512 quarters = _mm512_mul_ps(turns, _mm512_set1_ps(4.0f));
+  __m512 q = _mm512_maskz_roundscale_ps(0xFFFF, quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r = _mm512_mul_ps(_mm512_sub_ps(quarters, q), _mm512_set1_ps(1.57079632679489662f));
+  sincos_quadrant(r, _mm512_maskz_cvtps_epi32(0xFFFF, q), s, c);
+}
+
+static inline void sincos(__m512 x, __m512& s, __m512& c) {
+  __m512 q = _mm512_maskz_roundscale_ps(0xFFFF, _mm512_mul_ps(x, _mm512_set1_ps(0.636619772367581343f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r = _mm512_fnmadd_ps(q, _mm512_set1_ps(1.570796371e+00f), x);
+  r = _mm512_fnmadd_ps(q, _mm512_set1_ps(-4.371138829e-08f), r);
+  r = _mm512_fnmadd_ps(q, _mm512_set1_ps(-1.715124510e-15f), r);
+  sincos_quadrant(r, _mm512_maskz_cvtps_epi32(0xFFFF, q), s, c);
+}
+
+static inline __m512 sqrt(__m512 x) {
+  return _mm512_maskz_sqrt_ps(0xFFFF, x);
+}
+
+// double, AVX-512
+
+static inline __m512d log(__m512d x) {
+  __m512d m = _mm512_maskz_getmant_pd(0xFF, x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+  __m512d kd = _mm512_maskz_getexp_pd(0xFF, x);
+  __mmask8 large = _mm512_cmp_pd_mask(m, _mm512_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+  m = _mm512_mask_mul_pd(m, large, m, _mm512_set1_pd(0.5));
+  kd = _mm512_mask_add_pd(kd, large, kd, _mm512_set1_pd(1.0));
+  __m512d f = _mm512_sub_pd(m, _mm512_set1_pd(1.0));
+
+  // see the AVX2 version
+  __m512d s = _mm512_div_pd(f, _mm512_add_pd(f, _mm512_set1_pd(2.0)));
+  __m512d z = _mm512_mul_pd(s, s);
+  __m512d w = _mm512_mul_pd(z, z);
+  __m512d t1 = _mm512_fmadd_pd(w, _mm512_set1_pd(1.531383769920937332e-01), _mm512_set1_pd(2.222219843214978396e-01));
+  t1 = _mm512_fmadd_pd(w, t1, _mm512_set1_pd(3.999999999940941908e-01));
+  t1 = _mm512_mul_pd(w, t1);
+  __m512d t2 = _mm512_fmadd_pd(w, _mm512_set1_pd(1.479819860511658591e-01), _mm512_set1_pd(1.818357216161805012e-01));
+  t2 = _mm512_fmadd_pd(w, t2, _mm512_set1_pd(2.857142874366239149e-01));
+  t2 = _mm512_fmadd_pd(w, t2, _mm512_set1_pd(6.666666666666735130e-01));
+  t2 = _mm512_mul_pd(z, t2);
+  __m512d R = _mm512_add_pd(t1, t2);
+  __m512d hfsq = _mm512_mul_pd(_mm512_set1_pd(0.5), _mm512_mul_pd(f, f));
+  __m512d inner = _mm512_fmadd_pd(s, _mm512_add_pd(hfsq, R), _mm512_mul_pd(kd, _mm512_set1_pd(1.90821492927058770002e-10)));
+  __m512d result = _mm512_sub_pd(_mm512_mul_pd(kd, _mm512_set1_pd(6.93147180369123816490e-01)),
+                                 _mm512_sub_pd(_mm512_sub_pd(hfsq, inner), f));
+
+  const __m512d zero = _mm512_setzero_pd();
+  const __m512d inf = _mm512_set1_pd(__builtin_inf());
+  result = _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, zero, _CMP_EQ_OQ), _mm512_set1_pd(-__builtin_inf()));
+  result = _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, inf, _CMP_EQ_OQ), inf);
+  return _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, zero, _CMP_NGE_UQ), _mm512_set1_pd(__builtin_nan("")));
+}
+
+static inline __m512d exp(__m512d x) {
+  x = _mm512_maskz_min_pd(0xFF, _mm512_set1_pd(710.0), _mm512_maskz_max_pd(0xFF, _mm512_set1_pd(-746.0), x));
+  __m512d q = _mm512_maskz_roundscale_pd(0xFF, _mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634074)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512d r = _mm512_fnmadd_pd(q, _mm512_set1_pd(6.93145751953125e-1), x);
+  r = _mm512_fnmadd_pd(q, _mm512_set1_pd(1.42860682030941723212e-6), r);
+
+  __m512d z = _mm512_mul_pd(r, r);
+  __m512d p = _mm512_set1_pd(1.26177193074810590878e-4);
+  p = _mm512_fmadd_pd(p, z, _mm512_set1_pd(3.02994407707441961300e-2));
+  p = _mm512_fmadd_pd(p, z, _mm512_set1_pd(9.99999999999999999910e-1));
+  p = _mm512_mul_pd(p, r);
+  __m512d d = _mm512_set1_pd(3.00198505138664455042e-6);
+  d = _mm512_fmadd_pd(d, z, _mm512_set1_pd(2.52448340349684104192e-3));
+  d = _mm512_fmadd_pd(d, z, _mm512_set1_pd(2.27265548208155028766e-1));
+  d = _mm512_fmadd_pd(d, z, _mm512_set1_pd(2.00000000000000000009e0));
+  __m512d y = _mm512_fmadd_pd(_mm512_set1_pd(2.0), _mm512_div_pd(p, _mm512_sub_pd(d, p)), _mm512_set1_pd(1.0));
+  return _mm512_maskz_scalef_pd(0xFF, y, q);
+}
+
+static inline void sincos_quadrant(__m512d r, __m512i qi, __m512d& s, __m512d& c) {
+  __m512d z = _mm512_mul_pd(r, r);
+  __m512d sp = _mm512_set1_pd(1.58962301576546568060e-10);
+  sp = _mm512_fmadd_pd(sp, z, _mm512_set1_pd(-2.50507477628578072866e-8));
+  sp = _mm512_fmadd_pd(sp, z, _mm512_set1_pd(2.75573136213857245213e-6));
+  sp = _mm512_fmadd_pd(sp, z, _mm512_set1_pd(-1.98412698295895385996e-4));
+  sp = _mm512_fmadd_pd(sp, z, _mm512_set1_pd(8.33333333332211858878e-3));
+  sp = _mm512_fmadd_pd(sp, z, _mm512_set1_pd(-1.66666666666666307295e-1));
+  __m512d sin_r = _mm512_fmadd_pd(_mm512_mul_pd(sp, z), r, r);
+  __m512d cp = _mm512_set1_pd(-1.13585365213876817300e-11);
+  cp = _mm512_fmadd_pd(cp, z, _mm512_set1_pd(2.08757008419747316778e-9));
+  cp = _mm512_fmadd_pd(cp, z, _mm512_set1_pd(-2.75573141792967388112e-7));
+  cp = _mm512_fmadd_pd(cp, z, _mm512_set1_pd(2.48015872888517045348e-5));
+  cp = _mm512_fmadd_pd(cp, z, _mm512_set1_pd(-1.38888888888730564116e-3));
+  cp = _mm512_fmadd_pd(cp, z, _mm512_set1_pd(4.16666666666665929218e-2));
+  __m512d cos_r = _mm512_fmadd_pd(_mm512_mul_pd(cp, z), z, _mm512_fnmadd_pd(z, _mm512_set1_pd(0.5), _mm512_set1_pd(1.0)));
+
+  __mmask8 swap = _mm512_test_epi64_mask(qi, _mm512_set1_epi64(1));
+  __m512i sin_sign = _mm512_maskz_slli_epi64(0xFF, _mm512_and_si512(qi, _mm512_set1_epi64(2)), 62);
+  __m512i cos_sign = _mm512_maskz_slli_epi64(0xFF, _mm512_and_si512(_mm512_add_epi64(qi, _mm512_set1_epi64(1)), _mm512_set1_epi64(2)), 62);
+  s = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_mask_blend_pd(swap, sin_r, cos_r)), sin_sign));
+  c = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_mask_blend_pd(swap, cos_r, sin_r)), cos_sign));
+}
+
+static inline void sincos_2pi(__m512d turns, __m512d& s, __m512d& c) {
+  __m512d quarters = _mm512_mul_pd(turns, _mm512_set1_pd(4.0));
+  __m512d q = _mm512_maskz_roundscale_pd(0xFF, quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512d r = _mm512_mul_pd(_mm512_sub_pd(quarters, q), _mm512_set1_pd(1.57079632679489661923));
+  sincos_quadrant(r, _mm512_maskz_cvtepi32_epi64(0xFF, _mm512_maskz_cvtpd_epi32(0xFF, q)), s, c);
+}
+
+static inline void sincos(__m512d x, __m512d& s, __m512d& c) {
+  __m512d q = _mm512_maskz_roundscale_pd(0xFF, _mm512_mul_pd(x, _mm512_set1_pd(0.63661977236758134308)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512d r = _mm512_fnmadd_pd(q, _mm512_set1_pd(1.5707963267948966), x);
+  r = _mm512_fnmadd_pd(q, _mm512_set1_pd(6.123233995736766e-17), r);
+  r = _mm512_fnmadd_pd(q, _mm512_set1_pd(-1.4973849048591698e-33), r);
+  sincos_quadrant(r, _mm512_maskz_cvtepi32_epi64(0xFF, _mm512_maskz_cvtpd_epi32(0xFF, q)), s, c);
+}
+
+static inline __m512d sqrt(__m512d x) {
+  return _mm512_maskz_sqrt_pd(0xFF, x);
+}
+#endif
+
+} // namespace simd
+} // namespace at
@@ -0,0 +1,189 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+
+#include "ParallelFor.h"
+#include "PhiloxSIMD.h"
+#include "Uniform.h"
+#include "UniformInt.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace at {
+
+/**
+ * Note [Parallel shuffle]
+ * ~~~~~~~~~~~~~~~~~~~~~~~
+ * Refer to: Sanders, "Random Permutations on Distributed, External and
+ * Hierarchical Memory", IPL 67 (1998).
+ *
+ * Fisher-Yates is one bounded draw and one random access per element and
+ * can't be split between threads. Instead the n elements are cut into B
+ * contiguous chunks and sent to B buckets:
+ *
+ *   1. every element of every chunk draws a bucket, and each chunk counts
+ *      how many of its elements go to each bucket
+ *   2. a prefix sum over (bucket, chunk) gives every chunk its place in
+ *      every bucket, and the chunks redraw the same buckets and scatter
+ *      their elements there
+ *   3. every bucket is shuffled with Fisher-Yates
+ *
+ * Independent uniform buckets followed by uniform permutations within the
+ * buckets give a uniform permutation of the whole. B is the smallest power
+ * of two, at most 1024, that makes buckets of about 2^16 elements, so a
+ * bucket stays in L2 while it is shuffled and a bucket is the top bits of
+ * a word, exactly uniform. For n up to 2^16 there is a single bucket and
+ * this is plain Fisher-Yates. Past n = 2^26 the cap on B makes buckets
+ * larger, about 10^5 to 10^6 elements for n of 10^8 to 10^9, and a bucket
+ * of more than 2^17 elements is shuffled the same way in turn, on the
+ * thread that took it, instead of by Fisher-Yates. So Fisher-Yates only
+ * ever sees up to 2^17 elements, in L2 and within the 32-bit bound of
+ * uniform_int.
+ *
+ * Chunk c draws from philox_simd_engine(seed, c) and bucket b from
+ * philox_simd_engine(seed, 1024 + b). A bucket shuffled in turn uses
+ * subsequences 2048 (1024 + b + 1) on for its own chunks and buckets, and
+ * so on down. B depends only on n and bucket sizes only on (n, seed), so
+ * the result depends only on (n, seed), never on the number of threads.
+ * Each phase hands chunks or buckets to the threads one at a time, and
+ * the threads are joined between phases.
+ *
+ * randperm scatters the indices themselves, while shuffle first copies the
+ * data so that it can be scattered back into place.
+ */
+
+namespace detail {
+
+constexpr uint64_t kShuffleBucketSize = 1 << 16;
+constexpr int kShuffleMaxBucketsLog2 = 10;
+constexpr uint64_t kShuffleMaxFisherYates = 2 * kShuffleBucketSize;
+
+static inline int shuffle_buckets_log2(uint64_t n) {
+  int k = 0;
+  while (k < kShuffleMaxBucketsLog2 && (n >> k) > kShuffleBucketSize) {
+    k++;
+  }
+  return k;
+}
+
+/**
+ * n is at most kShuffleMaxFisherYates, so i fits the 32-bit bound
+ */
+template <typename T>
+static inline void fisher_yates(T* data, uint64_t n, philox_simd_engine& gen) {
+  for (uint64_t i = n; i > 1; i--) {
+    std::swap(data[i - 1], data[uniform_int(gen, static_cast<uint32_t>(i))]);
+  }
+}
+
+template <typename T>
+static inline void shuffle_bucket(T* data, uint64_t n, uint64_t seed, uint64_t subsequence);
+
+/**
+ * Calls fn(i, bucket) for the elements i of chunk c, [begin, end), in order
+ */
+template <typename fn_t>
+static inline void shuffle_targets(uint64_t seed, uint64_t subsequence, uint64_t begin, uint64_t end, int buckets_log2, const fn_t& fn) {
+  philox_simd_engine gen(seed, subsequence, 0);
+  uint32_t words[kUniformBatch];
+  for (uint64_t i = begin; i < end; i += kUniformBatch) {
+    uint64_t count = std::min<uint64_t>(kUniformBatch, end - i);
+    random_bits(gen, words, count);
+    for (uint64_t j = 0; j < count; j++) {
+      fn(i + j, words[j] >> (32 - buckets_log2));
+    }
+  }
+}
+
+/**
+ * Writes a random permutation of value(0), ..., value(n - 1) to dst, for
+ * n with more than one bucket, drawing from subsequences base on
+ */
+template <typename T, typename value_fn_t>
+static inline void bucket_shuffle(T* dst, uint64_t n, uint64_t seed, uint64_t num_threads, const value_fn_t& value, uint64_t base = 0) {
+  const int buckets_log2 = shuffle_buckets_log2(n);
+  const uint64_t buckets = 1ULL << buckets_log2;
+  const uint64_t chunk = (n + buckets - 1) / buckets;
+  // counts, then places, of chunk c in bucket b at c * buckets + b
+  std::vector<uint64_t> places(buckets * buckets, 0);
+  parallel_for(buckets, num_threads, [&](uint64_t c) {
+    uint64_t* count = places.data() + c * buckets;
+    shuffle_targets(seed, base + c, std::min(n, c * chunk), std::min(n, (c + 1) * chunk), buckets_log2,
+                    [&](uint64_t, uint32_t b) { count[b]++; });
+  });
+  std::vector<uint64_t> bucket_start(buckets + 1);
+  uint64_t sum = 0;
+  for (uint64_t b = 0; b < buckets; b++) {
+    bucket_start[b] = sum;
+    for (uint64_t c = 0; c < buckets; c++) {
+      uint64_t count = places[c * buckets + b];
+      places[c * buckets + b] = sum;
+      sum += count;
+    }
+  }
+  bucket_start[buckets] = n;
+  parallel_for(buckets, num_threads, [&](uint64_t c) {
+    uint64_t* place = places.data() + c * buckets;
+    shuffle_targets(seed, base + c, std::min(n, c * chunk), std::min(n, (c + 1) * chunk), buckets_log2,
+                    [&](uint64_t i, uint32_t b) { dst[place[b]++] = value(i); });
+  });
+  parallel_for(buckets, num_threads, [&](uint64_t b) {
+    shuffle_bucket(dst + bucket_start[b], bucket_start[b + 1] - bucket_start[b], seed, base + (1ULL << kShuffleMaxBucketsLog2) + b);
+  });
+}
+
+/**
+ * Randomly permutes one bucket of n elements, by Fisher-Yates from
+ * subsequence or for n past kShuffleMaxFisherYates by buckets of its own
+ */
+template <typename T>
+static inline void shuffle_bucket(T* data, uint64_t n, uint64_t seed, uint64_t subsequence) {
+  if (n > kShuffleMaxFisherYates) {
+    std::vector<T> src(data, data + n);
+    bucket_shuffle(data, n, seed, 1, [&](uint64_t i) { return src[i]; }, (subsequence + 1) << (kShuffleMaxBucketsLog2 + 1));
+    return;
+  }
+  philox_simd_engine gen(seed, subsequence, 0);
+  fisher_yates(data, n, gen);
+}
+
+} // namespace detail
+
+/**
+ * Writes a random permutation of 0, ..., n - 1 to dst using up to
+ * num_threads threads, see Note [Parallel shuffle]
+ */
+template <typename index_t>
+static inline void randperm(index_t* dst, uint64_t n, uint64_t seed, uint64_t num_threads = 1) {
+  if (detail::shuffle_buckets_log2(n) == 0) {
+    for (uint64_t i = 0; i < n; i++) {
+      dst[i] = static_cast<index_t>(i);
+    }
+    detail::shuffle_bucket(dst, n, seed, 1ULL << detail::kShuffleMaxBucketsLog2);
+    return;
+  }
+  detail::bucket_shuffle(dst, n, seed, num_threads, [](uint64_t i) { return static_cast<index_t>(i); });
+}
+
+/**
+ * Randomly permutes the n elements of data using up to num_threads
+ * threads, see Note [Parallel shuffle]
+ */
+template <typename T>
+static inline void shuffle(T* data, uint64_t n, uint64_t seed, uint64_t num_threads = 1) {
+  if (detail::shuffle_buckets_log2(n) == 0) {
+    detail::shuffle_bucket(data, n, seed, 1ULL << detail::kShuffleMaxBucketsLog2);
+    return;
+  }
+  std::vector<T> src(data, data + n);
+  detail::bucket_shuffle(data, n, seed, num_threads, [&](uint64_t i) { return src[i]; });
+}
+
+} // namespace at
@@ -0,0 +1,300 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#ifdef __AVX2__
+#include <x86intrin.h>
+#endif
+#include "splitmix64.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace at {
+
+/**
+ * Note [Sobol engine implementation]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Low-discrepancy (quasi-random) sequence in up to kMaxDimensions
+ * dimensions, with 32 bits per coordinate, i.e. at most 2^32 points.
+ * Refer to: Joe & Kuo, "Constructing Sobol sequences with better
+ * two-dimensional projections", SIAM J. Sci. Comput. 30 (2008).
+ *
+ * Direction numbers:
+ * Dimension 0 is the van der Corput sequence. Dimension d > 0 uses the
+ * d-th primitive polynomial over GF(2), ordered by degree and then by
+ * coefficients the same way the Joe-Kuo tables are. The polynomials are
+ * enumerated at construction instead of being shipped as a table, and
+ * degrees up to 13 give 1 + 1110 dimensions. The initial direction numbers
+ * m_1..m_s are fixed odd values drawn from splitmix64, not the Joe-Kuo
+ * search results. This is a valid Sobol sequence, but its two-dimensional
+ * projections are not optimized.
+ *
+ * Generation:
+ * Points are produced in Gray code order, so point n + 1 is point n XOR
+ * one row of direction numbers, the row picked by the lowest zero bit of
+ * n. Rows are stored contiguously across dimensions (padded to 8) and the
+ * XOR runs 8 dimensions per AVX2 instruction. skip_to(n) builds point n
+ * from scratch in O(dimensions * log n), so threads can take disjoint
+ * blocks of the sequence:
+ *
+ *   sobol_engine gen(dims, thread_idx * points_per_thread);
+ *
+ * Point n is the same whether it was reached by stepping or skipping.
+ * The first point of the sequence (n = 0) is the origin.
+ */
+class sobol_engine {
+public:
+  static const uint32_t kMaxDimensions = 1111;
+  static const int kBits = 32;
+
+  inline explicit sobol_engine(uint32_t dimensions, uint64_t index = 0)
+      : dims_(dimensions), padded_dims_((dimensions + 7) & ~7u) {
+    if (dimensions == 0 || dimensions > kMaxDimensions) {
+      throw std::runtime_error("Sobol dimensions must be between 1 and " + std::to_string(kMaxDimensions));
+    }
+    directions_.assign(kBits * padded_dims_, 0);
+    state_.assign(padded_dims_, 0);
+    init_directions();
+    skip_to(index);
+  }
+
+  inline uint32_t dimensions() const {
+    return dims_;
+  }
+
+  /**
+   * Index of the point the next call will return
+   */
+  inline uint64_t index() const {
+    return index_;
+  }
+
+  /**
+   * Jumps to point n of the sequence in O(dimensions * log n)
+   */
+  inline void skip_to(uint64_t n) {
+    if (n >> kBits) {
+      throw std::runtime_error("Sobol index out of range, the sequence has 2^32 points");
+    }
+    index_ = n;
+    uint64_t gray = n ^ (n >> 1);
+    std::fill(state_.begin(), state_.end(), 0);
+    for (int bit = 0; gray != 0; bit++, gray >>= 1) {
+      if (gray & 1) {
+        xor_row(bit);
+      }
+    }
+  }
+
+  /**
+   * Writes the current point as dimensions() 32-bit integers and advances
+   */
+  inline void next(uint32_t* dst) {
+    check_remaining();
+    std::copy(state_.begin(), state_.begin() + dims_, dst);
+    advance();
+  }
+
+  /**
+   * Writes the current point as dimensions() floats in [0, 1) and advances
+   */
+  inline void next_float(float* dst) {
+    check_remaining();
+    uint32_t d = 0;
+#ifdef __AVX2__
+    const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+    for (; d + 8 <= dims_; d += 8) {
+      // keep 24 bits so the conversion is exact and never rounds up to 1
+      __m256i x = _mm256_srli_epi32(_mm256_loadu_si256((__m256i*)&state_[d]), 8);
+      _mm256_storeu_ps(dst + d, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+#endif
+    for (; d < dims_; d++) {
+      dst[d] = (state_[d] >> 8) * (1.0f / 16777216.0f);
+    }
+    advance();
+  }
+
+  /**
+   * Writes the current point as dimensions() doubles in [0, 1) and advances
+   */
+  inline void next_double(double* dst) {
+    check_remaining();
+    uint32_t d = 0;
+#ifdef __AVX2__
+    const __m256d scale = _mm256_set1_pd(1.0 / 4294967296.0);
+    const __m256d bias = _mm256_set1_pd(2147483648.0);
+    for (; d + 4 <= dims_; d += 4) {
+      // there is no unsigned conversion before AVX-512, so flip the sign bit
+      // to convert as signed and add 2^31 back
+      __m128i x = _mm_xor_si128(_mm_loadu_si128((__m128i*)&state_[d]), _mm_set1_epi32(0x80000000));
+      __m256d v = _mm256_add_pd(_mm256_cvtepi32_pd(x), bias);
+      _mm256_storeu_pd(dst + d, _mm256_mul_pd(v, scale));
+    }
+#endif
+    for (; d < dims_; d++) {
+      dst[d] = state_[d] * (1.0 / 4294967296.0);
+    }
+    advance();
+  }
+
+  /**
+   * Writes num_points consecutive points, point major
+   */
+  inline void generate_float(float* dst, uint64_t num_points) {
+    for (uint64_t p = 0; p < num_points; p++, dst += dims_) {
+      next_float(dst);
+    }
+  }
+
+  inline void generate_double(double* dst, uint64_t num_points) {
+    for (uint64_t p = 0; p < num_points; p++, dst += dims_) {
+      next_double(dst);
+    }
+  }
+
+private:
+  uint32_t dims_;
+  uint32_t padded_dims_;
+  uint64_t index_;
+  // directions_[bit * padded_dims_ + dim]
+  std::vector<uint32_t> directions_;
+  std::vector<uint32_t> state_;
+
+  inline void check_remaining() const {
+    if (index_ >> kBits) {
+      throw std::runtime_error("Sobol sequence exhausted, it has 2^32 points");
+    }
+  }
+
+  /**
+   * Steps to the next point, or past the end after the last one, where the
+   * next call to write a point throws
+   */
+  inline void advance() {
+    int bit = __builtin_ctzll(~index_);
+    if (bit < kBits) {
+      xor_row(bit);
+    }
+    index_++;
+  }
+
+  inline void xor_row(int bit) {
+    const uint32_t* row = &directions_[bit * padded_dims_];
+    uint32_t* x = &state_[0];
+    uint32_t d = 0;
+#ifdef __AVX2__
+    for (; d < padded_dims_; d += 8) {
+      __m256i v = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(x + d)), _mm256_loadu_si256((__m256i*)(row + d)));
+      _mm256_storeu_si256((__m256i*)(x + d), v);
+    }
+#endif
+    for (; d < padded_dims_; d++) {
+      x[d] ^= row[d];
+    }
+  }
+
+  /**
+   * Multiplies two polynomials over GF(2) modulo poly of the given degree
+   */
+  static inline uint32_t mulmod(uint32_t a, uint32_t b, uint32_t poly, int degree) {
+    uint32_t r = 0;
+    for (; b != 0; b >>= 1) {
+      if (b & 1) {
+        r ^= a;
+      }
+      a <<= 1;
+      if (a >> degree) {
+        a ^= poly;
+      }
+    }
+    return r;
+  }
+
+  static inline uint32_t powmod_x(uint64_t e, uint32_t poly, int degree) {
+    uint32_t result = 1;
+    uint32_t base = degree == 1 ? (2 ^ poly) : 2;
+    for (; e != 0; e >>= 1) {
+      if (e & 1) {
+        result = mulmod(result, base, poly, degree);
+      }
+      base = mulmod(base, base, poly, degree);
+    }
+    return result;
+  }
+
+  /**
+   * A polynomial of degree s is primitive when x has multiplicative
+   * order exactly 2^s - 1 modulo it
+   */
+  static inline bool is_primitive(uint32_t poly, int degree) {
+    if ((poly & 1) == 0) {
+      return false;
+    }
+    uint64_t order = (1ULL << degree) - 1;
+    if (powmod_x(order, poly, degree) != 1) {
+      return false;
+    }
+    uint64_t rest = order;
+    for (uint64_t q = 2; q * q <= rest; q++) {
+      if (rest % q == 0) {
+        if (powmod_x(order / q, poly, degree) == 1) {
+          return false;
+        }
+        while (rest % q == 0) {
+          rest /= q;
+        }
+      }
+    }
+    if (rest > 1 && rest != order && powmod_x(order / rest, poly, degree) == 1) {
+      return false;
+    }
+    return true;
+  }
+
+  inline void init_directions() {
+    // dimension 0: van der Corput
+    for (int k = 0; k < kBits; k++) {
+      directions_[k * padded_dims_] = 1u << (kBits - 1 - k);
+    }
+    uint64_t seed = 0x5EED50B01ULL;
+    uint32_t dim = 1;
+    for (int s = 1; dim < dims_; s++) {
+      for (uint32_t a = 0; a < (1u << (s - 1)) && dim < dims_; a++) {
+        uint32_t poly = (1u << s) | (a << 1) | 1u;
+        if (!is_primitive(poly, s)) {
+          continue;
+        }
+        uint32_t m[kBits];
+        for (int k = 0; k < s && k < kBits; k++) {
+          // odd and below 2^(k + 1)
+          m[k] = (static_cast<uint32_t>(splitmix64(seed)) & ((2u << k) - 1)) | 1u;
+        }
+        for (int k = s; k < kBits; k++) {
+          uint32_t mk = m[k - s] ^ (m[k - s] << s);
+          for (int i = 1; i < s; i++) {
+            if ((a >> (s - 1 - i)) & 1) {
+              mk ^= m[k - i] << i;
+            }
+          }
+          m[k] = mk;
+        }
+        for (int k = 0; k < kBits; k++) {
+          directions_[k * padded_dims_ + dim] = m[k] << (kBits - 1 - k);
+        }
+        dim++;
+      }
+    }
+  }
+};
+
+} // namespace at
@@ -0,0 +1,255 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "ParallelFor.h"
+#include "PhiloxSIMD.h"
+#include <algorithm>
+#include <cmath>
+
+namespace at {
+
+/**
+ * Note [Stochastic rounding]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Rounds x to one of its two neighbours in the narrow format, the upper
+ * one with probability (x - lower) / (upper - lower), so that the rounded
+ * value is x on average. Each element takes a 16-bit random piece r,
+ * two per 32-bit word:
+ *
+ *   bfloat16  r is added to the float's bits, which are then truncated
+ *             to their top 16. Inside a binade the bits are linear in the
+ *             value and a carry moves to the next binade, so this is exact
+ *             for every float, denormals included.
+ *   fp16      the same with the float's low d bits, d = 13 in the normal
+ *             range of fp16 and more below 2^-14, r shifted to fit them
+ *             and the d bits cleared after the add.
+ *             Below 2^-24 the neighbours are 0 and 2^-24, and r / 2^16 is
+ *             compared with x / 2^-24 directly. The truncation is F16C's
+ *             vcvtps2ph toward zero, or float_to_half_toward_zero without
+ *             F16C. Finite values beyond 65504 give 65504.
+ *   int8      floor(x * (1 / scale) + r / 2^16), saturated to
+ *             [-128, 127]. The sum is a float, so near the ends of the
+ *             range the probability is off by up to 2^-17.
+ *
+ * Infinities stay infinite and NaN stays NaN, or becomes 0 in int8. The
+ * probabilities are exact to 2^-16 except where noted.
+ *
+ * The pieces are a function of (seed, element): element g of the stream
+ * uses piece g % 64 of philox_simd_engine(seed, 0, 8 * (g / 64))'s first
+ * next32 block, i.e. the low then high half of each of its 32 words. A call
+ * covers elements [offset, offset + n) of the stream, so rounding a tensor
+ * in one call or in several calls with the matching offsets gives the
+ * same result. The calls split the range into chunks of
+ * kStochasticRoundChunk elements, aligned to the stream, and hand them to
+ * up to num_threads threads with parallel_for from ParallelFor.h,
+ * which changes the speed but never the result. The rounding reads the
+ * floats and writes the narrow values in one pass, converting 16 elements
+ * per eight words in registers.
+ */
+
+namespace detail {
+
+constexpr uint64_t kStochasticRoundChunk = 1 << 16;
+
+/**
+ * float to fp16, rounding toward zero, finite values saturating at 65504
+ */
+static inline uint16_t float_to_half_toward_zero(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t abs = x & 0x7FFFFFFF;
+  if (abs > 0x7F800000) {
+    return static_cast<uint16_t>(sign | 0x7E00);
+  }
+  if (abs == 0x7F800000) {
+    return static_cast<uint16_t>(sign | 0x7C00);
+  }
+  if (abs >= 0x477FE000) {
+    return static_cast<uint16_t>(sign | 0x7BFF);
+  }
+  if (abs < 0x38800000) {
+    float a;
+    memcpy(&a, &abs, sizeof(a));
+    return static_cast<uint16_t>(sign | static_cast<uint32_t>(a * 16777216.0f));
+  }
+  return static_cast<uint16_t>(sign | ((abs - 0x38000000) >> 13));
+}
+
+struct stochastic_bfloat16 {
+  typedef uint16_t out_t;
+
+  inline void store8(const float* src, uint16_t* dst, __m256i pieces) const {
+    __m256 x = _mm256_loadu_ps(src);
+    // NaN keeps its bits, the carry could otherwise reach the sign
+    __m256i noise = _mm256_andnot_si256(_mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q)), pieces);
+    __m256i bits = _mm256_srli_epi32(_mm256_add_epi32(_mm256_castps_si256(x), noise), 16);
+    _mm_storeu_si128((__m128i*)dst, _mm_packus_epi32(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1)));
+  }
+};
+
+struct stochastic_half {
+  typedef uint16_t out_t;
+
+  inline void store8(const float* src, uint16_t* dst, __m256i pieces) const {
+    __m256i bits = _mm256_castps_si256(_mm256_loadu_ps(src));
+    __m256i sign = _mm256_and_si256(bits, _mm256_set1_epi32(static_cast<int>(0x80000000U)));
+    __m256i mag = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF));
+    __m256i exponent = _mm256_srli_epi32(mag, 23);
+    __m256i finite = _mm256_cmpgt_epi32(_mm256_set1_epi32(255), exponent);
+    // past 65504 the result is 65504, and the noise must not carry into inf
+    mag = _mm256_blendv_epi8(mag, _mm256_min_epu32(mag, _mm256_set1_epi32(0x477FE000)), finite);
+    // dropped bits, 13 for normal fp16 and one more per binade below; the
+    // shift that doesn't apply is out of range and gives 0
+    __m256i d = _mm256_max_epi32(_mm256_set1_epi32(13), _mm256_sub_epi32(_mm256_set1_epi32(126), exponent));
+    __m256i noise = _mm256_or_si256(_mm256_srlv_epi32(pieces, _mm256_sub_epi32(_mm256_set1_epi32(16), d)),
+                                    _mm256_sllv_epi32(pieces, _mm256_sub_epi32(d, _mm256_set1_epi32(16))));
+    // a carry into the next binade can leave bits it doesn't keep, they go
+    __m256i keep = _mm256_sllv_epi32(_mm256_set1_epi32(-1), d);
+    __m256i rounded = _mm256_blendv_epi8(mag, _mm256_and_si256(_mm256_add_epi32(mag, noise), keep), finite);
+    // below 2^-24, 2^-24 with probability x / 2^-24 and 0 otherwise
+    __m256 u = _mm256_mul_ps(_mm256_cvtepi32_ps(pieces), _mm256_set1_ps(1.0f / 65536.0f));
+    __m256 scaled = _mm256_mul_ps(_mm256_castsi256_ps(mag), _mm256_set1_ps(16777216.0f));
+    __m256i tiny = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(u, scaled, _CMP_LT_OQ)), _mm256_set1_epi32(0x33800000));
+    rounded = _mm256_blendv_epi8(rounded, tiny, _mm256_cmpgt_epi32(_mm256_set1_epi32(103), exponent));
+    __m256 y = _mm256_castsi256_ps(_mm256_or_si256(rounded, sign));
+#ifdef __F16C__
+    _mm_storeu_si128((__m128i*)dst, _mm256_cvtps_ph(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+#else
+    float lanes[8];
+    _mm256_storeu_ps(lanes, y);
+    for (int i = 0; i < 8; i++) {
+      dst[i] = float_to_half_toward_zero(lanes[i]);
+    }
+#endif
+  }
+};
+
+struct stochastic_int8 {
+  typedef int8_t out_t;
+  float inv_scale;
+
+  inline void store8(const float* src, int8_t* dst, __m256i pieces) const {
+    __m256 q = _mm256_mul_ps(_mm256_loadu_ps(src), _mm256_set1_ps(inv_scale));
+    __m256 u = _mm256_mul_ps(_mm256_cvtepi32_ps(pieces), _mm256_set1_ps(1.0f / 65536.0f));
+    __m256 f = _mm256_floor_ps(_mm256_add_ps(q, u));
+    f = _mm256_min_ps(_mm256_max_ps(f, _mm256_set1_ps(-128.0f)), _mm256_set1_ps(127.0f));
+    // NaN comes out of the clamp as -128 and is made 0
+    f = _mm256_andnot_ps(_mm256_cmp_ps(q, q, _CMP_UNORD_Q), f);
+    __m256i i32 = _mm256_cvttps_epi32(f);
+    __m128i i16 = _mm_packs_epi32(_mm256_castsi256_si128(i32), _mm256_extracti128_si256(i32, 1));
+    _mm_storel_epi64((__m128i*)dst, _mm_packs_epi16(i16, i16));
+  }
+};
+
+/**
+ * The 64 elements of one next32 block
+ */
+template <typename rounder_t>
+static inline void stochastic_round_block(const rounder_t& r, const float* src, typename rounder_t::out_t* dst, const __m256i (&out)[4]) {
+  for (int j = 0; j < 4; j++) {
+    // the words as 16 pieces in draw order, zero extended to 32 bits
+    r.store8(src + 16 * j, dst + 16 * j, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(out[j])));
+    r.store8(src + 16 * j + 8, dst + 16 * j + 8, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(out[j], 1)));
+  }
+}
+
+/**
+ * Elements [g, stop) of the block starting at element block, src and dst
+ * pointing at element g
+ */
+template <typename rounder_t>
+static inline void stochastic_round_partial(const rounder_t& r, const float* src, typename rounder_t::out_t* dst, uint64_t block, uint64_t g,
+                                            uint64_t stop, const __m256i (&out)[4]) {
+  float s[64] = {0};
+  typename rounder_t::out_t d[64];
+  std::copy(src, src + (stop - g), s + (g - block));
+  stochastic_round_block(r, s, d, out);
+  std::copy(d + (g - block), d + (stop - block), dst);
+}
+
+/**
+ * Rounds the elements [begin, end) of the stream, src and dst pointing at
+ * element begin. Whole blocks are drawn two at a time with next32_unrolled.
+ */
+template <typename rounder_t>
+static inline void stochastic_round_range(const rounder_t& r, const float* src, typename rounder_t::out_t* dst, uint64_t begin, uint64_t end,
+                                          uint64_t seed) {
+  philox_simd_engine gen(seed, 0, (begin / 64) * 8);
+  uint64_t g = begin;
+  __m256i out[2][4];
+  if (g % 64 != 0) {
+    uint64_t block = g & ~63ULL;
+    uint64_t stop = std::min(end, block + 64);
+    gen.next32(out[0][0], out[0][1], out[0][2], out[0][3]);
+    stochastic_round_partial(r, src, dst, block, g, stop, out[0]);
+    g = stop;
+  }
+  for (; g + 128 <= end; g += 128) {
+    gen.next32_unrolled(out);
+    stochastic_round_block(r, src + (g - begin), dst + (g - begin), out[0]);
+    stochastic_round_block(r, src + (g - begin) + 64, dst + (g - begin) + 64, out[1]);
+  }
+  for (; g < end; g += 64) {
+    gen.next32(out[0][0], out[0][1], out[0][2], out[0][3]);
+    if (g + 64 <= end) {
+      stochastic_round_block(r, src + (g - begin), dst + (g - begin), out[0]);
+    } else {
+      stochastic_round_partial(r, src + (g - begin), dst + (g - begin), g, g, end, out[0]);
+    }
+  }
+}
+
+template <typename rounder_t>
+static inline void stochastic_round(const rounder_t& r, const float* src, typename rounder_t::out_t* dst, uint64_t n, uint64_t seed,
+                                    uint64_t offset, uint64_t num_threads) {
+  const uint64_t first = offset / kStochasticRoundChunk;
+  const uint64_t last = (offset + n + kStochasticRoundChunk - 1) / kStochasticRoundChunk;
+  parallel_for(last - first, num_threads, [&](uint64_t c) {
+    uint64_t begin = std::max(offset, (first + c) * kStochasticRoundChunk);
+    uint64_t end = std::min(offset + n, (first + c + 1) * kStochasticRoundChunk);
+    stochastic_round_range(r, src + (begin - offset), dst + (begin - offset), begin, end, seed);
+  });
+}
+
+} // namespace detail
+
+/**
+ * Stochastically rounds src to bfloat16, as elements [offset, offset + n)
+ * of the stream of seed, see Note [Stochastic rounding]
+ */
+static inline void stochastic_round_bfloat16(const float* src, uint16_t* dst, uint64_t n, uint64_t seed, uint64_t offset = 0,
+                                             uint64_t num_threads = 1) {
+  detail::stochastic_round(detail::stochastic_bfloat16(), src, dst, n, seed, offset, num_threads);
+}
+
+/**
+ * Stochastically rounds src to fp16, as elements [offset, offset + n) of
+ * the stream of seed, see Note [Stochastic rounding]
+ */
+static inline void stochastic_round_half(const float* src, uint16_t* dst, uint64_t n, uint64_t seed, uint64_t offset = 0,
+                                         uint64_t num_threads = 1) {
+  detail::stochastic_round(detail::stochastic_half(), src, dst, n, seed, offset, num_threads);
+}
+
+/**
+ * Stochastically rounds src / scale to int8, as elements [offset, offset + n)
+ * of the stream of seed, see Note [Stochastic rounding]
+ */
+static inline void stochastic_round_int8(const float* src, int8_t* dst, uint64_t n, float scale, uint64_t seed, uint64_t offset = 0,
+                                         uint64_t num_threads = 1) {
+  detail::stochastic_int8 r;
+  r.inv_scale = 1.0f / scale;
+  detail::stochastic_round(r, src, dst, n, seed, offset, num_threads);
+}
+
+} // namespace at
@@ -0,0 +1,280 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "ParallelFor.h"
+#include "PhiloxSIMD.h"
+#include "SIMDMath.h"
+#include "Uniform.h"
+#include "Ziggurat.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace at {
+
+/**
+ * Note [Truncated normals]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ * Refer to: Giles, "Approximating the erfinv function", GPU Computing Gems
+ * Jade Edition (2011); Robert, "Simulation of truncated normal variables",
+ * Statistics and Computing 5 (1995).
+ *
+ * A normal with the given mean and stddev, restricted to [a, b]. With
+ * alpha = (a - mean) / stddev and beta = (b - mean) / stddev, the
+ * standard normal restricted to [alpha, beta] is sampled one of three
+ * ways, none of which wastes draws on the part outside the interval:
+ *
+ *   central      alpha < 0 < beta, or both bounds on the same side of 0
+ *                with the nearer one within 1 of it, inversion: x uniform
+ *                between erf(alpha / sqrt2) and erf(beta / sqrt2) and
+ *                z = sqrt2 * erfinv(x)
+ *   tail         both bounds on the same side of 0, mirrored to the
+ *                positive side, with 1 < alpha < 3. Inversion again, but q
+ *                is uniform between erfc(beta / sqrt2) and erfc(alpha /
+ *                sqrt2) and z = sqrt2 * erfinv(1 - q), so that q keeps its
+ *                relative precision far from the mode. Near the mode q is
+ *                close to 1, where floats are 2^-24 apart and a narrow
+ *                interval such as [0, 1e-4] would get only about 1300
+ *                distinct values, which is why that is left to erf, whose
+ *                values there are close to 0.
+ *   exponential  mirrored alpha >= 3, where the inversion would run out of
+ *                precision. Robert's rejection from an exponential with rate
+ *                lambda = (alpha + sqrt(alpha^2 + 4)) / 2 shifted to alpha
+ *                and cut off at beta, accepting about 95% or more.
+ *
+ * erfinv is Giles' single precision approximation, one polynomial in
+ * w = -log((1 - x) (1 + x)) for w < 5 and one in sqrt(w) for the rest. It
+ * takes 1 - x and 1 + x as inputs, which the tail mode knows exactly as q
+ * and 2 - q. Both polynomials are evaluated only when the eight lanes
+ * need both, which for the central mode is once in a while (|z| > 2.9).
+ * The polynomials lose accuracy below 1 - x = 2^-24, so x and q are held
+ * to at least that far from 1 and z is never larger than about 5.4; that
+ * is the largest normal float inversion can give, and it cuts off less
+ * than 2^-24 of the mass of central and 2^-15 of tail intervals.
+ *
+ * Every output is mean + stddev * z clamped to [a, b], so rounding never
+ * puts one outside. The inversion takes one word per output and the
+ * rejection two per proposal, through detail::word_buffer, eight outputs at
+ * a time. A lane whose proposal is rejected is redone in double by the
+ * scalar loop. a or b may be infinite.
+ *
+ * The seeded truncated_normal_float fills chunks of kTruncatedNormalChunk
+ * outputs on up to num_threads threads, chunk c from
+ * philox_simd_engine(seed, c), so the result depends on the seed and not
+ * on the number of threads, as for randperm in Note [Parallel shuffle].
+ */
+
+namespace detail {
+
+constexpr uint64_t kTruncatedNormalChunk = 1 << 16;
+
+enum class truncated_normal_method { central, tail, exponential };
+
+struct truncated_normal_params {
+  truncated_normal_method method;
+  // output bounds, and z to output as mean + scale * z
+  float a, b, mean, scale;
+  // central and tail: x or q is start + u * range for u uniform in [0, 1)
+  float start, range;
+  // exponential: the mirrored interval, the rate and 1 - exp(-lambda (beta - alpha))
+  double alpha, beta, lambda, cutoff;
+
+  inline truncated_normal_params(float mean_, float stddev, float a_, float b_) : a(a_), b(b_), mean(mean_) {
+    if (!(std::isfinite(mean_) && stddev > 0.0f && std::isfinite(stddev))) {
+      throw std::runtime_error("truncated normal needs a finite mean and a positive finite stddev");
+    }
+    if (!(a_ < b_)) {
+      throw std::runtime_error("truncated normal needs a < b");
+    }
+    alpha = (static_cast<double>(a_) - mean_) / stddev;
+    beta = (static_cast<double>(b_) - mean_) / stddev;
+    const double sqrt1_2 = 0.70710678118654752440;
+    if (alpha <= 1.0 && beta >= -1.0) {
+      method = truncated_normal_method::central;
+      scale = static_cast<float>(stddev * M_SQRT2);
+      double lo = std::erf(alpha * sqrt1_2);
+      start = static_cast<float>(lo);
+      range = static_cast<float>(std::erf(beta * sqrt1_2) - lo);
+      return;
+    }
+    double sign = 1.0;
+    if (beta <= 0.0) {
+      sign = -1.0;
+      std::swap(alpha, beta);
+      alpha = -alpha;
+      beta = -beta;
+    }
+    if (alpha < 3.0) {
+      method = truncated_normal_method::tail;
+      scale = static_cast<float>(sign * stddev * M_SQRT2);
+      double lo = std::erfc(beta * sqrt1_2);
+      start = static_cast<float>(lo);
+      range = static_cast<float>(std::erfc(alpha * sqrt1_2) - lo);
+    } else {
+      method = truncated_normal_method::exponential;
+      scale = static_cast<float>(sign * stddev);
+      lambda = 0.5 * (alpha + std::sqrt(alpha * alpha + 4.0));
+      cutoff = -std::expm1(-lambda * (beta - alpha));
+    }
+  }
+};
+
+/**
+ * Giles' erfinv(x), given 1 - x and 1 + x as well
+ */
+static inline __m256 erfinv(__m256 x, __m256 one_minus_x, __m256 one_plus_x) {
+  __m256 w = _mm256_sub_ps(_mm256_setzero_ps(), simd::log(_mm256_mul_ps(one_minus_x, one_plus_x)));
+  __m256 far = _mm256_cmp_ps(w, _mm256_set1_ps(5.0f), _CMP_GE_OQ);
+  int lanes = _mm256_movemask_ps(far);
+  __m256 p = _mm256_setzero_ps();
+  if (lanes != 0xFF) {
+    __m256 t = _mm256_sub_ps(w, _mm256_set1_ps(2.5f));
+    p = _mm256_set1_ps(2.81022636e-08f);
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(3.43273939e-07f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-3.5233877e-06f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-4.39150654e-06f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(0.00021858087f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-0.00125372503f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-0.00417768164f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(0.246640727f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(1.50140941f));
+  }
+  if (lanes) {
+    __m256 t = _mm256_sub_ps(_mm256_sqrt_ps(w), _mm256_set1_ps(3.0f));
+    __m256 q = _mm256_set1_ps(-0.000200214257f);
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(0.000100950558f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(0.00134934322f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(-0.00367342844f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(0.00573950773f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(-0.0076224613f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(0.00943887047f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(1.00167406f));
+    q = _mm256_fmadd_ps(q, t, _mm256_set1_ps(2.83297682f));
+    p = _mm256_blendv_ps(p, q, far);
+  }
+  return _mm256_mul_ps(p, x);
+}
+
+/**
+ * Robert's rejection for the mirrored interval, drawing until a proposal
+ * is accepted
+ */
+template <typename engine_t>
+static inline double truncated_normal_exponential_scalar(const truncated_normal_params& p, word_buffer<engine_t>& words) {
+  for (;;) {
+    // 1 - u is in [0, 1), so the log stays finite
+    double z = p.alpha - std::log(1.0 - (1.0 - words.uniform()) * p.cutoff) / p.lambda;
+    double d = z - p.lambda;
+    if (words.uniform() <= std::exp(-0.5 * d * d)) {
+      return z;
+    }
+  }
+}
+
+/**
+ * Eight standard values of the mirrored interval for the exponential method
+ */
+template <typename engine_t>
+static inline __m256 truncated_normal_exponential8(const truncated_normal_params& p, word_buffer<engine_t>& words) {
+  const uniform_params<float> closed(0.0f, 1.0f, uniform_interval::closed_open);
+  const uniform_params<float> open(0.0f, 1.0f, uniform_interval::open_closed);
+  __m256 v = uniform_float_avx2<false>(_mm256_loadu_si256((const __m256i*)words.next8()), closed);
+  __m256 u = uniform_float_avx2<true>(_mm256_loadu_si256((const __m256i*)words.next8()), open);
+  // z = alpha - log(1 - v * cutoff) / lambda, kept when u <= exp(-(z - lambda)^2 / 2)
+  __m256 t = _mm256_fnmadd_ps(v, _mm256_set1_ps(static_cast<float>(p.cutoff)), _mm256_set1_ps(1.0f));
+  __m256 z = _mm256_fnmadd_ps(simd::log(t), _mm256_set1_ps(static_cast<float>(1.0 / p.lambda)), _mm256_set1_ps(static_cast<float>(p.alpha)));
+  __m256 d = _mm256_sub_ps(z, _mm256_set1_ps(static_cast<float>(p.lambda)));
+  __m256 bound = simd::exp(_mm256_mul_ps(_mm256_mul_ps(d, d), _mm256_set1_ps(-0.5f)));
+  int rejected = _mm256_movemask_ps(_mm256_cmp_ps(u, bound, _CMP_GT_OQ));
+  if (rejected) {
+    float lanes[8];
+    _mm256_storeu_ps(lanes, z);
+    while (rejected) {
+      int lane = __builtin_ctz(rejected);
+      rejected &= rejected - 1;
+      lanes[lane] = static_cast<float>(truncated_normal_exponential_scalar(p, words));
+    }
+    z = _mm256_loadu_ps(lanes);
+  }
+  return z;
+}
+
+/**
+ * Eight outputs, see Note [Truncated normals]
+ */
+template <typename engine_t>
+static inline __m256 truncated_normal8(const truncated_normal_params& p, word_buffer<engine_t>& words) {
+  const uniform_params<float> closed(0.0f, 1.0f, uniform_interval::closed_open);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  // 1 - 2^-24, the largest float below 1
+  const __m256 largest = _mm256_set1_ps(0.99999994f);
+  const __m256 smallest = _mm256_set1_ps(5.96046448e-08f);
+  __m256 z;
+  if (p.method == truncated_normal_method::exponential) {
+    z = truncated_normal_exponential8(p, words);
+  } else {
+    __m256 u = uniform_float_avx2<false>(_mm256_loadu_si256((const __m256i*)words.next8()), closed);
+    __m256 y = _mm256_fmadd_ps(u, _mm256_set1_ps(p.range), _mm256_set1_ps(p.start));
+    if (p.method == truncated_normal_method::central) {
+      __m256 x = _mm256_min_ps(_mm256_max_ps(y, _mm256_sub_ps(_mm256_setzero_ps(), largest)), largest);
+      z = erfinv(x, _mm256_sub_ps(one, x), _mm256_add_ps(one, x));
+    } else {
+      __m256 q = _mm256_max_ps(y, smallest);
+      z = erfinv(_mm256_sub_ps(one, q), q, _mm256_sub_ps(_mm256_set1_ps(2.0f), q));
+    }
+  }
+  __m256 out = _mm256_fmadd_ps(z, _mm256_set1_ps(p.scale), _mm256_set1_ps(p.mean));
+  return _mm256_min_ps(_mm256_max_ps(out, _mm256_set1_ps(p.a)), _mm256_set1_ps(p.b));
+}
+
+template <typename engine_t>
+static inline void truncated_normal_fill(engine_t& gen, float* dst, uint64_t n, const truncated_normal_params& p) {
+  word_buffer<engine_t> words(gen);
+  uint64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, truncated_normal8(p, words));
+  }
+  if (i < n) {
+    float tail[8];
+    _mm256_storeu_ps(tail, truncated_normal8(p, words));
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+} // namespace detail
+
+/**
+ * Writes n floats from the normal with the given mean and stddev truncated
+ * to [a, b], see Note [Truncated normals]
+ */
+template <typename engine_t>
+static inline void truncated_normal_float(engine_t& gen, float* dst, uint64_t n, float mean, float stddev, float a, float b) {
+  const detail::truncated_normal_params p(mean, stddev, a, b);
+  detail::truncated_normal_fill(gen, dst, n, p);
+}
+
+/**
+ * Writes n floats from the normal with the given mean and stddev truncated
+ * to [a, b] using up to num_threads threads, the same for any number of
+ * threads, see Note [Truncated normals]
+ */
+static inline void truncated_normal_float(float* dst, uint64_t n, uint64_t seed, float mean, float stddev, float a, float b,
+                                          uint64_t num_threads = 1) {
+  const detail::truncated_normal_params p(mean, stddev, a, b);
+  const uint64_t chunks = (n + detail::kTruncatedNormalChunk - 1) / detail::kTruncatedNormalChunk;
+  detail::parallel_for(chunks, num_threads, [&](uint64_t c) {
+    philox_simd_engine gen(seed, c, 0);
+    uint64_t begin = c * detail::kTruncatedNormalChunk;
+    detail::truncated_normal_fill(gen, dst + begin, std::min(detail::kTruncatedNormalChunk, n - begin), p);
+  });
+}
+
+} // namespace at
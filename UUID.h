@@ -0,0 +1,127 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "PhiloxSIMD.h"
+
+namespace at {
+
+/**
+ * Note [Batch UUIDv4]
+ * ~~~~~~~~~~~~~~~~~~~
+ * A version 4 UUID is 16 random bytes except for the top nibble of byte 6,
+ * the version 0100, and the top two bits of byte 8, the variant 10, which
+ * leaves 122 random bits. uuid4_binary takes each next32 block of
+ * philox_simd_engine as eight UUIDs, the block's bytes in the order
+ * random_bits gives its words, and sets the version and variant bits with
+ * an and and an or on the registers, two UUIDs per register. A partial
+ * block at the end is drawn in full and the unused UUIDs dropped.
+ *
+ * uuid4_hex formats the same UUIDs as their 36 characters,
+ * xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx in lower case, one after the other
+ * with no separator or terminating NUL. The nibbles of a UUID are split
+ * and interleaved into the order they are printed in, pshufb looks them up
+ * in "0123456789abcdef" and two more pshufb spread the digits out to make
+ * room for the dashes. Both give the same UUIDs from engines in the same
+ * state.
+ */
+
+namespace detail {
+
+constexpr uint64_t kUuidBytes = 16;
+constexpr uint64_t kUuidHexChars = 36;
+
+/**
+ * The version and variant bits set in the two UUIDs of a register
+ */
+static inline __m256i uuid4_bits(__m256i words) {
+  const __m256i keep = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, 0x0F, -1, 0x3F, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, -1, 0x0F, -1, 0x3F, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i set = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0x40, 0, static_cast<char>(0x80), 0, 0, 0, 0, 0, 0, 0,
+                                       0, 0, 0, 0, 0, 0, 0x40, 0, static_cast<char>(0x80), 0, 0, 0, 0, 0, 0, 0);
+  return _mm256_or_si256(_mm256_and_si256(words, keep), set);
+}
+
+/**
+ * Writes the 36 characters of uuid to dst
+ */
+static inline void uuid4_format(__m128i uuid, char* dst) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  __m128i lo = _mm_and_si128(uuid, nibble);
+  __m128i hi = _mm_and_si128(_mm_srli_epi16(uuid, 4), nibble);
+  // digits 0 to 15 and 16 to 31, the high nibble of each byte first
+  __m128i first = _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo));
+  __m128i second = _mm_shuffle_epi8(digits, _mm_unpackhi_epi8(hi, lo));
+  // an index with the top bit set gives 0, where the dash is or'ed in
+  const __m128i head = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12, 13);
+  const __m128i head_dashes = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0);
+  // digits 14 to 29
+  __m128i middle_digits = _mm_alignr_epi8(second, first, 14);
+  const __m128i middle = _mm_setr_epi8(0, 1, -1, 2, 3, 4, 5, -1, 6, 7, 8, 9, 10, 11, 12, 13);
+  const __m128i middle_dashes = _mm_setr_epi8(0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0);
+  _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_shuffle_epi8(first, head), head_dashes));
+  _mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(_mm_shuffle_epi8(middle_digits, middle), middle_dashes));
+  int tail = _mm_cvtsi128_si32(_mm_srli_si128(second, 12));
+  memcpy(dst + 32, &tail, 4);
+}
+
+} // namespace detail
+
+/**
+ * Writes count UUIDs of 16 bytes each to dst, see Note [Batch UUIDv4]
+ */
+static inline void uuid4_binary(philox_simd_engine& gen, uint8_t* dst, uint64_t count) {
+  __m256i out[4];
+  uint64_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_si256((__m256i*)(dst + detail::kUuidBytes * i + 32 * j), detail::uuid4_bits(out[j]));
+    }
+  }
+  if (i < count) {
+    uint8_t block[8 * detail::kUuidBytes];
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_si256((__m256i*)(block + 32 * j), detail::uuid4_bits(out[j]));
+    }
+    memcpy(dst + detail::kUuidBytes * i, block, detail::kUuidBytes * (count - i));
+  }
+}
+
+/**
+ * Writes count UUIDs of 36 characters each to dst, see Note [Batch UUIDv4]
+ */
+static inline void uuid4_hex(philox_simd_engine& gen, char* dst, uint64_t count) {
+  __m256i out[4];
+  uint64_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      __m256i uuids = detail::uuid4_bits(out[j]);
+      detail::uuid4_format(_mm256_castsi256_si128(uuids), dst + detail::kUuidHexChars * (i + 2 * j));
+      detail::uuid4_format(_mm256_extracti128_si256(uuids, 1), dst + detail::kUuidHexChars * (i + 2 * j + 1));
+    }
+  }
+  if (i < count) {
+    uint8_t block[8 * detail::kUuidBytes];
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_si256((__m256i*)(block + 32 * j), detail::uuid4_bits(out[j]));
+    }
+    for (uint64_t k = 0; i + k < count; k++) {
+      detail::uuid4_format(_mm_loadu_si128((const __m128i*)(block + detail::kUuidBytes * k)), dst + detail::kUuidHexChars * (i + k));
+    }
+  }
+}
+
+} // namespace at
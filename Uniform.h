@@ -0,0 +1,450 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "PhiloxSIMD.h"
+#include "PhiloxSIMDStreams.h"
+#include "PhiloxVec.h"
+#include "xoshiro256starstar.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace at {
+
+/**
+ * Note [Uniform real conversion]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Random bits become reals with the mantissa trick: the top bits of a
+ * draw go into the mantissa of a number with the exponent of 1.0, which
+ * gives a value m in [1, 2) without an integer to float conversion. The
+ * last bit of resolution that doesn't fit in the mantissa is folded into
+ * the constant subtracted from m, so
+ *
+ *   float:  24 bits of one 32-bit word,    x = (m - (1 - b * 2^-24))
+ *   double: 53 bits of two 32-bit words,   x = (m - (1 - b * 2^-53))
+ *
+ * with b the bit right below the mantissa. Both subtractions are exact,
+ * so x is exactly k * 2^-24 (or k * 2^-53) for the k formed by those bits,
+ * and x in [0, 1) is never 1. The (0, 1] interval uses 1 - x, also exact.
+ * AVX2 has no 64-bit integer conversion at all, which is why doubles go
+ * through the mantissa as well.
+ *
+ * Words are consumed in draw order and a double is the little-endian
+ * pair (word 2i, word 2i + 1), i.e. the same bits as reading the stream
+ * as 64-bit integers. philox_simd_engine is converted straight out of
+ * next32's registers and gives the same values as converting what its
+ * operator() returns; every other engine goes through a small buffer.
+ *
+ * [lo, hi) and (lo, hi] are x * (hi - lo) + lo, clamped so that rounding
+ * in the product can't land on the excluded end or outside the interval.
+ */
+enum class uniform_interval {
+  closed_open,  // [lo, hi)
+  open_closed,  // (lo, hi]
+};
+
+// 32-bit words buffered per conversion for engines without a SIMD path
+constexpr int kUniformBatch = 256;
+
+namespace detail {
+
+constexpr uint32_t kFloatOneBits = 0x3F800000U;
+constexpr uint64_t kDoubleOneBits = 0x3FF0000000000000ULL;
+
+template <typename real_t>
+struct uniform_params {
+  real_t lo;
+  real_t range;
+  real_t lower;
+  real_t upper;
+
+  inline uniform_params(real_t lo_, real_t hi_, uniform_interval interval)
+      : lo(lo_), range(hi_ - lo_), lower(lo_), upper(hi_) {
+    if (interval == uniform_interval::closed_open) {
+      upper = std::nextafter(hi_, lo_);
+    } else {
+      lower = std::nextafter(lo_, hi_);
+    }
+  }
+};
+
+template <typename real_t>
+static inline real_t uniform_fma(real_t x, real_t range, real_t lo) {
+#ifdef __FMA__
+  return std::fma(x, range, lo);
+#else
+  return x * range + lo;
+#endif
+}
+
+template <bool OPEN_CLOSED>
+static inline float uniform_float_scalar(uint32_t bits, const uniform_params<float>& p) {
+  uint32_t m_bits = (bits >> 9) | kFloatOneBits;
+  uint32_t c_bits = kFloatOneBits - ((bits >> 8) & 1);
+  float m, c;
+  memcpy(&m, &m_bits, sizeof(m));
+  memcpy(&c, &c_bits, sizeof(c));
+  float x = m - c;
+  if (OPEN_CLOSED) {
+    x = 1.0f - x;
+  }
+  return std::min(std::max(uniform_fma(x, p.range, p.lo), p.lower), p.upper);
+}
+
+template <bool OPEN_CLOSED>
+static inline double uniform_double_scalar(uint64_t bits, const uniform_params<double>& p) {
+  uint64_t m_bits = (bits >> 12) | kDoubleOneBits;
+  uint64_t c_bits = kDoubleOneBits - ((bits >> 11) & 1);
+  double m, c;
+  memcpy(&m, &m_bits, sizeof(m));
+  memcpy(&c, &c_bits, sizeof(c));
+  double x = m - c;
+  if (OPEN_CLOSED) {
+    x = 1.0 - x;
+  }
+  return std::min(std::max(uniform_fma(x, p.range, p.lo), p.lower), p.upper);
+}
+
+template <bool OPEN_CLOSED>
+static inline __m256 uniform_float_avx2(__m256i bits, const uniform_params<float>& p) {
+  const __m256i one = _mm256_set1_epi32(kFloatOneBits);
+  __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(bits, 9), one));
+  __m256i b = _mm256_and_si256(_mm256_srli_epi32(bits, 8), _mm256_set1_epi32(1));
+  __m256 x = _mm256_sub_ps(m, _mm256_castsi256_ps(_mm256_sub_epi32(one, b)));
+  if (OPEN_CLOSED) {
+    x = _mm256_sub_ps(_mm256_set1_ps(1.0f), x);
+  }
+#ifdef __FMA__
+  x = _mm256_fmadd_ps(x, _mm256_set1_ps(p.range), _mm256_set1_ps(p.lo));
+#else
+  x = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(p.range)), _mm256_set1_ps(p.lo));
+#endif
+  return _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(p.lower)), _mm256_set1_ps(p.upper));
+}
+
+template <bool OPEN_CLOSED>
+static inline __m256d uniform_double_avx2(__m256i bits, const uniform_params<double>& p) {
+  const __m256i one = _mm256_set1_epi64x(kDoubleOneBits);
+  __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 12), one));
+  __m256i b = _mm256_and_si256(_mm256_srli_epi64(bits, 11), _mm256_set1_epi64x(1));
+  __m256d x = _mm256_sub_pd(m, _mm256_castsi256_pd(_mm256_sub_epi64(one, b)));
+  if (OPEN_CLOSED) {
+    x = _mm256_sub_pd(_mm256_set1_pd(1.0), x);
+  }
+#ifdef __FMA__
+  x = _mm256_fmadd_pd(x, _mm256_set1_pd(p.range), _mm256_set1_pd(p.lo));
+#else
+  x = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(p.range)), _mm256_set1_pd(p.lo));
+#endif
+  return _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(p.lower)), _mm256_set1_pd(p.upper));
+}
+
+#ifdef __AVX512F__
+// maskz srli, min and max with a full mask, for the reason given in SIMDMath.h
+template <bool OPEN_CLOSED>
+static inline __m512 uniform_float_avx512(__m512i bits, const uniform_params<float>& p) {
+  const __m512i one = _mm512_set1_epi32(kFloatOneBits);
+  __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_maskz_srli_epi32(0xFFFF, bits, 9), one));
+  __m512i b = _mm512_and_si512(_mm512_maskz_srli_epi32(0xFFFF, bits, 8), _mm512_set1_epi32(1));
+  __m512 x = _mm512_sub_ps(m, _mm512_castsi512_ps(_mm512_sub_epi32(one, b)));
+  if (OPEN_CLOSED) {
+    x = _mm512_sub_ps(_mm512_set1_ps(1.0f), x);
+  }
+  x = _mm512_fmadd_ps(x, _mm512_set1_ps(p.range), _mm512_set1_ps(p.lo));
+  return _mm512_maskz_min_ps(0xFFFF, _mm512_maskz_max_ps(0xFFFF, x, _mm512_set1_ps(p.lower)), _mm512_set1_ps(p.upper));
+}
+
+template <bool OPEN_CLOSED>
+static inline __m512d uniform_double_avx512(__m512i bits, const uniform_params<double>& p) {
+  const __m512i one = _mm512_set1_epi64(kDoubleOneBits);
+  __m512d m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_maskz_srli_epi64(0xFF, bits, 12), one));
+  __m512i b = _mm512_and_si512(_mm512_maskz_srli_epi64(0xFF, bits, 11), _mm512_set1_epi64(1));
+  __m512d x = _mm512_sub_pd(m, _mm512_castsi512_pd(_mm512_sub_epi64(one, b)));
+  if (OPEN_CLOSED) {
+    x = _mm512_sub_pd(_mm512_set1_pd(1.0), x);
+  }
+  x = _mm512_fmadd_pd(x, _mm512_set1_pd(p.range), _mm512_set1_pd(p.lo));
+  return _mm512_maskz_min_pd(0xFF, _mm512_maskz_max_pd(0xFF, x, _mm512_set1_pd(p.lower)), _mm512_set1_pd(p.upper));
+}
+#endif
+
+/**
+ * Converts n words of bits into n floats
+ */
+template <bool OPEN_CLOSED>
+static inline void uniform_float_kernel(const uint32_t* bits, float* dst, uint64_t n, const uniform_params<float>& p) {
+  uint64_t i = 0;
+#ifdef __AVX512F__
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(dst + i, uniform_float_avx512<OPEN_CLOSED>(_mm512_loadu_si512(bits + i), p));
+  }
+#endif
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, uniform_float_avx2<OPEN_CLOSED>(_mm256_loadu_si256((const __m256i*)(bits + i)), p));
+  }
+  for (; i < n; i++) {
+    dst[i] = uniform_float_scalar<OPEN_CLOSED>(bits[i], p);
+  }
+}
+
+/**
+ * Converts 2 * n words of bits into n doubles
+ */
+template <bool OPEN_CLOSED>
+static inline void uniform_double_kernel(const uint32_t* bits, double* dst, uint64_t n, const uniform_params<double>& p) {
+  uint64_t i = 0;
+#ifdef __AVX512F__
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(dst + i, uniform_double_avx512<OPEN_CLOSED>(_mm512_loadu_si512(bits + 2 * i), p));
+  }
+#endif
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(dst + i, uniform_double_avx2<OPEN_CLOSED>(_mm256_loadu_si256((const __m256i*)(bits + 2 * i)), p));
+  }
+  for (; i < n; i++) {
+    uint64_t word;
+    memcpy(&word, bits + 2 * i, sizeof(word));
+    dst[i] = uniform_double_scalar<OPEN_CLOSED>(word, p);
+  }
+}
+
+/**
+ * Fills dst with n 32-bit draws. Engines returning 64 bits per call
+ * provide two words per call, the low half first.
+ */
+static inline void random_bits(xoshiro256starstar_engine& gen, uint32_t* dst, uint64_t n) {
+  uint64_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint64_t word = gen.next();
+    dst[i] = static_cast<uint32_t>(word);
+    dst[i + 1] = static_cast<uint32_t>(word >> 32);
+  }
+  if (i < n) {
+    dst[i] = static_cast<uint32_t>(gen.next());
+  }
+}
+
+/**
+ * philox_simd_engine stores whole next32 blocks. A partial block at the
+ * end is drawn in full and the unused part dropped.
+ */
+static inline void random_bits(philox_simd_engine& gen, uint32_t* dst, uint64_t n) {
+  __m256i out[4];
+  uint64_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_si256((__m256i*)(dst + i + 8 * j), out[j]);
+    }
+  }
+  if (i < n) {
+    gen.next32(out[0], out[1], out[2], out[3]);
+    memcpy(dst + i, out, (n - i) * sizeof(uint32_t));
+  }
+}
+
+/**
+ * philox_simd_streams_engine and philox_vec_engine have no operator() and
+ * store the words generate_transform hands out, in the same order. A
+ * partial block at the end is drawn in full and the unused part dropped.
+ */
+static inline void random_bits(philox_simd_streams_engine& gen, uint32_t* dst, uint64_t n) {
+  gen.generate_transform(n, [dst](uint64_t i, const __m256i (&words)[4], uint64_t count) {
+    memcpy(dst + i, words, count * sizeof(uint32_t));
+  });
+}
+
+template <int LANES>
+static inline void random_bits(philox_vec_engine<LANES>& gen, uint32_t* dst, uint64_t n) {
+  typedef typename philox_vec_engine<LANES>::vec_t vec_t;
+  gen.generate_transform(n, [dst](uint64_t i, const vec_t (&words)[4], uint64_t count) {
+    memcpy(dst + i, words, count * sizeof(uint32_t));
+  });
+}
+
+/**
+ * Any engine whose operator() returns 32 random bits (the pcg32 variant in
+ * PCG.h returns them in a uint64_t)
+ */
+template <typename engine_t>
+static inline void random_bits(engine_t& gen, uint32_t* dst, uint64_t n) {
+  for (uint64_t i = 0; i < n; i++) {
+    dst[i] = static_cast<uint32_t>(gen());
+  }
+}
+
+/**
+ * A single 32-bit draw, for the rare redraws outside a buffer
+ */
+static inline uint32_t random_word(xoshiro256starstar_engine& gen) {
+  return static_cast<uint32_t>(gen.next() >> 32);
+}
+
+template <typename engine_t>
+static inline uint32_t random_word(engine_t& gen) {
+  return static_cast<uint32_t>(gen());
+}
+
+template <bool OPEN_CLOSED, typename engine_t>
+static inline void uniform_float_buffered(engine_t& gen, float* dst, uint64_t n, const uniform_params<float>& p) {
+  uint32_t bits[kUniformBatch];
+  for (uint64_t i = 0; i < n; i += kUniformBatch) {
+    uint64_t count = std::min<uint64_t>(kUniformBatch, n - i);
+    random_bits(gen, bits, count);
+    uniform_float_kernel<OPEN_CLOSED>(bits, dst + i, count, p);
+  }
+}
+
+template <bool OPEN_CLOSED, typename engine_t>
+static inline void uniform_double_buffered(engine_t& gen, double* dst, uint64_t n, const uniform_params<double>& p) {
+  uint32_t bits[kUniformBatch];
+  for (uint64_t i = 0; i < n; i += kUniformBatch / 2) {
+    uint64_t count = std::min<uint64_t>(kUniformBatch / 2, n - i);
+    random_bits(gen, bits, 2 * count);
+    uniform_double_kernel<OPEN_CLOSED>(bits, dst + i, count, p);
+  }
+}
+
+/**
+ * philox_simd_engine converts each next32 block in registers. A partial
+ * block at the end is drawn in full and the unused part dropped.
+ */
+template <bool OPEN_CLOSED>
+static inline void uniform_float_philox_simd(philox_simd_engine& gen, float* dst, uint64_t n, const uniform_params<float>& p) {
+  __m256i out[4];
+  uint64_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_ps(dst + i + 8 * j, uniform_float_avx2<OPEN_CLOSED>(out[j], p));
+    }
+  }
+  if (i < n) {
+    uint32_t bits[32];
+    float tail[32];
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_si256((__m256i*)(bits + 8 * j), out[j]);
+    }
+    uniform_float_kernel<OPEN_CLOSED>(bits, tail, 32, p);
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+template <bool OPEN_CLOSED>
+static inline void uniform_double_philox_simd(philox_simd_engine& gen, double* dst, uint64_t n, const uniform_params<double>& p) {
+  __m256i out[4];
+  uint64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_pd(dst + i + 4 * j, uniform_double_avx2<OPEN_CLOSED>(out[j], p));
+    }
+  }
+  if (i < n) {
+    uint32_t bits[32];
+    double tail[16];
+    gen.next32(out[0], out[1], out[2], out[3]);
+    for (int j = 0; j < 4; j++) {
+      _mm256_storeu_si256((__m256i*)(bits + 8 * j), out[j]);
+    }
+    uniform_double_kernel<OPEN_CLOSED>(bits, tail, 16, p);
+    std::copy(tail, tail + (n - i), dst + i);
+  }
+}
+
+} // namespace detail
+
+/**
+ * Standard UniformRandomBitGenerator of 32-bit words over any engine, so
+ * that std:: distributions can be driven by it. Words are buffered
+ * kUniformBatch at a time in the same order the bulk conversions use.
+ */
+template <typename engine_t>
+class urbg32 {
+public:
+  typedef uint32_t result_type;
+
+  inline explicit urbg32(const engine_t& gen) : gen_(gen), pos_(kUniformBatch) {}
+
+  static constexpr result_type min() {
+    return 0;
+  }
+
+  static constexpr result_type max() {
+    return 0xFFFFFFFFU;
+  }
+
+  inline result_type operator()() {
+    if (pos_ == kUniformBatch) {
+      detail::random_bits(gen_, buffer_, kUniformBatch);
+      pos_ = 0;
+    }
+    return buffer_[pos_++];
+  }
+
+private:
+  engine_t gen_;
+  uint32_t buffer_[kUniformBatch];
+  int pos_;
+};
+
+/**
+ * Writes n floats uniformly distributed over the interval,
+ * see Note [Uniform real conversion]
+ */
+template <typename engine_t>
+static inline void uniform_float(engine_t& gen, float* dst, uint64_t n, float lo = 0.0f, float hi = 1.0f,
+                                 uniform_interval interval = uniform_interval::closed_open) {
+  detail::uniform_params<float> p(lo, hi, interval);
+  if (interval == uniform_interval::closed_open) {
+    detail::uniform_float_buffered<false>(gen, dst, n, p);
+  } else {
+    detail::uniform_float_buffered<true>(gen, dst, n, p);
+  }
+}
+
+static inline void uniform_float(philox_simd_engine& gen, float* dst, uint64_t n, float lo = 0.0f, float hi = 1.0f,
+                                 uniform_interval interval = uniform_interval::closed_open) {
+  detail::uniform_params<float> p(lo, hi, interval);
+  if (interval == uniform_interval::closed_open) {
+    detail::uniform_float_philox_simd<false>(gen, dst, n, p);
+  } else {
+    detail::uniform_float_philox_simd<true>(gen, dst, n, p);
+  }
+}
+
+/**
+ * Writes n doubles uniformly distributed over the interval, two 32-bit
+ * draws each, see Note [Uniform real conversion]
+ */
+template <typename engine_t>
+static inline void uniform_double(engine_t& gen, double* dst, uint64_t n, double lo = 0.0, double hi = 1.0,
+                                  uniform_interval interval = uniform_interval::closed_open) {
+  detail::uniform_params<double> p(lo, hi, interval);
+  if (interval == uniform_interval::closed_open) {
+    detail::uniform_double_buffered<false>(gen, dst, n, p);
+  } else {
+    detail::uniform_double_buffered<true>(gen, dst, n, p);
+  }
+}
+
+static inline void uniform_double(philox_simd_engine& gen, double* dst, uint64_t n, double lo = 0.0, double hi = 1.0,
+                                  uniform_interval interval = uniform_interval::closed_open) {
+  detail::uniform_params<double> p(lo, hi, interval);
+  if (interval == uniform_interval::closed_open) {
+    detail::uniform_double_philox_simd<false>(gen, dst, n, p);
+  } else {
+    detail::uniform_double_philox_simd<true>(gen, dst, n, p);
+  }
+}
+
+} // namespace at
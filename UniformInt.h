@@ -0,0 +1,196 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "PhiloxSIMD.h"
+#include "Uniform.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace at {
+
+/**
+ * Note [Bounded integers]
+ * ~~~~~~~~~~~~~~~~~~~~~~~
+ * Refer to: Lemire, "Fast Random Integer Generation in an Interval",
+ * ACM TOMACS 29 (2019).
+ *
+ * A 32-bit word x becomes an integer in [0, n) as the high half of the
+ * 64-bit product x * n. The low half l tells whether x is in the short
+ * part of its bucket: x is rejected and redrawn when l < 2^32 mod n,
+ * which leaves exactly floor(2^32 / n) words for every result, so the
+ * result is unbiased. Rejections happen with probability (2^32 mod n) / 2^32,
+ * which is 0 for powers of two and just under 1/2 in the worst case,
+ * n = 2^31 + 1.
+ *
+ * The single draw uniform_int(gen, n) computes the modulo only once l < n,
+ * which is the "nearly divisionless" part. The bulk version computes it once
+ * per call instead and compares every l against it.
+ *
+ * For philox_simd_engine the multiply and the compare run on the eight
+ * lanes of each next32 register, using _mm256_mul_epu32 on the even and
+ * odd lanes. Rejected lanes are dropped rather than redrawn: a vector
+ * with all lanes accepted is stored as is, otherwise the accepted lanes
+ * are packed to the front with a permutation built by pdep/pext (BMI2)
+ * and the output position advances by their count. A rejection costs a
+ * lane instead of a serial redraw, so even n = 2^31 + 1 stays vectorized
+ * at about two blocks per 32 results.
+ *
+ * Other engines buffer kUniformBatch words through detail::random_bits and
+ * redraw rejected words one at a time through detail::random_word. A bound
+ * of 0 throws.
+ */
+
+namespace detail {
+
+static inline void check_bound(uint32_t n) {
+  if (n == 0) {
+    throw std::runtime_error("uniform_int bound must be at least 1");
+  }
+}
+
+/**
+ * 2^32 mod n, the low halves below it are rejected
+ */
+static inline uint32_t lemire_threshold(uint32_t n) {
+  return static_cast<uint32_t>(-n) % n;
+}
+
+/**
+ * Result for word x, redrawing from gen while x is rejected
+ */
+template <typename engine_t>
+static inline uint32_t lemire_scalar(engine_t& gen, uint32_t x, uint32_t n, uint32_t threshold) {
+  uint64_t m = static_cast<uint64_t>(x) * n;
+  while (static_cast<uint32_t>(m) < threshold) {
+    m = static_cast<uint64_t>(random_word(gen)) * n;
+  }
+  return static_cast<uint32_t>(m >> 32);
+}
+
+/**
+ * Results for the eight words in x, the returned movemask has the lanes
+ * that were accepted
+ */
+static inline int lemire_avx2(__m256i x, __m256i n, __m256i threshold, __m256i& result) {
+  // mul_epu32 multiplies the even lanes, so the odd ones are shifted down first
+  __m256i even = _mm256_mul_epu32(x, n);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), n);
+  result = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+  __m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+  // low >= threshold, unsigned
+  __m256i accepted = _mm256_cmpeq_epi32(_mm256_max_epu32(low, threshold), low);
+  return _mm256_movemask_ps(_mm256_castsi256_ps(accepted));
+}
+
+/**
+ * Stores the lanes of v set in mask to dst, packed, and returns how many
+ * there are. All eight lanes of dst may be written.
+ */
+static inline int compress_store(uint32_t* dst, __m256i v, int mask) {
+#ifdef __BMI2__
+  // byte i of indices is the lane of the i-th set bit
+  uint64_t lanes = _pdep_u64(static_cast<uint64_t>(mask), 0x0101010101010101ULL) * 0xFF;
+  uint64_t indices = _pext_u64(0x0706050403020100ULL, lanes);
+  __m256i permutation = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<int64_t>(indices)));
+  _mm256_storeu_si256((__m256i*)dst, _mm256_permutevar8x32_epi32(v, permutation));
+  return __builtin_popcount(mask);
+#else
+  uint32_t lanes[8];
+  _mm256_storeu_si256((__m256i*)lanes, v);
+  int written = 0;
+  for (; mask; mask &= mask - 1) {
+    dst[written++] = lanes[__builtin_ctz(mask)];
+  }
+  return written;
+#endif
+}
+
+/**
+ * Writes the accepted results of one next32 block to dst and returns how
+ * many there are, at most 32. All 32 entries of dst may be written.
+ */
+static inline int uniform_int_block(philox_simd_engine& gen, uint32_t* dst, __m256i n, __m256i threshold) {
+  __m256i out[4];
+  gen.next32(out[0], out[1], out[2], out[3]);
+  int written = 0;
+  for (int j = 0; j < 4; j++) {
+    __m256i result;
+    int accepted = lemire_avx2(out[j], n, threshold, result);
+    if (__builtin_expect(accepted == 0xFF, 1)) {
+      _mm256_storeu_si256((__m256i*)(dst + written), result);
+      written += 8;
+    } else {
+      written += compress_store(dst + written, result, accepted);
+    }
+  }
+  return written;
+}
+
+} // namespace detail
+
+/**
+ * One integer in [0, n), see Note [Bounded integers]
+ */
+template <typename engine_t>
+static inline uint32_t uniform_int(engine_t& gen, uint32_t n) {
+  detail::check_bound(n);
+  uint64_t m = static_cast<uint64_t>(detail::random_word(gen)) * n;
+  if (static_cast<uint32_t>(m) < n) {
+    uint32_t threshold = detail::lemire_threshold(n);
+    while (static_cast<uint32_t>(m) < threshold) {
+      m = static_cast<uint64_t>(detail::random_word(gen)) * n;
+    }
+  }
+  return static_cast<uint32_t>(m >> 32);
+}
+
+/**
+ * Writes count integers in [0, n) to dst, see Note [Bounded integers]
+ */
+template <typename engine_t>
+static inline void uniform_int(engine_t& gen, uint32_t* dst, uint64_t count, uint32_t n) {
+  detail::check_bound(n);
+  const uint32_t threshold = detail::lemire_threshold(n);
+  uint32_t bits[kUniformBatch];
+  for (uint64_t i = 0; i < count; i += kUniformBatch) {
+    uint64_t batch = std::min<uint64_t>(kUniformBatch, count - i);
+    detail::random_bits(gen, bits, batch);
+    for (uint64_t j = 0; j < batch; j++) {
+      dst[i + j] = detail::lemire_scalar(gen, bits[j], n, threshold);
+    }
+  }
+}
+
+/**
+ * philox_simd_engine works on next32 blocks directly. Blocks are drawn
+ * until count results have been accepted and the rest of the last block
+ * is dropped.
+ */
+static inline void uniform_int(philox_simd_engine& gen, uint32_t* dst, uint64_t count, uint32_t n) {
+  detail::check_bound(n);
+  const __m256i n_v = _mm256_set1_epi32(n);
+  const __m256i threshold_v = _mm256_set1_epi32(detail::lemire_threshold(n));
+  uint64_t i = 0;
+  while (i + 32 <= count) {
+    i += detail::uniform_int_block(gen, dst + i, n_v, threshold_v);
+  }
+  if (i < count) {
+    // fewer than 32 left, a block written at any of them fits
+    uint32_t tail[64];
+    uint64_t filled = 0;
+    while (filled < count - i) {
+      filled += detail::uniform_int_block(gen, tail + filled, n_v, threshold_v);
+    }
+    std::copy(tail, tail + (count - i), dst + i);
+  }
+}
+
+} // namespace at
@@ -0,0 +1,344 @@
+#pragma once
+
+// define constants like M_PI and C keywords for MSVC
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "Uniform.h"
+#include <cmath>
+
+namespace at {
+
+/**
+ * Note [Ziggurat sampling]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ * Refer to: Marsaglia & Tsang, "The Ziggurat Method for Generating Random
+ * Variables", J. Stat. Softw. 5 (2000).
+ *
+ * The density is covered by equal-area layers: 128 for the normal (one
+ * side, the sign is drawn separately) and 256 for the exponential. A
+ * 32-bit draw picks a layer i and a point x = u * w[i] in it, and x is
+ * accepted outright when u < k[i], i.e. when it falls inside the next
+ * layer up, which happens about 98.8% (normal) and 98.9% (exponential)
+ * of the time. The original RNOR reuses the low bits of the value as the
+ * layer index; here they are kept apart:
+ *
+ *   normal:      bits 0-6 layer, bit 7 sign, bits 8-31 u
+ *   exponential: bits 0-7 layer,             bits 8-31 u
+ *
+ * so k and w are scaled to a 24-bit u and the accepted values have 24
+ * bits of resolution within their layer. Everything else (the wedge test
+ * against the density and the tail beyond r for layer 0) is the paper's
+ * algorithm, drawing further words as needed.
+ *
+ * Eight words at a time go through the AVX2 fast path, which gathers k
+ * and w for the eight layers. Lanes that fail the fast test are redone by
+ * the scalar fallback before the eight are returned, which consumes further
+ * words from the same stream; the last n % 8 outputs use the scalar path
+ * throughout. Words are taken from the engine kUniformBatch at a time via
+ * detail::random_bits, so any engine in this repo can drive the samplers.
+ * A call that is handed an engine drops what is left of its last batch,
+ * up to kUniformBatch - 1 words, and one handed a detail::word_buffer
+ * leaves them in the buffer for the next call.
+ * Output is float. The eight-lane steps are shared with the samplers in
+ * Distributions.h, which draw their normals from the same word_buffer.
+ */
+
+namespace detail {
+
+struct ziggurat_tables {
+  // normal, 128 layers
+  uint32_t kn[128];
+  float wn[128];
+  double fn[128];
+  // exponential, 256 layers
+  uint32_t ke[256];
+  float we[256];
+  double fe[256];
+
+  static constexpr double kNormalR = 3.442619855899;
+  static constexpr double kExponentialR = 7.697117470131487;
+
+  inline ziggurat_tables() {
+    const double m = 16777216.0;  // 2^24
+
+    double dn = kNormalR, tn = dn;
+    const double vn = 9.91256303526217e-3;
+    double q = vn / std::exp(-0.5 * dn * dn);
+    kn[0] = static_cast<uint32_t>((dn / q) * m);
+    kn[1] = 0;
+    wn[0] = static_cast<float>(q / m);
+    wn[127] = static_cast<float>(dn / m);
+    fn[0] = 1.0;
+    fn[127] = std::exp(-0.5 * dn * dn);
+    for (int i = 126; i >= 1; i--) {
+      dn = std::sqrt(-2.0 * std::log(vn / dn + std::exp(-0.5 * dn * dn)));
+      kn[i + 1] = static_cast<uint32_t>((dn / tn) * m);
+      tn = dn;
+      fn[i] = std::exp(-0.5 * dn * dn);
+      wn[i] = static_cast<float>(dn / m);
+    }
+
+    double de = kExponentialR, te = de;
+    const double ve = 3.949659822581572e-3;
+    q = ve / std::exp(-de);
+    ke[0] = static_cast<uint32_t>((de / q) * m);
+    ke[1] = 0;
+    we[0] = static_cast<float>(q / m);
+    we[255] = static_cast<float>(de / m);
+    fe[0] = 1.0;
+    fe[255] = std::exp(-de);
+    for (int i = 254; i >= 1; i--) {
+      de = -std::log(ve / de + std::exp(-de));
+      ke[i + 1] = static_cast<uint32_t>((de / te) * m);
+      te = de;
+      fe[i] = std::exp(-de);
+      we[i] = static_cast<float>(de / m);
+    }
+  }
+};
+
+static inline const ziggurat_tables& ziggurat() {
+  static const ziggurat_tables tables;
+  return tables;
+}
+
+/**
+ * Hands out an engine's 32-bit words in draw order, one at a time, eight
+ * at a time or any number at a time. Words are drawn kUniformBatch at a
+ * time, so up to kUniformBatch - 1 of them are dropped with the buffer,
+ * and fewer than eight words left in the buffer are skipped when eight
+ * are asked for. The samplers that draw through it take one from the
+ * caller to keep the leftover words for the next call.
+ */
+template <typename engine_t>
+class word_buffer {
+public:
+  inline explicit word_buffer(engine_t& gen) : gen_(gen), pos_(kUniformBatch) {}
+
+  inline uint32_t next() {
+    if (pos_ == kUniformBatch) {
+      refill();
+    }
+    return bits_[pos_++];
+  }
+
+  inline const uint32_t* next8() {
+    if (pos_ + 8 > kUniformBatch) {
+      refill();
+    }
+    const uint32_t* words = bits_ + pos_;
+    pos_ += 8;
+    return words;
+  }
+
+  /**
+   * A uniform in (0, 1], safe to take the log of
+   */
+  inline double uniform() {
+    return (static_cast<double>(next()) + 1.0) * (1.0 / 4294967296.0);
+  }
+
+  /**
+   * The next n words, what is left in the buffer first and the rest
+   * straight from the engine
+   */
+  inline void take(uint32_t* dst, uint64_t n) {
+    uint64_t buffered = std::min<uint64_t>(n, kUniformBatch - pos_);
+    memcpy(dst, bits_ + pos_, buffered * sizeof(uint32_t));
+    pos_ += static_cast<int>(buffered);
+    random_bits(gen_, dst + buffered, n - buffered);
+  }
+
+private:
+  engine_t& gen_;
+  uint32_t bits_[kUniformBatch];
+  int pos_;
+
+  inline void refill() {
+    random_bits(gen_, bits_, kUniformBatch);
+    pos_ = 0;
+  }
+};
+
+template <typename engine_t>
+static inline void random_bits(word_buffer<engine_t>& words, uint32_t* dst, uint64_t n) {
+  words.take(dst, n);
+}
+
+/**
+ * Standard normal from word, drawing more words if it is rejected
+ */
+template <typename engine_t>
+static inline float ziggurat_normal_scalar(const ziggurat_tables& t, word_buffer<engine_t>& words, uint32_t word) {
+  const double r = ziggurat_tables::kNormalR;
+  for (;;) {
+    uint32_t layer = word & 127;
+    uint32_t u = word >> 8;
+    float sign = (word & 128) ? -1.0f : 1.0f;
+    float x = static_cast<float>(u) * t.wn[layer];
+    if (u < t.kn[layer]) {
+      return sign * x;
+    }
+    if (layer == 0) {
+      // tail beyond r
+      double tx, ty;
+      do {
+        tx = -std::log(words.uniform()) / r;
+        ty = -std::log(words.uniform());
+      } while (ty + ty < tx * tx);
+      return sign * static_cast<float>(r + tx);
+    }
+    if (t.fn[layer] + words.uniform() * (t.fn[layer - 1] - t.fn[layer]) < std::exp(-0.5 * x * x)) {
+      return sign * x;
+    }
+    word = words.next();
+  }
+}
+
+/**
+ * Standard exponential from word, drawing more words if it is rejected
+ */
+template <typename engine_t>
+static inline float ziggurat_exponential_scalar(const ziggurat_tables& t, word_buffer<engine_t>& words, uint32_t word) {
+  for (;;) {
+    uint32_t layer = word & 255;
+    uint32_t u = word >> 8;
+    float x = static_cast<float>(u) * t.we[layer];
+    if (u < t.ke[layer]) {
+      return x;
+    }
+    if (layer == 0) {
+      // the tail beyond r is r plus another exponential
+      return static_cast<float>(ziggurat_tables::kExponentialR - std::log(words.uniform()));
+    }
+    if (t.fe[layer] + words.uniform() * (t.fe[layer - 1] - t.fe[layer]) < std::exp(-static_cast<double>(x))) {
+      return x;
+    }
+    word = words.next();
+  }
+}
+
+/**
+ * Eight standard normals from the next eight words, the lanes that fail
+ * the fast test are redone by the scalar fallback
+ */
+template <typename engine_t>
+static inline __m256 ziggurat_normal8(const ziggurat_tables& t, word_buffer<engine_t>& words) {
+  __m256i word = _mm256_loadu_si256((const __m256i*)words.next8());
+  __m256i layer = _mm256_and_si256(word, _mm256_set1_epi32(127));
+  __m256i u = _mm256_srli_epi32(word, 8);
+  __m256i k = _mm256_i32gather_epi32((const int*)t.kn, layer, 4);
+  __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(u), _mm256_i32gather_ps(t.wn, layer, 4));
+  // bit 7 of the word becomes the sign bit
+  x = _mm256_xor_ps(x, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(word, _mm256_set1_epi32(128)), 24)));
+  // both are below 2^31, so the signed compare is fine
+  int rejected = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, u))) & 0xFF;
+  if (rejected) {
+    // the fallback may refill the buffer the words came from
+    uint32_t rejected_words[8];
+    float lanes[8];
+    _mm256_storeu_si256((__m256i*)rejected_words, word);
+    _mm256_storeu_ps(lanes, x);
+    while (rejected) {
+      int lane = __builtin_ctz(rejected);
+      rejected &= rejected - 1;
+      lanes[lane] = ziggurat_normal_scalar(t, words, rejected_words[lane]);
+    }
+    x = _mm256_loadu_ps(lanes);
+  }
+  return x;
+}
+
+/**
+ * Eight standard exponentials from the next eight words, the lanes that
+ * fail the fast test are redone by the scalar fallback
+ */
+template <typename engine_t>
+static inline __m256 ziggurat_exponential8(const ziggurat_tables& t, word_buffer<engine_t>& words) {
+  __m256i word = _mm256_loadu_si256((const __m256i*)words.next8());
+  __m256i layer = _mm256_and_si256(word, _mm256_set1_epi32(255));
+  __m256i u = _mm256_srli_epi32(word, 8);
+  __m256i k = _mm256_i32gather_epi32((const int*)t.ke, layer, 4);
+  __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(u), _mm256_i32gather_ps(t.we, layer, 4));
+  int rejected = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, u))) & 0xFF;
+  if (rejected) {
+    // the fallback may refill the buffer the words came from
+    uint32_t rejected_words[8];
+    float lanes[8];
+    _mm256_storeu_si256((__m256i*)rejected_words, word);
+    _mm256_storeu_ps(lanes, x);
+    while (rejected) {
+      int lane = __builtin_ctz(rejected);
+      rejected &= rejected - 1;
+      lanes[lane] = ziggurat_exponential_scalar(t, words, rejected_words[lane]);
+    }
+    x = _mm256_loadu_ps(lanes);
+  }
+  return x;
+}
+
+} // namespace detail
+
+/**
+ * Writes n normally distributed floats drawn through words, which keeps
+ * what it has left over for later calls, see Note [Ziggurat sampling]
+ */
+template <typename engine_t>
+static inline void ziggurat_normal(detail::word_buffer<engine_t>& words, float* dst, uint64_t n, float mean = 0.0f, float stddev = 1.0f) {
+  const detail::ziggurat_tables& t = detail::ziggurat();
+  const __m256 mean_v = _mm256_set1_ps(mean);
+  const __m256 stddev_v = _mm256_set1_ps(stddev);
+  uint64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(detail::ziggurat_normal8(t, words), stddev_v, mean_v));
+  }
+  for (; i < n; i++) {
+    dst[i] = mean + stddev * detail::ziggurat_normal_scalar(t, words, words.next());
+  }
+}
+
+/**
+ * Writes n normally distributed floats, see Note [Ziggurat sampling]
+ */
+template <typename engine_t>
+static inline void ziggurat_normal(engine_t& gen, float* dst, uint64_t n, float mean = 0.0f, float stddev = 1.0f) {
+  detail::word_buffer<engine_t> words(gen);
+  ziggurat_normal(words, dst, n, mean, stddev);
+}
+
+/**
+ * Writes n exponentially distributed floats with the given rate drawn
+ * through words, see Note [Ziggurat sampling]
+ */
+template <typename engine_t>
+static inline void ziggurat_exponential(detail::word_buffer<engine_t>& words, float* dst, uint64_t n, float lambda = 1.0f) {
+  const detail::ziggurat_tables& t = detail::ziggurat();
+  const float scale = 1.0f / lambda;
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  uint64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(detail::ziggurat_exponential8(t, words), scale_v));
+  }
+  for (; i < n; i++) {
+    dst[i] = scale * detail::ziggurat_exponential_scalar(t, words, words.next());
+  }
+}
+
+/**
+ * Writes n exponentially distributed floats with the given rate,
+ * see Note [Ziggurat sampling]
+ */
+template <typename engine_t>
+static inline void ziggurat_exponential(engine_t& gen, float* dst, uint64_t n, float lambda = 1.0f) {
+  detail::word_buffer<engine_t> words(gen);
+  ziggurat_exponential(words, dst, n, lambda);
+}
+
+} // namespace at
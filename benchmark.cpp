@@ -33,8 +33,15 @@ typedef std::vector<std::tuple<std::string, benchmark_function, y_data_t>> bench
 
 std::tuple<double, double, double, double> philox_global_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> philox_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_x2_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_x4_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> philox_simd_global_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> philox_simd_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_simd_x2_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_simd_x4_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_vec4_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_vec8_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_vec16_thread_local_instance(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> at_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
@@ -45,7 +52,285 @@ std::tuple<double, double, double, double> std_mt19937_chunking(std::string name
 std::tuple<double, double, double, double> xoshiro256_chunking(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> philox_global_instance_chunking(std::string name, uint64_t num_randoms, uint64_t num_threads);
 std::tuple<double, double, double, double> philox_simd_global_instance_chunking(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> sobol_16_float(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> sobol_1024_float(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> sobol_1024_double(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> rdrand_thread_local(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> seeding_rdseed(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> seeding_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> seeding_getrandom(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> seeding_random_device(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> seeding_splitmix64(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_cuda_layout(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> philox_cuda_layout_reference(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_float_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_float_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_float_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_float_std(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_double_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_double_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_double_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_float_box_muller(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_double_box_muller(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_normal_float_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_normal_float_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_normal_float_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_normal_float_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_normal_float_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_float_ziggurat_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_float_ziggurat_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_float_ziggurat_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> exponential_float_ziggurat_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> exponential_float_ziggurat_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_exponential_float_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_log_float_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_log_float_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_log_float_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_log_double_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_log_double_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_log_double_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_exp_float_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_exp_float_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_exp_float_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_exp_double_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_exp_double_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_exp_double_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_sincos_float_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_sincos_float_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sincos_float_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_sincos_double_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_sincos_double_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sincos_double_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_sqrt_float_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_sqrt_float_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sqrt_float_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> simd_math_sqrt_double_libm(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> simd_math_sqrt_double_avx2(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sqrt_double_avx512(std::string name, uint64_t num_randoms, uint64_t num_threads);
+#endif
+std::tuple<double, double, double, double> uniform_int_6_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_6_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_6_std_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_6_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_65536_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_65536_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_65536_std_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_65536_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_1e9_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_1e9_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_1e9_std_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_1e9_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_std_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_std_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bits_half_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bits_tenth_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bits_tenth_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bytes_half_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bytes_tenth_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_float_tenth_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bytes_tenth_naive_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_bytes_tenth_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow12_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow12_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow20_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow20_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow12_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow12_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow20_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow20_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow12_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow12_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow20_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow20_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow12_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow12_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow20_geometric(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow20_dense(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow20_geometric_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e3_alias_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e3_alias_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e3_binary_search_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e3_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e6_alias_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e6_alias_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e6_binary_search_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> weighted_1e6_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> randperm_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> shuffle_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_shuffle_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> std_shuffle_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_0_5_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_0_5_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_0_5_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_2_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_2_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_2_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_20_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_20_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> gamma_20_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_4_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_4_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_4_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_100_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_100_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_100_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_1e5_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_1e5_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> poisson_1e5_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> binomial_20_0_2_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> binomial_20_0_2_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> binomial_20_0_2_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> binomial_1000_0_4_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> binomial_1000_0_4_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> binomial_1000_0_4_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_2sigma_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_init_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_one_sided_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_tail_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_2sigma_rejection_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_2sigma_rejection_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_one_sided_rejection_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> truncated_normal_2sigma_seeded(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_half_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_half_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_bfloat16_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_bfloat16_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uniform_float32_bandwidth_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_half_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_half_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_bfloat16_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_bfloat16_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> normal_float32_bandwidth_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_bfloat16_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_bfloat16_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_half_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_half_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_int8_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_int8_two_pass_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> stochastic_round_half_seeded(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_scale_fused_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_scale_buffered_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_dropout_fused_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_dropout_buffered_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_add_noise_fused_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_add_noise_buffered_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_add_noise_fused_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> transform_add_noise_buffered_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> dropout_backward_recompute_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> dropout_backward_stored_bits(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> dropout_backward_stored_bytes(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> fill_bytes_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> fill_bytes_unaligned_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> fill_bytes_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> fill_bytes_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> fill_bytes_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uuid4_binary_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uuid4_hex_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> uuid4_hex_table_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_projection_tiled_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_projection_full_matrix_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_projection_generate_only_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_philox_vec8(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox_vec8(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_philox_vec8(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> european_option_global_philox_vec8(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_philox_vec8(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_philox_simd(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_philox(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_xoshiro256(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_pcg(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_std_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_at_mt19937(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_rdrand(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_philox_simd_streams(std::string name, uint64_t num_randoms, uint64_t num_threads);
+std::tuple<double, double, double, double> random_walk_global_philox_vec8(std::string name, uint64_t num_randoms, uint64_t num_threads);
 void check_philox_vs_simd();
+void check_philox_vs_simd_streams();
+void check_philox_simd_unrolled();
+void check_philox_unrolled();
+void check_philox_vs_vec();
+void check_sobol();
+void check_philox_cuda();
+void check_uniform();
+void check_normal();
+void check_ziggurat();
+void check_simd_math();
+void check_uniform_int();
+void check_bernoulli();
+void check_bernoulli_indices();
+void check_bernoulli_range();
+void check_alias_table();
+void check_shuffle();
+void check_distributions();
+void check_truncated_normal();
+void check_half();
+void check_stochastic_rounding();
+void check_generate_transform();
+void check_random_bytes();
+void check_uuid();
 
 void run_benchmark_suite(benchmarks_map_t& benchmarks, uint64_t num_randoms, uint64_t num_threads) {
     for (auto& x : benchmarks) {
@@ -65,6 +350,268 @@ int main(int argc, char **argv){
     tests_registry.emplace_back(std::make_tuple("pcg64", &at_pcg, y_data_t()));
     tests_registry.emplace_back(std::make_tuple("at::mt19937", &at_mt19937, y_data_t()));
     tests_registry.emplace_back(std::make_tuple("std::mt19937", &std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox (independent streams)", &philox_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox_simd_streams (independent streams)", &philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox_simd x2 unrolled (thread local)", &philox_simd_x2_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox_simd x4 unrolled (thread local)", &philox_simd_x4_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox x2 unrolled (thread local)", &philox_x2_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox x4 unrolled (thread local)", &philox_x4_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox_vec<4> (thread local)", &philox_vec4_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox_vec<8> (thread local)", &philox_vec8_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox_vec<16> (thread local)", &philox_vec16_thread_local_instance, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("sobol 16-dim float (thread local)", &sobol_16_float, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("sobol 1024-dim float (thread local)", &sobol_1024_float, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("sobol 1024-dim double (thread local)", &sobol_1024_double, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("rdrand (thread local)", &rdrand_thread_local, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("seeding: rdseed", &seeding_rdseed, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("seeding: rdrand", &seeding_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("seeding: getrandom", &seeding_getrandom, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("seeding: std::random_device", &seeding_random_device, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("seeding: splitmix64", &seeding_splitmix64, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox CUDA layout (philox_simd_streams)", &philox_cuda_layout, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("philox CUDA layout (scalar kernel loop)", &philox_cuda_layout_reference, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform float: philox_simd", &uniform_float_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform float: xoshiro256**", &uniform_float_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform float: pcg64", &uniform_float_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform float: std::uniform_real_distribution (std::mt19937)", &uniform_float_std, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform double: philox_simd", &uniform_double_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform double: xoshiro256**", &uniform_double_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform double: pcg64", &uniform_double_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: box-muller philox_simd", &normal_float_box_muller, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal double: box-muller philox_simd", &normal_double_box_muller, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: std::normal_distribution (philox_simd)", &std_normal_float_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: std::normal_distribution (philox)", &std_normal_float_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: std::normal_distribution (xoshiro256**)", &std_normal_float_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: std::normal_distribution (pcg64)", &std_normal_float_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: std::normal_distribution (std::mt19937)", &std_normal_float_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: ziggurat philox_simd", &normal_float_ziggurat_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: ziggurat xoshiro256**", &normal_float_ziggurat_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("normal float: ziggurat pcg64", &normal_float_ziggurat_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("exponential float: ziggurat philox_simd", &exponential_float_ziggurat_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("exponential float: ziggurat xoshiro256**", &exponential_float_ziggurat_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("exponential float: std::exponential_distribution (std::mt19937)", &std_exponential_float_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: log float (libm)", &simd_math_log_float_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: log float (AVX2)", &simd_math_log_float_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: log float (AVX-512)", &simd_math_log_float_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: log double (libm)", &simd_math_log_double_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: log double (AVX2)", &simd_math_log_double_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: log double (AVX-512)", &simd_math_log_double_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: exp float (libm)", &simd_math_exp_float_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: exp float (AVX2)", &simd_math_exp_float_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: exp float (AVX-512)", &simd_math_exp_float_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: exp double (libm)", &simd_math_exp_double_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: exp double (AVX2)", &simd_math_exp_double_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: exp double (AVX-512)", &simd_math_exp_double_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: sincos float (libm)", &simd_math_sincos_float_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: sincos float (AVX2)", &simd_math_sincos_float_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: sincos float (AVX-512)", &simd_math_sincos_float_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: sincos double (libm)", &simd_math_sincos_double_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: sincos double (AVX2)", &simd_math_sincos_double_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: sincos double (AVX-512)", &simd_math_sincos_double_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: sqrt float (libm)", &simd_math_sqrt_float_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: sqrt float (AVX2)", &simd_math_sqrt_float_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: sqrt float (AVX-512)", &simd_math_sqrt_float_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("simd math: sqrt double (libm)", &simd_math_sqrt_double_libm, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("simd math: sqrt double (AVX2)", &simd_math_sqrt_double_avx2, y_data_t()));
+#ifdef __AVX512F__
+    tests_registry.emplace_back(std::make_tuple("simd math: sqrt double (AVX-512)", &simd_math_sqrt_double_avx512, y_data_t()));
+#endif
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 6: philox_simd", &uniform_int_6_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 6: xoshiro256**", &uniform_int_6_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 6: std::uniform_int_distribution (philox_simd)", &uniform_int_6_std_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 6: std::uniform_int_distribution (std::mt19937)", &uniform_int_6_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^16: philox_simd", &uniform_int_65536_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^16: xoshiro256**", &uniform_int_65536_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^16: std::uniform_int_distribution (philox_simd)", &uniform_int_65536_std_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^16: std::uniform_int_distribution (std::mt19937)", &uniform_int_65536_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 10^9: philox_simd", &uniform_int_1e9_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 10^9: xoshiro256**", &uniform_int_1e9_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 10^9: std::uniform_int_distribution (philox_simd)", &uniform_int_1e9_std_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 10^9: std::uniform_int_distribution (std::mt19937)", &uniform_int_1e9_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^31 + 1: philox_simd", &uniform_int_2pow31_plus_1_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^31 + 1: xoshiro256**", &uniform_int_2pow31_plus_1_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^31 + 1: std::uniform_int_distribution (philox_simd)", &uniform_int_2pow31_plus_1_std_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^31 + 1: std::uniform_int_distribution (std::mt19937)", &uniform_int_2pow31_plus_1_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^32 - 1: philox_simd", &uniform_int_2pow32_minus_1_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^32 - 1: xoshiro256**", &uniform_int_2pow32_minus_1_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^32 - 1: std::uniform_int_distribution (philox_simd)", &uniform_int_2pow32_minus_1_std_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uniform int n = 2^32 - 1: std::uniform_int_distribution (std::mt19937)", &uniform_int_2pow32_minus_1_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bits p = 0.5: philox_simd", &bernoulli_bits_half_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bits p = 0.1: philox_simd", &bernoulli_bits_tenth_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bits p = 0.1: xoshiro256**", &bernoulli_bits_tenth_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bytes p = 0.5: philox_simd", &bernoulli_bytes_half_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bytes p = 0.1: philox_simd", &bernoulli_bytes_tenth_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli float p = 0.1: philox_simd", &bernoulli_float_tenth_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bytes p = 0.1: per-element compare (philox_simd)", &bernoulli_bytes_tenth_naive_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli bytes p = 0.1: std::bernoulli_distribution (std::mt19937)", &bernoulli_bytes_tenth_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.001, n = 2^12: geometric skip (philox_simd)", &bernoulli_indices_0_001_2pow12_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.001, n = 2^12: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_001_2pow12_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.001, n = 2^20: geometric skip (philox_simd)", &bernoulli_indices_0_001_2pow20_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.001, n = 2^20: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_001_2pow20_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.01, n = 2^12: geometric skip (philox_simd)", &bernoulli_indices_0_01_2pow12_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.01, n = 2^12: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_01_2pow12_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.01, n = 2^20: geometric skip (philox_simd)", &bernoulli_indices_0_01_2pow20_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.01, n = 2^20: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_01_2pow20_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.05, n = 2^12: geometric skip (philox_simd)", &bernoulli_indices_0_05_2pow12_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.05, n = 2^12: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_05_2pow12_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.05, n = 2^20: geometric skip (philox_simd)", &bernoulli_indices_0_05_2pow20_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.05, n = 2^20: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_05_2pow20_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.2, n = 2^12: geometric skip (philox_simd)", &bernoulli_indices_0_2_2pow12_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.2, n = 2^12: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_2_2pow12_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.2, n = 2^20: geometric skip (philox_simd)", &bernoulli_indices_0_2_2pow20_geometric, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.2, n = 2^20: packed bits + bit scan (philox_simd)", &bernoulli_indices_0_2_2pow20_dense, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bernoulli indices p = 0.01, n = 2^20: geometric skip (xoshiro256**)", &bernoulli_indices_0_01_2pow20_geometric_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^3: alias table (philox_simd)", &weighted_1e3_alias_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^3: alias table (xoshiro256**)", &weighted_1e3_alias_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^3: cumulative binary search (philox_simd)", &weighted_1e3_binary_search_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^3: std::discrete_distribution (std::mt19937)", &weighted_1e3_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^6: alias table (philox_simd)", &weighted_1e6_alias_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^6: alias table (xoshiro256**)", &weighted_1e6_alias_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^6: cumulative binary search (philox_simd)", &weighted_1e6_binary_search_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("weighted sample n = 10^6: std::discrete_distribution (std::mt19937)", &weighted_1e6_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("shuffle: randperm (philox_simd)", &randperm_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("shuffle: bucket shuffle (philox_simd)", &shuffle_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("shuffle: std::shuffle (philox_simd, single-threaded)", &std_shuffle_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("shuffle: std::shuffle (std::mt19937, single-threaded)", &std_shuffle_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 0.5: marsaglia-tsang philox_simd", &gamma_0_5_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 0.5: marsaglia-tsang xoshiro256**", &gamma_0_5_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 0.5: std::gamma_distribution (std::mt19937)", &gamma_0_5_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 2: marsaglia-tsang philox_simd", &gamma_2_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 2: marsaglia-tsang xoshiro256**", &gamma_2_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 2: std::gamma_distribution (std::mt19937)", &gamma_2_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 20: marsaglia-tsang philox_simd", &gamma_20_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 20: marsaglia-tsang xoshiro256**", &gamma_20_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("gamma alpha = 20: std::gamma_distribution (std::mt19937)", &gamma_20_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 4: inversion philox_simd", &poisson_4_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 4: inversion xoshiro256**", &poisson_4_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 4: std::poisson_distribution (std::mt19937)", &poisson_4_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 100: PTRS philox_simd", &poisson_100_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 100: PTRS xoshiro256**", &poisson_100_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 100: std::poisson_distribution (std::mt19937)", &poisson_100_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 10^5: PTRS philox_simd", &poisson_1e5_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 10^5: PTRS xoshiro256**", &poisson_1e5_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("poisson lambda = 10^5: std::poisson_distribution (std::mt19937)", &poisson_1e5_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("binomial n = 20, p = 0.2: inversion philox_simd", &binomial_20_0_2_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("binomial n = 20, p = 0.2: inversion xoshiro256**", &binomial_20_0_2_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("binomial n = 20, p = 0.2: std::binomial_distribution (std::mt19937)", &binomial_20_0_2_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("binomial n = 1000, p = 0.4: BTPE philox_simd", &binomial_1000_0_4_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("binomial n = 1000, p = 0.4: BTPE xoshiro256**", &binomial_1000_0_4_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("binomial n = 1000, p = 0.4: std::binomial_distribution (std::mt19937)", &binomial_1000_0_4_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, -2, 2): erfinv inversion philox_simd", &truncated_normal_2sigma_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 0.02, -0.04, 0.04): erfinv inversion philox_simd", &truncated_normal_init_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, 1, 3): erfc inversion philox_simd", &truncated_normal_one_sided_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, 3, inf): exponential rejection philox_simd", &truncated_normal_tail_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, -2, 2): std::normal_distribution rejection (philox_simd)", &truncated_normal_2sigma_rejection_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, -2, 2): std::normal_distribution rejection (std::mt19937)", &truncated_normal_2sigma_rejection_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, 1, 3): std::normal_distribution rejection (std::mt19937)", &truncated_normal_one_sided_rejection_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("truncated normal (0, 1, -2, 2): seeded, threads split by philox subsequence", &truncated_normal_2sigma_seeded, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fp16 uniform: from mantissa bits philox_simd", &uniform_half_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fp16 uniform: float32 then converted philox_simd", &uniform_half_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bfloat16 uniform: from mantissa bits philox_simd", &uniform_bfloat16_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bfloat16 uniform: float32 then converted philox_simd", &uniform_bfloat16_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("float32 uniform: philox_simd, for bandwidth", &uniform_float32_bandwidth_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fp16 normal: Box-Muller converted in registers philox_simd", &normal_half_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fp16 normal: float32 then converted philox_simd", &normal_half_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bfloat16 normal: Box-Muller converted in registers philox_simd", &normal_bfloat16_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("bfloat16 normal: float32 then converted philox_simd", &normal_bfloat16_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("float32 normal: Box-Muller philox_simd, for bandwidth", &normal_float32_bandwidth_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to bfloat16 philox_simd, fused", &stochastic_round_bfloat16_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to bfloat16 philox_simd, bits buffered first", &stochastic_round_bfloat16_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to fp16 philox_simd, fused", &stochastic_round_half_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to fp16 philox_simd, bits buffered first", &stochastic_round_half_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to int8 philox_simd, fused", &stochastic_round_int8_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to int8 philox_simd, bits buffered first", &stochastic_round_int8_two_pass_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("stochastic rounding: float to fp16, one seeded call on all threads", &stochastic_round_half_seeded, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: uniform [-1, 1) philox_simd, generate_transform", &transform_scale_fused_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: uniform [-1, 1) philox_simd, words buffered first", &transform_scale_buffered_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: dropout philox_simd, generate_transform", &transform_dropout_fused_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: dropout philox_simd, words buffered first", &transform_dropout_buffered_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: add noise philox_simd, generate_transform", &transform_add_noise_fused_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: add noise philox_simd, words buffered first", &transform_add_noise_buffered_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: add noise philox, generate_transform", &transform_add_noise_fused_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("fused transform: add noise philox, words buffered first", &transform_add_noise_buffered_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("dropout backward: mask made again from (seed, offset) philox_simd", &dropout_backward_recompute_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("dropout backward: stored bit mask read back", &dropout_backward_stored_bits, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("dropout backward: stored byte mask read back", &dropout_backward_stored_bytes, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random bytes: fill_bytes philox_simd", &fill_bytes_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random bytes: fill_bytes philox_simd, odd lengths and addresses", &fill_bytes_unaligned_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random bytes: fill_bytes philox", &fill_bytes_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random bytes: fill_bytes xoshiro256**", &fill_bytes_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random bytes: fill_bytes pcg", &fill_bytes_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uuid4: binary philox_simd", &uuid4_binary_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uuid4: hex philox_simd", &uuid4_hex_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("uuid4: hex formatted from a table philox_simd", &uuid4_hex_table_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random projection: Gaussian tiles multiplied while in cache philox_simd", &random_projection_tiled_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random projection: full Gaussian matrix made first philox_simd", &random_projection_full_matrix_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("random projection: Gaussian tiles only, no multiply philox_simd", &random_projection_generate_only_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox_simd (thread local)", &monte_carlo_pi_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox (thread local)", &monte_carlo_pi_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi xoshiro256 (thread local)", &monte_carlo_pi_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi pcg (thread local)", &monte_carlo_pi_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi std_mt19937 (thread local)", &monte_carlo_pi_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi at_mt19937 (thread local)", &monte_carlo_pi_at_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi rdrand (thread local)", &monte_carlo_pi_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox_simd_streams (thread local)", &monte_carlo_pi_philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox_vec<8> (thread local)", &monte_carlo_pi_philox_vec8, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox_simd (global)", &monte_carlo_pi_global_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox (global)", &monte_carlo_pi_global_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi xoshiro256 (global)", &monte_carlo_pi_global_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi pcg (global)", &monte_carlo_pi_global_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi std_mt19937 (global)", &monte_carlo_pi_global_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi at_mt19937 (global)", &monte_carlo_pi_global_at_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi rdrand (global)", &monte_carlo_pi_global_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox_simd_streams (global)", &monte_carlo_pi_global_philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: pi philox_vec<8> (global)", &monte_carlo_pi_global_philox_vec8, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox_simd (thread local)", &european_option_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox (thread local)", &european_option_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call xoshiro256 (thread local)", &european_option_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call pcg (thread local)", &european_option_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call std_mt19937 (thread local)", &european_option_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call at_mt19937 (thread local)", &european_option_at_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call rdrand (thread local)", &european_option_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox_simd_streams (thread local)", &european_option_philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox_vec<8> (thread local)", &european_option_philox_vec8, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox_simd (global)", &european_option_global_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox (global)", &european_option_global_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call xoshiro256 (global)", &european_option_global_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call pcg (global)", &european_option_global_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call std_mt19937 (global)", &european_option_global_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call at_mt19937 (global)", &european_option_global_at_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call rdrand (global)", &european_option_global_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox_simd_streams (global)", &european_option_global_philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: European call philox_vec<8> (global)", &european_option_global_philox_vec8, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox_simd (thread local)", &random_walk_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox (thread local)", &random_walk_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk xoshiro256 (thread local)", &random_walk_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk pcg (thread local)", &random_walk_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk std_mt19937 (thread local)", &random_walk_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk at_mt19937 (thread local)", &random_walk_at_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk rdrand (thread local)", &random_walk_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox_simd_streams (thread local)", &random_walk_philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox_vec<8> (thread local)", &random_walk_philox_vec8, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox_simd (global)", &random_walk_global_philox_simd, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox (global)", &random_walk_global_philox, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk xoshiro256 (global)", &random_walk_global_xoshiro256, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk pcg (global)", &random_walk_global_pcg, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk std_mt19937 (global)", &random_walk_global_std_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk at_mt19937 (global)", &random_walk_global_at_mt19937, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk rdrand (global)", &random_walk_global_rdrand, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox_simd_streams (global)", &random_walk_global_philox_simd_streams, y_data_t()));
+    tests_registry.emplace_back(std::make_tuple("Monte Carlo: random walk philox_vec<8> (global)", &random_walk_global_philox_vec8, y_data_t()));
     // tests_registry.emplace_back(std::make_tuple("at::mt19937 (chunking)", &at_mt19937_chunking, y_data_t()));
     // tests_registry.emplace_back(std::make_tuple("pcg64 (chunking)", &at_pcg_chunking, y_data_t()));
     // tests_registry.emplace_back(std::make_tuple("std::mt19937 (chunking)", &std_mt19937_chunking, y_data_t()));
@@ -227,4 +774,27 @@ int main(int argc, char **argv){
     std::cout << results_table_max.to_string() << std::endl;
 
     // check_philox_vs_simd();  // NOTE: must set UNSHUFFLE to 1 for generators to match exactly
+    // check_philox_vs_simd_streams();
+    // check_philox_simd_unrolled();
+    // check_philox_unrolled();
+    // check_philox_vs_vec();
+    // check_sobol();
+    // check_philox_cuda();
+    // check_uniform();
+    // check_normal();
+    // check_ziggurat();
+    // check_simd_math();
+    // check_uniform_int();
+    // check_bernoulli();
+    // check_bernoulli_indices();
+    // check_bernoulli_range();
+    // check_alias_table();
+    // check_shuffle();
+    // check_distributions();
+    // check_truncated_normal();
+    // check_half();
+    // check_stochastic_rounding();
+    // check_generate_transform();
+    // check_random_bytes();
+    // check_uuid();
 }
@@ -2,7 +2,25 @@
 #include "MT19937.h"
 #include "xoshiro256starstar.h"
 #include "PhiloxSIMD.h"
+#include "PhiloxSIMDStreams.h"
+#include "PhiloxVec.h"
 #include "PCG.h"
+#include "Sobol.h"
+#include "RDRAND.h"
+#include "PhiloxCUDA.h"
+#include "Uniform.h"
+#include "Normal.h"
+#include "SIMDMath.h"
+#include "Ziggurat.h"
+#include "UniformInt.h"
+#include "Bernoulli.h"
+#include "AliasTable.h"
+#include "Shuffle.h"
+#include "Distributions.h"
+#include "TruncatedNormal.h"
+#include "Half.h"
+#include "StochasticRounding.h"
+#include "UUID.h"
 #include <iostream>
 #include <random>
 #include <chrono>
@@ -13,9 +31,21 @@
 #include <vector>
 #include <string>
 #include <cstring>
+#include <memory>
+#include <cfloat>
+#include <cmath>
 
 constexpr int TRIALS = 3;
-constexpr float POW_2_32_INV = 1.0f / std::numeric_limits<uint32_t>::max();
+// number of 32-bit randoms drawn from each independent stream in the streams benchmarks
+constexpr uint64_t STREAM_DRAWS = 16;
+// number of points written per generate call in the Sobol benchmarks
+constexpr uint64_t SOBOL_BATCH_POINTS = 64;
+// the seeding benchmarks seed one generator for every RANDOMS_PER_SEED randoms
+constexpr uint64_t RANDOMS_PER_SEED = 1024;
+// number of reals written per fill call in the uniform benchmarks
+constexpr uint64_t UNIFORM_BUFFER = 4096;
+// number of inputs each math function is applied to per pass in the SIMD math benchmarks
+constexpr uint64_t MATH_BUFFER = 4096;
 
 typedef std::chrono::time_point<std::chrono::high_resolution_clock> hres_t;
 typedef std::pair<hres_t, hres_t> time_pair_t;
@@ -120,391 +150,6015 @@ void check_philox_vs_simd()
     }
 }
 
-std::tuple<double, double, double, double> philox_global_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+void check_philox_vs_simd_streams()
 {
-    std::vector<uint32_t> y(num_threads, 0);
-    at::philox_engine gen1(0, 0, 0);
-    std::mutex mutex;
-    uint64_t step = 128 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t local = 0;
-        at::detail::Array<uint32_t, 4> z;
-        std::lock_guard<std::mutex> lock(mutex);
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+    uint64_t seeds[8], subsequences[8], offsets[8];
+    for (int i = 0; i < 8; i++)
+    {
+        seeds[i] = 0x9E3779B97F4A7C15ULL * (i + 1);
+        subsequences[i] = i * 3;
+        // lane 7 starts right below a 64-bit wrap to exercise the carry into the subsequence
+        offsets[i] = i == 7 ? 0xFFFFFFFFFFFFFFF0ULL : i * 1000;
+    }
+    at::philox_simd_streams_engine streams(seeds, subsequences, offsets);
+    std::vector<at::philox_engine> philox;
+    for (int i = 0; i < 8; i++)
+    {
+        philox.emplace_back(seeds[i], subsequences[i], offsets[i]);
+    }
+    bool ok = true;
+    for (int block = 0; block < 100 && ok; block++)
+    {
+        __m256i out[4];
+        uint32_t actual[4][8];
+        streams.next32(out[0], out[1], out[2], out[3]);
+        for (int j = 0; j < 4; j++)
         {
-            z = gen1.next();
+            _mm256_storeu_si256((__m256i *)actual[j], out[j]);
+        }
+        for (int i = 0; i < 8 && ok; i++)
+        {
+            at::detail::Array<uint32_t, 4> expected = philox[i].next();
+            for (int j = 0; j < 4; j++)
+            {
+                if (expected[j] != actual[j][i])
+                {
+                    printf("philox differs from philox_simd_streams at block %d lane %d word %d (%08x vs %08x)\n", block, i, j, expected[j], actual[j][i]);
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+    if (ok)
+    {
+        printf("OK\n");
+    }
+}
 
-            local += z[0];
-            local += z[1];
-            local += z[2];
-            local += z[3];
+template <int N>
+static bool check_philox_simd_unrolled(uint64_t offset)
+{
+    at::philox_simd_engine single(0, 0, offset);
+    at::philox_simd_engine unrolled(0, 0, offset);
+    for (int call = 0; call < 64; call++)
+    {
+        __m256i out[N][4];
+        uint32_t expected[8];
+        uint32_t actual[8];
+        unrolled.next32_unrolled<N>(out);
+        for (int u = 0; u < N; u++)
+        {
+            __m256i a[4];
+            single.next32(a[0], a[1], a[2], a[3]);
+            for (int j = 0; j < 4; j++)
+            {
+                _mm256_storeu_si256((__m256i *)expected, a[j]);
+                _mm256_storeu_si256((__m256i *)actual, out[u][j]);
+                if (memcmp(expected, actual, sizeof(expected)) != 0)
+                {
+                    printf("next32_unrolled<%d> differs from next32 at call %d block %d word %d\n", N, call, u, j);
+                    return false;
+                }
+            }
         }
+    }
+    return true;
+}
 
-        y[thread_idx] = local;
-    },
-                           num_threads);
-    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+void check_philox_simd_unrolled()
+{
+    // the second offset makes the low counter word wrap inside the checked range
+    if (check_philox_simd_unrolled<2>(0) && check_philox_simd_unrolled<4>(0) &&
+        check_philox_simd_unrolled<2>(0xFFFFFF00ULL) && check_philox_simd_unrolled<4>(0xFFFFFF00ULL))
+    {
+        printf("OK\n");
+    }
 }
 
-std::tuple<double, double, double, double> philox_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+template <int N>
+static bool check_philox_unrolled(uint64_t offset)
 {
-    std::vector<uint32_t> y(num_threads, 0);
-    uint64_t step = 128 / 32;
-    std::vector<at::philox_engine> engines;
-    for (uint64_t i = 0; i < num_threads; ++i) {
-        engines.emplace_back(0, i, 0);
+    at::philox_engine single(0, 0, offset);
+    at::philox_engine unrolled(0, 0, offset);
+    for (int call = 0; call < 64; call++)
+    {
+        at::detail::Array<uint32_t, 4> out[N];
+        unrolled.next_unrolled<N>(out);
+        for (int u = 0; u < N; u++)
+        {
+            at::detail::Array<uint32_t, 4> expected = single.next();
+            for (int j = 0; j < 4; j++)
+            {
+                if (expected[j] != out[u][j])
+                {
+                    printf("next_unrolled<%d> differs from next at call %d block %d word %d\n", N, call, u, j);
+                    return false;
+                }
+            }
+        }
     }
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t local = 0;
-        at::detail::Array<uint32_t, 4> z;
-        auto &gen1 = engines[thread_idx];
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+    return true;
+}
+
+void check_philox_unrolled()
+{
+    if (check_philox_unrolled<2>(0) && check_philox_unrolled<4>(0) &&
+        check_philox_unrolled<2>(0xFFFFFFFFFFFFFFC0ULL) && check_philox_unrolled<4>(0xFFFFFFFFFFFFFFC0ULL))
+    {
+        printf("OK\n");
+    }
+}
+
+template <int LANES>
+static bool check_philox_vs_vec()
+{
+    at::philox_engine philox(0, 0, 0xFFFFFFF0ULL);
+    at::philox_vec_engine<LANES> philox_vec(0, 0, 0xFFFFFFF0ULL);
+    for (int call = 0; call < 64; call++)
+    {
+        typename at::philox_vec_engine<LANES>::vec_t out[4];
+        philox_vec.next32(out[0], out[1], out[2], out[3]);
+        for (int i = 0; i < LANES; i++)
         {
-            z = gen1.next();
-            local += z[0];
-            local += z[1];
-            local += z[2];
-            local += z[3];
+            at::detail::Array<uint32_t, 4> expected = philox.next();
+            for (int j = 0; j < 4; j++)
+            {
+                if (expected[j] != out[j][i])
+                {
+                    printf("philox differs from philox_vec<%d> at call %d lane %d word %d (%08x vs %08x)\n", LANES, call, i, j, expected[j], out[j][i]);
+                    return false;
+                }
+            }
         }
-        y[thread_idx] = local;
-    },
-                           num_threads);
-    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    }
+    return true;
 }
 
-std::tuple<double, double, double, double> philox_simd_global_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+void check_philox_vs_vec()
 {
-    at::philox_simd_engine gen(0, 0, 0);
-    std::mutex mutex;
-    uint64_t step = 1024 / 32;
+    // the offset makes the low counter word wrap inside the checked range
+    if (check_philox_vs_vec<4>() && check_philox_vs_vec<8>() && check_philox_vs_vec<16>())
+    {
+        printf("OK\n");
+    }
+}
 
-    __m256i y[num_threads];
-    memset(y, 0, sizeof(y[0]) * num_threads);
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        __m256i a, b, c, d;
-        __m256i v = _mm256_set1_epi32(0);
-        std::lock_guard<std::mutex> lock(mutex);
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+void check_sobol()
+{
+    // the first 2^k points must hit every dyadic interval of width 2^-k once in
+    // every dimension, and skipping must land on the same point as stepping
+    const uint32_t dims = at::sobol_engine::kMaxDimensions;
+    const int log_points = 12;
+    at::sobol_engine gen(dims);
+    std::vector<uint32_t> points((1 << log_points) * dims);
+    for (int n = 0; n < (1 << log_points); n++)
+    {
+        gen.next(&points[n * dims]);
+    }
+    for (int k = 1; k <= log_points; k++)
+    {
+        for (uint32_t d = 0; d < dims; d++)
         {
-            gen.next32(a, b, c, d);
-            v = _mm256_add_epi32(v, a);
-            v = _mm256_add_epi32(v, b);
-            v = _mm256_add_epi32(v, c);
-            v = _mm256_add_epi32(v, d);
+            std::vector<bool> seen(1 << k, false);
+            for (int n = 0; n < (1 << k); n++)
+            {
+                uint32_t cell = points[n * dims + d] >> (32 - k);
+                if (seen[cell])
+                {
+                    printf("sobol dimension %u is not stratified over the first %d points\n", d, 1 << k);
+                    return;
+                }
+                seen[cell] = true;
+            }
         }
-        y[thread_idx] = v;
-    },
-                           num_threads);
+    }
+    std::vector<uint32_t> skipped(dims);
+    for (int n = 0; n < (1 << log_points); n += 97)
+    {
+        at::sobol_engine skip(dims, n);
+        skip.next(skipped.data());
+        if (memcmp(skipped.data(), &points[n * dims], dims * sizeof(uint32_t)) != 0)
+        {
+            printf("sobol skip_to(%d) differs from stepping\n", n);
+            return;
+        }
+    }
+    // the last point, 2^32 - 1, can be written and only the one after it throws
+    const uint64_t last = (1ULL << 32) - 1;
+    at::sobol_engine before(dims, last - 1), at_last(dims, last);
+    std::vector<uint32_t> stepped(dims);
+    std::vector<float> f(dims);
+    std::vector<double> d(dims);
+    before.next(stepped.data());
+    before.next(stepped.data());
+    at_last.next(skipped.data());
+    if (stepped != skipped)
+    {
+        printf("sobol point 2^32 - 1 differs between stepping and skip_to\n");
+        return;
+    }
+    for (int kind = 0; kind < 3; kind++)
+    {
+        at::sobol_engine end(dims, last);
+        try
+        {
+            kind == 0 ? end.next(stepped.data()) : kind == 1 ? end.next_float(f.data()) : end.next_double(d.data());
+        }
+        catch (const std::runtime_error &)
+        {
+            printf("sobol throws on point 2^32 - 1\n");
+            return;
+        }
+        try
+        {
+            kind == 0 ? end.next(stepped.data()) : kind == 1 ? end.next_float(f.data()) : end.next_double(d.data());
+            printf("sobol writes a point past 2^32 - 1\n");
+            return;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+    }
+    printf("OK\n");
+}
 
-    uint32_t x = 0;
-    uint32_t values[8];
-    for (uint64_t j = 0; j < num_threads; ++j)
+/**
+ * The CUDA kernel's grid-stride loop run literally, one thread at a time,
+ * see Note [Reproducing CUDA Philox draws on the host]
+ */
+static void philox_cuda_fill_reference(uint32_t *dst, uint64_t numel, uint64_t seed, uint64_t offset,
+                                       const at::philox_cuda_launch &launch, uint64_t first_thread, uint64_t last_thread)
+{
+    uint64_t stride = launch.threads();
+    uint64_t rounded_numel = at::philox_cuda_offset_increment(numel, launch) * stride * at::kCudaUnroll;
+    for (uint64_t idx = first_thread; idx < last_thread; idx++)
     {
-        _mm256_storeu_si256((__m256i *)values, y[j]);
-        for (int i = 0; i < 8; i++)
+        at::philox_engine gen(seed, idx, offset);
+        for (uint64_t linear = idx; linear < rounded_numel; linear += stride * at::kCudaUnroll)
         {
-            x += values[i];
+            at::detail::Array<uint32_t, 4> rand = gen.next();
+            for (int ii = 0; ii < at::kCudaUnroll; ii++)
+            {
+                if (linear + ii * stride < numel)
+                {
+                    dst[linear + ii * stride] = rand[ii];
+                }
+            }
+        }
+    }
+}
+
+void check_philox_cuda()
+{
+    // Philox4x32-10 known answers from Random123 (kat_vectors), with
+    // key = seed, counter words 3:2 = subsequence and 1:0 = offset
+    const uint64_t kat_input[3][3] = {
+        {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL},
+        {0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL},
+        {0x299f31d0a4093822ULL, 0x0370734413198a2eULL, 0x85a308d3243f6a88ULL}};
+    const uint32_t kat_output[3][4] = {
+        {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+        {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+        {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+    for (int k = 0; k < 3; k++)
+    {
+        at::philox_engine scalar(kat_input[k][0], kat_input[k][1], kat_input[k][2]);
+        at::philox_simd_streams_engine streams(kat_input[k][0]);
+        streams.set_stream(0, kat_input[k][0], kat_input[k][1], kat_input[k][2]);
+        __m256i out[4];
+        streams.next32(out[0], out[1], out[2], out[3]);
+        at::detail::Array<uint32_t, 4> expected = scalar.next();
+        for (int j = 0; j < 4; j++)
+        {
+            uint32_t lane0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(out[j]));
+            if (expected[j] != kat_output[k][j] || lane0 != kat_output[k][j])
+            {
+                printf("philox known answer %d word %d: expected %08x, philox %08x, philox_simd_streams %08x\n",
+                       k, j, kat_output[k][j], expected[j], lane0);
+                return;
+            }
+        }
+    }
+
+    // thread 0 of a launch with seed 0 and offset 0 owns elements 0, stride, 2 * stride and 3 * stride
+    at::philox_cuda_launch launch = {4, 32};
+    std::vector<uint32_t> actual(4 * launch.threads());
+    at::philox_cuda_fill(actual.data(), actual.size(), 0, 0, launch);
+    for (int j = 0; j < 4; j++)
+    {
+        if (actual[j * launch.threads()] != kat_output[0][j])
+        {
+            printf("philox_cuda_fill puts word %d of thread 0 in the wrong place\n", j);
+            return;
+        }
+    }
+
+    // odd grid shapes, element counts that end mid-row and offsets that carry
+    const at::philox_cuda_launch launches[4] = {{1, 1}, {3, 37}, {5, 128}, {2, 256}};
+    const uint64_t numels[4] = {1, 1000, 4 * 640 + 13, 100003};
+    const uint64_t offsets[3] = {0, 12345, 0xFFFFFFFFFFFFFFFEULL};
+    for (auto const &l : launches)
+    {
+        for (uint64_t numel : numels)
+        {
+            for (uint64_t offset : offsets)
+            {
+                std::vector<uint32_t> expected(numel, 0);
+                std::vector<uint32_t> filled(numel, 0);
+                philox_cuda_fill_reference(expected.data(), numel, 42, offset, l, 0, l.threads());
+                uint64_t increment = at::philox_cuda_fill(filled.data(), numel, 42, offset, l);
+                // the same elements again, with the thread range split unevenly
+                std::vector<uint32_t> split(numel, 0);
+                uint64_t middle = l.threads() / 3;
+                at::philox_cuda_fill(split.data(), numel, 42, offset, l, middle, l.threads());
+                at::philox_cuda_fill(split.data(), numel, 42, offset, l, 0, middle);
+                if (filled != expected || split != expected)
+                {
+                    printf("philox_cuda_fill differs from the kernel loop for grid %u x %u, numel %lu, offset %lx\n",
+                           l.grid_dim, l.block_dim, numel, offset);
+                    return;
+                }
+                if (increment * l.threads() * at::kCudaUnroll < numel ||
+                    (increment - 1) * l.threads() * at::kCudaUnroll >= numel)
+                {
+                    printf("philox_cuda_offset_increment is %lu for grid %u x %u and numel %lu\n",
+                           increment, l.grid_dim, l.block_dim, numel);
+                    return;
+                }
+            }
+        }
+    }
+    printf("OK\n");
+}
+
+template <typename real_t>
+static bool check_uniform_interval(const std::vector<real_t> &x, real_t lo, real_t hi, bool open_closed)
+{
+    double sum = 0;
+    for (real_t v : x)
+    {
+        if (open_closed ? (v <= lo || v > hi) : (v < lo || v >= hi))
+        {
+            return false;
+        }
+        sum += v;
+    }
+    // loose bound on the mean, a broken conversion is far off
+    return std::abs(sum / x.size() - (lo + hi) / 2.0) < 0.05 * (hi - lo);
+}
+
+void check_uniform()
+{
+    // every bit pattern the conversion distinguishes lands on its exact multiple of 2^-24 (2^-53)
+    const uint64_t n = 37;
+    std::vector<uint32_t> bits(2 * n);
+    for (uint64_t i = 0; i < bits.size(); i++)
+    {
+        bits[i] = i < 4 ? (i & 1 ? 0xFFFFFFFFU : 0U) : static_cast<uint32_t>(0x9E3779B97F4A7C15ULL * i >> 17);
+    }
+    std::vector<float> floats(n);
+    std::vector<double> doubles(n);
+    at::detail::uniform_params<float> float_params(0.0f, 1.0f, at::uniform_interval::closed_open);
+    at::detail::uniform_params<double> double_params(0.0, 1.0, at::uniform_interval::closed_open);
+    at::detail::uniform_float_kernel<false>(bits.data(), floats.data(), n, float_params);
+    at::detail::uniform_double_kernel<false>(bits.data(), doubles.data(), n, double_params);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint64_t word = (static_cast<uint64_t>(bits[2 * i + 1]) << 32) | bits[2 * i];
+        if (floats[i] != std::ldexp(static_cast<float>(bits[i] >> 8), -24) ||
+            doubles[i] != std::ldexp(static_cast<double>(word >> 11), -53))
+        {
+            printf("uniform conversion of word %lu is off (%a, %a)\n", i, floats[i], doubles[i]);
+            return;
+        }
+    }
+    at::detail::uniform_params<float> open_params(0.0f, 1.0f, at::uniform_interval::open_closed);
+    at::detail::uniform_float_kernel<true>(bits.data(), floats.data(), 2, open_params);
+    if (floats[0] != 1.0f || floats[1] != std::ldexp(1.0f, -24))
+    {
+        printf("uniform (0, 1] doesn't reach 1 or reaches 0\n");
+        return;
+    }
+
+    // the philox_simd register path matches converting its operator() output
+    const uint64_t count = 1000 + 7;
+    for (int open = 0; open < 2; open++)
+    {
+        at::uniform_interval interval = open ? at::uniform_interval::open_closed : at::uniform_interval::closed_open;
+        at::philox_simd_engine direct(7, 3, 0);
+        at::philox_simd_engine stepped(7, 3, 0);
+        std::vector<float> actual_f(count), expected_f(count);
+        at::uniform_float(direct, actual_f.data(), count, -3.0f, 5.0f, interval);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint32_t word = stepped();
+            expected_f[i] = open ? at::detail::uniform_float_scalar<true>(word, at::detail::uniform_params<float>(-3.0f, 5.0f, interval))
+                                 : at::detail::uniform_float_scalar<false>(word, at::detail::uniform_params<float>(-3.0f, 5.0f, interval));
+        }
+        at::philox_simd_engine direct_d(7, 3, 0);
+        at::philox_simd_engine stepped_d(7, 3, 0);
+        std::vector<double> actual_d(count), expected_d(count);
+        at::uniform_double(direct_d, actual_d.data(), count, -3.0, 5.0, interval);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t word = stepped_d();
+            word |= static_cast<uint64_t>(stepped_d()) << 32;
+            expected_d[i] = open ? at::detail::uniform_double_scalar<true>(word, at::detail::uniform_params<double>(-3.0, 5.0, interval))
+                                 : at::detail::uniform_double_scalar<false>(word, at::detail::uniform_params<double>(-3.0, 5.0, interval));
+        }
+        if (actual_f != expected_f || actual_d != expected_d)
+        {
+            printf("uniform on philox_simd differs from converting its operator() output\n");
+            return;
+        }
+        if (!check_uniform_interval(actual_f, -3.0f, 5.0f, open) || !check_uniform_interval(actual_d, -3.0, 5.0, open))
+        {
+            printf("uniform on philox_simd falls outside its interval\n");
+            return;
+        }
+    }
+
+    xoshiro256starstar_engine xoshiro(0);
+    at::pcg_engine pcg;
+    std::vector<float> xf(count), pf(count);
+    std::vector<double> xd(count), pd(count);
+    at::uniform_float(xoshiro, xf.data(), count, 0.0f, 1.0f, at::uniform_interval::open_closed);
+    at::uniform_double(xoshiro, xd.data(), count, 10.0, 11.0);
+    at::uniform_float(pcg, pf.data(), count);
+    at::uniform_double(pcg, pd.data(), count, -1.0, 1.0, at::uniform_interval::open_closed);
+    if (!check_uniform_interval(xf, 0.0f, 1.0f, true) || !check_uniform_interval(xd, 10.0, 11.0, false) ||
+        !check_uniform_interval(pf, 0.0f, 1.0f, false) || !check_uniform_interval(pd, -1.0, 1.0, true))
+    {
+        printf("uniform on xoshiro256** or pcg falls outside its interval\n");
+        return;
+    }
+    printf("OK\n");
+}
+
+/**
+ * Distance in units in the last place between a result and the correctly
+ * rounded value, with the reference computed in higher precision
+ */
+static double ulp_error(float actual, double expected)
+{
+    float rounded = static_cast<float>(expected);
+    return std::abs(actual - expected) / (std::nextafter(std::abs(rounded), INFINITY) - std::abs(rounded));
+}
+
+static double ulp_error(double actual, long double expected)
+{
+    double rounded = static_cast<double>(expected);
+    return static_cast<double>(std::abs(actual - expected) / (std::nextafter(std::abs(rounded), INFINITY) - std::abs(rounded)));
+}
+
+/**
+ * Element-wise functors over at::simd for the math checks and benchmarks.
+ * Vector arguments go to at::simd and scalar ones to libm, which in long
+ * double is also the reference for the double versions.
+ */
+struct math_log
+{
+    template <typename vec_t>
+    vec_t operator()(vec_t x) const { return at::simd::log(x); }
+    float operator()(float x) const { return std::log(x); }
+    double operator()(double x) const { return std::log(x); }
+    long double operator()(long double x) const { return std::log(x); }
+};
+
+struct math_exp
+{
+    template <typename vec_t>
+    vec_t operator()(vec_t x) const { return at::simd::exp(x); }
+    float operator()(float x) const { return std::exp(x); }
+    double operator()(double x) const { return std::exp(x); }
+    long double operator()(long double x) const { return std::exp(x); }
+};
+
+struct math_sqrt
+{
+    template <typename vec_t>
+    vec_t operator()(vec_t x) const { return at::simd::sqrt(x); }
+    float operator()(float x) const { return std::sqrt(x); }
+    double operator()(double x) const { return std::sqrt(x); }
+    long double operator()(long double x) const { return std::sqrt(x); }
+};
+
+static inline __m256 math_add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+static inline __m256d math_add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+#ifdef __AVX512F__
+static inline __m512 math_add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+static inline __m512d math_add(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+#endif
+
+/**
+ * OUTPUT 0 is sin, 1 is cos and 2 is sin + cos, which is what the
+ * benchmarks time so that both results are used
+ */
+template <int OUTPUT, bool TURNS = false>
+struct math_sincos
+{
+    template <typename vec_t>
+    vec_t operator()(vec_t x) const
+    {
+        vec_t s, c;
+        if (TURNS)
+        {
+            at::simd::sincos_2pi(x, s, c);
+        }
+        else
+        {
+            at::simd::sincos(x, s, c);
+        }
+        return OUTPUT == 0 ? s : OUTPUT == 1 ? c : math_add(s, c);
+    }
+
+    template <typename real_t>
+    real_t scalar(real_t x) const
+    {
+        real_t angle = TURNS ? 2 * static_cast<real_t>(3.141592653589793238462643383279502884L) * x : x;
+        return OUTPUT == 0 ? std::sin(angle) : OUTPUT == 1 ? std::cos(angle) : std::sin(angle) + std::cos(angle);
+    }
+    float operator()(float x) const { return scalar(x); }
+    double operator()(double x) const { return scalar(x); }
+    long double operator()(long double x) const { return scalar(x); }
+};
+
+enum class math_isa
+{
+    libm,
+    avx2,
+    avx512,
+};
+
+/**
+ * y[i] = fn(x[i]) for i < n, n a multiple of 16. avx512 only builds with
+ * AVX-512, and its benchmarks are only registered then.
+ */
+template <math_isa ISA, typename fn_t>
+static void math_map(const fn_t &fn, const float *x, float *y, uint64_t n)
+{
+#ifndef __AVX512F__
+    static_assert(ISA != math_isa::avx512, "math_isa::avx512 needs a build with AVX-512");
+#endif
+    if (ISA == math_isa::libm)
+    {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            y[i] = fn(x[i]);
+        }
+        return;
+    }
+#ifdef __AVX512F__
+    if (ISA == math_isa::avx512)
+    {
+        for (uint64_t i = 0; i < n; i += 16)
+        {
+            _mm512_storeu_ps(y + i, fn(_mm512_loadu_ps(x + i)));
+        }
+        return;
+    }
+#endif
+    for (uint64_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(y + i, fn(_mm256_loadu_ps(x + i)));
+    }
+}
+
+template <math_isa ISA, typename fn_t>
+static void math_map(const fn_t &fn, const double *x, double *y, uint64_t n)
+{
+#ifndef __AVX512F__
+    static_assert(ISA != math_isa::avx512, "math_isa::avx512 needs a build with AVX-512");
+#endif
+    if (ISA == math_isa::libm)
+    {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            y[i] = fn(x[i]);
         }
+        return;
     }
+#ifdef __AVX512F__
+    if (ISA == math_isa::avx512)
+    {
+        for (uint64_t i = 0; i < n; i += 8)
+        {
+            _mm512_storeu_pd(y + i, fn(_mm512_loadu_pd(x + i)));
+        }
+        return;
+    }
+#endif
+    for (uint64_t i = 0; i < n; i += 4)
+    {
+        _mm256_storeu_pd(y + i, fn(_mm256_loadu_pd(x + i)));
+    }
+}
+
+/**
+ * Worst error in ulp of fn over the inputs x against the reference ref,
+ * evaluated in double for float and in long double for double
+ */
+template <math_isa ISA, typename fn_t, typename ref_t>
+static double math_worst_ulp(const fn_t &fn, const ref_t &ref, const std::vector<float> &x)
+{
+    std::vector<float> y(x.size());
+    math_map<ISA>(fn, x.data(), y.data(), x.size());
+    double worst = 0;
+    for (uint64_t i = 0; i < x.size(); i++)
+    {
+        double error = ulp_error(y[i], ref(static_cast<double>(x[i])));
+        worst = std::isnan(error) ? INFINITY : std::max(worst, error);
+    }
+    return worst;
+}
+
+template <math_isa ISA, typename fn_t, typename ref_t>
+static double math_worst_ulp(const fn_t &fn, const ref_t &ref, const std::vector<double> &x)
+{
+    std::vector<double> y(x.size());
+    math_map<ISA>(fn, x.data(), y.data(), x.size());
+    double worst = 0;
+    for (uint64_t i = 0; i < x.size(); i++)
+    {
+        double error = ulp_error(y[i], ref(static_cast<long double>(x[i])));
+        worst = std::isnan(error) ? INFINITY : std::max(worst, error);
+    }
+    return worst;
+}
+
+/**
+ * n inputs spaced evenly over [lo, hi], or geometrically if geometric is set
+ */
+template <typename real_t>
+static std::vector<real_t> math_sweep(double lo, double hi, uint64_t n, bool geometric = false)
+{
+    std::vector<real_t> x(n);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        double t = static_cast<double>(i) / (n - 1);
+        // hi / lo can overflow, so the geometric spacing goes through logs
+        x[i] = static_cast<real_t>(geometric ? std::exp(std::log(lo) + (std::log(hi) - std::log(lo)) * t) : lo + (hi - lo) * t);
+    }
+    return x;
+}
+
+void check_normal()
+{
+    // simd::log over a log-spaced sweep including denormals, and its special values
+    double worst_float = 0, worst_double = 0;
+    for (double x = 1e-40; x < 1e30; x *= 1.0001)
+    {
+        float xf[8];
+        double xd[4];
+        for (int i = 0; i < 8; i++)
+        {
+            xf[i] = static_cast<float>(x * (1.0 + i * 1e-5));
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            xd[i] = x * (1.0 + i * 1e-5) * 1e-280;
+        }
+        float lf[8];
+        double ld[4];
+        _mm256_storeu_ps(lf, at::simd::log(_mm256_loadu_ps(xf)));
+        _mm256_storeu_pd(ld, at::simd::log(_mm256_loadu_pd(xd)));
+        for (int i = 0; i < 8; i++)
+        {
+            worst_float = std::max(worst_float, ulp_error(lf[i], std::log(static_cast<double>(xf[i]))));
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            worst_double = std::max(worst_double, ulp_error(ld[i], std::log(static_cast<long double>(xd[i]))));
+        }
+    }
+    float special[8] = {0.0f, -0.0f, -1.0f, INFINITY, NAN, 1.0f, 1e-45f, 2.0f};
+    float ls[8];
+    _mm256_storeu_ps(ls, at::simd::log(_mm256_loadu_ps(special)));
+    for (int i = 0; i < 8; i++)
+    {
+        float expected = std::log(special[i]);
+        bool same = ls[i] == expected || (std::isnan(ls[i]) && std::isnan(expected));
+        if (!same && !(std::isfinite(expected) && ulp_error(ls[i], std::log(static_cast<double>(special[i]))) <= 2))
+        {
+            printf("simd::log(%g) is %g instead of %g\n", special[i], ls[i], expected);
+            return;
+        }
+    }
+    if (worst_float > 2 || worst_double > 2)
+    {
+        printf("simd::log is off by %g ulp (float) and %g ulp (double)\n", worst_float, worst_double);
+        return;
+    }
+
+    // simd::sincos_2pi against libm, in absolute terms since sin and cos cross zero
+    double worst_sincos_float = 0, worst_sincos_double = 0;
+    for (int k = 0; k < (1 << 20); k += 8)
+    {
+        float tf[8];
+        double td[4];
+        for (int i = 0; i < 8; i++)
+        {
+            tf[i] = std::ldexp(static_cast<float>(k + i), -20) * 3.0f - 1.0f;
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            td[i] = std::ldexp(static_cast<double>(k + i), -20) * 3.0 - 1.0;
+        }
+        __m256 sf, cf;
+        __m256d sd, cd;
+        at::simd::sincos_2pi(_mm256_loadu_ps(tf), sf, cf);
+        at::simd::sincos_2pi(_mm256_loadu_pd(td), sd, cd);
+        float sfa[8], cfa[8];
+        double sda[4], cda[4];
+        _mm256_storeu_ps(sfa, sf);
+        _mm256_storeu_ps(cfa, cf);
+        _mm256_storeu_pd(sda, sd);
+        _mm256_storeu_pd(cda, cd);
+        for (int i = 0; i < 8; i++)
+        {
+            double angle = 2 * M_PI * tf[i];
+            worst_sincos_float = std::max(worst_sincos_float, std::max(std::abs(sfa[i] - std::sin(angle)), std::abs(cfa[i] - std::cos(angle))));
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            long double angle = 2 * 3.141592653589793238462643383279502884L * td[i];
+            worst_sincos_double = std::max<double>(worst_sincos_double, std::max(std::abs(sda[i] - std::sin(angle)), std::abs(cda[i] - std::cos(angle))));
+        }
+    }
+    if (worst_sincos_float > 2.0 * FLT_EPSILON || worst_sincos_double > 2.0 * DBL_EPSILON)
+    {
+        printf("simd::sincos_2pi is off by %g (float) and %g (double)\n", worst_sincos_float, worst_sincos_double);
+        return;
+    }
+
+    // Box-Muller against a scalar evaluation of the same pairs, and its moments
+    const uint64_t n = 1 << 20;
+    at::philox_simd_engine gen_f(5, 0, 0), words_f(5, 0, 0);
+    at::philox_simd_engine gen_d(5, 0, 0), words_d(5, 0, 0);
+    std::vector<float> zf(n);
+    std::vector<double> zd(n / 2);
+    at::normal_float(gen_f, zf.data(), n, 1.0f, 2.0f);
+    at::normal_double(gen_d, zd.data(), n / 2, 1.0, 2.0);
+    at::detail::uniform_params<float> open_f(0.0f, 1.0f, at::uniform_interval::open_closed);
+    at::detail::uniform_params<float> closed_f(0.0f, 1.0f, at::uniform_interval::closed_open);
+    at::detail::uniform_params<double> open_d(0.0, 1.0, at::uniform_interval::open_closed);
+    at::detail::uniform_params<double> closed_d(0.0, 1.0, at::uniform_interval::closed_open);
+    for (uint64_t block = 0; block < n / 32; block++)
+    {
+        uint32_t w[32];
+        uint64_t v[16];
+        for (int j = 0; j < 32; j++)
+        {
+            w[j] = words_f();
+        }
+        for (int j = 0; j < 16; j++)
+        {
+            v[j] = words_d();
+            v[j] |= static_cast<uint64_t>(words_d()) << 32;
+        }
+        for (int half = 0; half < 2; half++)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                double u1 = at::detail::uniform_float_scalar<true>(w[16 * half + i], open_f);
+                double u2 = at::detail::uniform_float_scalar<false>(w[16 * half + 8 + i], closed_f);
+                double radius = std::sqrt(-2.0 * std::log(u1));
+                double z0 = 1.0 + 2.0 * radius * std::cos(2 * M_PI * u2);
+                double z1 = 1.0 + 2.0 * radius * std::sin(2 * M_PI * u2);
+                float a0 = zf[32 * block + 16 * half + i], a1 = zf[32 * block + 16 * half + 8 + i];
+                if (std::abs(a0 - z0) > 1e-5 * std::max(1.0, std::abs(z0)) || std::abs(a1 - z1) > 1e-5 * std::max(1.0, std::abs(z1)))
+                {
+                    printf("normal_float differs from scalar Box-Muller at %lu (%g, %g vs %g, %g)\n", 32 * block + 16 * half + i, a0, a1, z0, z1);
+                    return;
+                }
+            }
+            for (int i = 0; i < 4; i++)
+            {
+                if (block >= n / 64)
+                {
+                    break;
+                }
+                long double u1 = at::detail::uniform_double_scalar<true>(v[8 * half + i], open_d);
+                long double u2 = at::detail::uniform_double_scalar<false>(v[8 * half + 4 + i], closed_d);
+                long double radius = std::sqrt(-2.0L * std::log(u1));
+                long double angle = 2 * 3.141592653589793238462643383279502884L * u2;
+                long double z0 = 1.0L + 2.0L * radius * std::cos(angle);
+                long double z1 = 1.0L + 2.0L * radius * std::sin(angle);
+                double a0 = zd[16 * block + 8 * half + i], a1 = zd[16 * block + 8 * half + 4 + i];
+                if (std::abs(a0 - z0) > 1e-13L * std::max(1.0L, std::abs(z0)) || std::abs(a1 - z1) > 1e-13L * std::max(1.0L, std::abs(z1)))
+                {
+                    printf("normal_double differs from scalar Box-Muller at %lu (%g, %g vs %Lg, %Lg)\n", 16 * block + 8 * half + i, a0, a1, z0, z1);
+                    return;
+                }
+            }
+        }
+    }
+    double sum = 0, sum_sq = 0;
+    for (float z : zf)
+    {
+        sum += z;
+        sum_sq += (z - 1.0) * (z - 1.0);
+    }
+    double mean = sum / n, var = sum_sq / n;
+    if (std::abs(mean - 1.0) > 0.01 || std::abs(var - 4.0) > 0.04)
+    {
+        printf("normal_float has mean %g and variance %g instead of 1 and 4\n", mean, var);
+        return;
+    }
+    printf("OK (log within %g / %g ulp, sincos_2pi within %g / %g)\n", worst_float, worst_double, worst_sincos_float, worst_sincos_double);
+}
+
+template <typename real_t>
+static std::vector<real_t> concat(std::vector<real_t> a, const std::vector<real_t> &b)
+{
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+template <typename real_t>
+static bool same_value(real_t a, real_t b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+/**
+ * Special values and the ulp bounds of Note [SIMD math] for one ISA
+ */
+template <math_isa ISA>
+static bool check_simd_math_isa(const char *isa_name)
+{
+    const uint64_t n = 1 << 21;
+    const double float_bounds[3] = {0.80, 1.26, 1.58};
+    const double double_bounds[3] = {0.81, 1.73, 1.58};
+    const char *names[3] = {"log", "exp", "sincos"};
+
+    std::vector<float> log_f = math_sweep<float>(1e-45, 3.4e38, n, true);
+    std::vector<double> log_d = math_sweep<double>(1e-320, 1.7e308, n, true);
+    std::vector<float> exp_f = concat(math_sweep<float>(-103.9, 88.7, n), math_sweep<float>(-1, 1, n / 2));
+    std::vector<double> exp_d = concat(math_sweep<double>(-745, 709.7, n), math_sweep<double>(-1, 1, n / 2));
+    std::vector<float> trig_f = concat(math_sweep<float>(-65536, 65536, n), math_sweep<float>(-M_PI, M_PI, n / 2));
+    std::vector<double> trig_d = concat(math_sweep<double>(-1073741824.0, 1073741824.0, n), math_sweep<double>(-M_PI, M_PI, n / 2));
+    double worst_f[3] = {
+        math_worst_ulp<ISA>(math_log(), math_log(), log_f),
+        math_worst_ulp<ISA>(math_exp(), math_exp(), exp_f),
+        std::max(math_worst_ulp<ISA>(math_sincos<0>(), math_sincos<0>(), trig_f), math_worst_ulp<ISA>(math_sincos<1>(), math_sincos<1>(), trig_f))};
+    double worst_d[3] = {
+        math_worst_ulp<ISA>(math_log(), math_log(), log_d),
+        math_worst_ulp<ISA>(math_exp(), math_exp(), exp_d),
+        std::max(math_worst_ulp<ISA>(math_sincos<0>(), math_sincos<0>(), trig_d), math_worst_ulp<ISA>(math_sincos<1>(), math_sincos<1>(), trig_d))};
+    for (int i = 0; i < 3; i++)
+    {
+        if (worst_f[i] > float_bounds[i] || worst_d[i] > double_bounds[i])
+        {
+            printf("%s: simd::%s is off by %g ulp (float) and %g ulp (double)\n", isa_name, names[i], worst_f[i], worst_d[i]);
+            return false;
+        }
+    }
+
+    // sqrt is the correctly rounded instruction, so it matches libm exactly
+    std::vector<float> sqrt_f(n);
+    std::vector<double> sqrt_d(n);
+    math_map<ISA>(math_sqrt(), log_f.data(), sqrt_f.data(), n);
+    math_map<ISA>(math_sqrt(), log_d.data(), sqrt_d.data(), n);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        if (sqrt_f[i] != std::sqrt(log_f[i]) || sqrt_d[i] != std::sqrt(log_d[i]))
+        {
+            printf("%s: simd::sqrt(%g) is %g instead of %g\n", isa_name, log_d[i], sqrt_d[i], std::sqrt(log_d[i]));
+            return false;
+        }
+    }
+
+    // special values, 16 of them so that every ISA takes a whole number of vectors
+    const double special[16] = {0.0, -0.0, 1.0, -1.0, INFINITY, -INFINITY, NAN, 89.0, -104.0, 710.0, -746.0, 1e-45, 1e-310, 0.5, -0.5, 3.0};
+    float special_f[16], out_f[16];
+    double special_d[16], out_d[16];
+    for (int i = 0; i < 16; i++)
+    {
+        special_f[i] = static_cast<float>(special[i]);
+        special_d[i] = special[i];
+    }
+    for (int f = 0; f < 4; f++)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            out_f[i] = out_d[i] = 0;
+        }
+        float expected_f[16];
+        double expected_d[16];
+        if (f == 0)
+        {
+            math_map<ISA>(math_log(), special_f, out_f, 16);
+            math_map<ISA>(math_log(), special_d, out_d, 16);
+            math_map<math_isa::libm>(math_log(), special_f, expected_f, 16);
+            math_map<math_isa::libm>(math_log(), special_d, expected_d, 16);
+        }
+        else if (f == 1)
+        {
+            math_map<ISA>(math_exp(), special_f, out_f, 16);
+            math_map<ISA>(math_exp(), special_d, out_d, 16);
+            math_map<math_isa::libm>(math_exp(), special_f, expected_f, 16);
+            math_map<math_isa::libm>(math_exp(), special_d, expected_d, 16);
+        }
+        else
+        {
+            math_map<ISA>(math_sincos<0>(), special_f, out_f, 16);
+            math_map<ISA>(math_sincos<0>(), special_d, out_d, 16);
+            math_map<math_isa::libm>(math_sincos<0>(), special_f, expected_f, 16);
+            math_map<math_isa::libm>(math_sincos<0>(), special_d, expected_d, 16);
+            if (f == 3)
+            {
+                math_map<ISA>(math_sincos<1>(), special_f, out_f, 16);
+                math_map<ISA>(math_sincos<1>(), special_d, out_d, 16);
+                math_map<math_isa::libm>(math_sincos<1>(), special_f, expected_f, 16);
+                math_map<math_isa::libm>(math_sincos<1>(), special_d, expected_d, 16);
+            }
+        }
+        for (int i = 0; i < 16; i++)
+        {
+            // exact at the special values, within the bounds elsewhere
+            bool ok_f = same_value(out_f[i], expected_f[i]) || (std::isfinite(expected_f[i]) && ulp_error(out_f[i], expected_f[i]) <= 2);
+            bool ok_d = same_value(out_d[i], expected_d[i]) || (std::isfinite(expected_d[i]) && ulp_error(out_d[i], static_cast<long double>(expected_d[i])) <= 2);
+            if (!ok_f || !ok_d)
+            {
+                printf("%s: %s(%g) is %g / %g instead of %g / %g\n", isa_name, f == 0 ? "log" : f == 1 ? "exp" : f == 2 ? "sin" : "cos",
+                       special[i], out_f[i], out_d[i], expected_f[i], expected_d[i]);
+                return false;
+            }
+        }
+    }
+    printf("%s: log %.2f / %.2f, exp %.2f / %.2f, sincos %.2f / %.2f ulp (float / double)\n", isa_name,
+           worst_f[0], worst_d[0], worst_f[1], worst_d[1], worst_f[2], worst_d[2]);
+    return true;
+}
+
+void check_simd_math()
+{
+    if (!check_simd_math_isa<math_isa::avx2>("AVX2"))
+    {
+        return;
+    }
+#ifdef __AVX512F__
+    if (!check_simd_math_isa<math_isa::avx512>("AVX-512"))
+    {
+        return;
+    }
+    // sincos_2pi runs the same operations at both widths
+    std::vector<float> turns = math_sweep<float>(-4, 4, 1 << 20);
+    std::vector<float> avx2(turns.size()), avx512(turns.size());
+    math_map<math_isa::avx2>(math_sincos<2, true>(), turns.data(), avx2.data(), turns.size());
+    math_map<math_isa::avx512>(math_sincos<2, true>(), turns.data(), avx512.data(), turns.size());
+    if (avx2 != avx512)
+    {
+        printf("AVX-512 sincos_2pi differs from AVX2\n");
+        return;
+    }
+#endif
+    printf("OK\n");
+}
+
+/**
+ * Moments and tail fractions of ziggurat_normal and ziggurat_exponential
+ * against the exact distributions; n is odd so the scalar tail runs too
+ */
+template <typename engine_t>
+static bool check_ziggurat_engine(const char *engine_name, engine_t gen)
+{
+    const uint64_t n = (1 << 22) + 5;
+    std::vector<float> z(n), e(n);
+    at::ziggurat_normal(gen, z.data(), n, 1.0f, 2.0f);
+    at::ziggurat_exponential(gen, e.data(), n, 4.0f);
+    double sum = 0, sum_sq = 0, sum_e = 0;
+    uint64_t beyond_3 = 0, beyond_r = 0, exp_beyond_2 = 0;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        if (!std::isfinite(z[i]) || !(e[i] >= 0.0f) || !std::isfinite(e[i]))
+        {
+            printf("%s: ziggurat output %g / %g at %lu\n", engine_name, z[i], e[i], i);
+            return false;
+        }
+        double x = (z[i] - 1.0) / 2.0;
+        sum += x;
+        sum_sq += x * x;
+        beyond_3 += std::abs(x) > 3.0;
+        beyond_r += std::abs(x) > at::detail::ziggurat_tables::kNormalR;
+        sum_e += e[i];
+        exp_beyond_2 += e[i] > 0.5f;
+    }
+    // P(|z| > 3), P(|z| > r) and P(x > 2) for a unit exponential
+    const double p_3 = std::erfc(3.0 / M_SQRT2);
+    const double p_r = std::erfc(at::detail::ziggurat_tables::kNormalR / M_SQRT2);
+    const double p_e = std::exp(-2.0);
+    double mean = sum / n, var = sum_sq / n - mean * mean, mean_e = sum_e / n;
+    double f_3 = static_cast<double>(beyond_3) / n, f_r = static_cast<double>(beyond_r) / n, f_e = static_cast<double>(exp_beyond_2) / n;
+    // about 5 standard errors
+    if (std::abs(mean) > 0.0025 || std::abs(var - 1.0) > 0.0035 || std::abs(mean_e - 0.25) > 0.0007 ||
+        std::abs(f_3 - p_3) > 5 * std::sqrt(p_3 / n) || std::abs(f_r - p_r) > 5 * std::sqrt(p_r / n) ||
+        std::abs(f_e - p_e) > 5 * std::sqrt(p_e / n))
+    {
+        printf("%s: normal mean %g var %g, P(|z|>3) %g (%g), P(|z|>r) %g (%g), exponential mean %g (0.25), P(x>2) %g (%g)\n",
+               engine_name, mean, var, f_3, p_3, f_r, p_r, mean_e, f_e, p_e);
+        return false;
+    }
+    return true;
+}
+
+void check_ziggurat()
+{
+    if (!check_ziggurat_engine("philox_simd", at::philox_simd_engine(7, 0, 0)) ||
+        !check_ziggurat_engine("philox", at::philox_engine(7, 0, 0)) ||
+        !check_ziggurat_engine("xoshiro256**", xoshiro256starstar_engine(7)) ||
+        !check_ziggurat_engine("pcg64", at::pcg_engine(0x853c49e6748fea9bULL, 7)))
+    {
+        return;
+    }
+    // the same seed gives the same values
+    at::philox_simd_engine a(3, 0, 0), b(3, 0, 0);
+    std::vector<float> za(1001), zb(1001);
+    at::ziggurat_normal(a, za.data(), za.size());
+    at::ziggurat_normal(b, zb.data(), zb.size());
+    if (za != zb)
+    {
+        printf("ziggurat_normal is not reproducible\n");
+        return;
+    }
+    // split calls through a kept word_buffer continue the same stream
+    at::detail::word_buffer<at::philox_simd_engine> whole(a), split(b);
+    at::ziggurat_normal(whole, za.data(), 1000);
+    for (int j = 0; j < 1000; j += 8)
+    {
+        at::ziggurat_normal(split, zb.data() + j, 8);
+    }
+    if (za != zb)
+    {
+        printf("ziggurat_normal through a kept word_buffer depends on how the calls are split\n");
+        return;
+    }
+    printf("OK\n");
+}
+
+/**
+ * Frequencies of k mod 3 for n = 3 * 2^30, where plain multiply-shift maps
+ * two words to every third result and one word to the others
+ */
+template <typename engine_t>
+static bool check_uniform_int_engine(const char *engine_name, engine_t gen)
+{
+    const uint64_t count = (1 << 21) + 7;
+    std::vector<uint32_t> k(count);
+    const uint32_t bounds[6] = {1, 6, 1000, 1u << 31, 2147483649u, 4294967295u};
+    for (uint32_t n : bounds)
+    {
+        at::uniform_int(gen, k.data(), count, n);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (k[i] >= n || (i < 1000 && at::uniform_int(gen, n) >= n))
+            {
+                printf("%s: uniform_int(%u) returned %u\n", engine_name, n, k[i]);
+                return false;
+            }
+        }
+    }
+    at::uniform_int(gen, k.data(), count, 3u << 30);
+    uint64_t residues[3] = {0, 0, 0};
+    for (uint64_t i = 0; i < count; i++)
+    {
+        residues[k[i] % 3]++;
+    }
+    // chi-square with 2 degrees of freedom, 13.8 is the 0.1% critical value
+    double chi2 = 0;
+    for (int r = 0; r < 3; r++)
+    {
+        chi2 += (residues[r] - count / 3.0) * (residues[r] - count / 3.0) / (count / 3.0);
+    }
+    if (chi2 > 13.8)
+    {
+        printf("%s: uniform_int(3 * 2^30) residues %lu %lu %lu are biased\n", engine_name, residues[0], residues[1], residues[2]);
+        return false;
+    }
+    // a die, bulk and single draws
+    uint64_t faces[6] = {0, 0, 0, 0, 0, 0};
+    at::uniform_int(gen, k.data(), count, 6);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        faces[k[i]]++;
+        faces[at::uniform_int(gen, 6)]++;
+    }
+    chi2 = 0;
+    for (int f = 0; f < 6; f++)
+    {
+        chi2 += (faces[f] - count / 3.0) * (faces[f] - count / 3.0) / (count / 3.0);
+    }
+    // 20.5 is the 0.1% critical value for 5 degrees of freedom
+    if (chi2 > 20.5)
+    {
+        printf("%s: uniform_int(6) is biased, chi-square %g\n", engine_name, chi2);
+        return false;
+    }
+    return true;
+}
+
+void check_uniform_int()
+{
+    if (!check_uniform_int_engine("philox_simd", at::philox_simd_engine(11, 0, 0)) ||
+        !check_uniform_int_engine("philox", at::philox_engine(11, 0, 0)) ||
+        !check_uniform_int_engine("xoshiro256**", xoshiro256starstar_engine(11)) ||
+        !check_uniform_int_engine("pcg64", at::pcg_engine(0x853c49e6748fea9bULL, 11)))
+    {
+        return;
+    }
+    // powers of two never reject, so philox_simd gives the top bits of its words in order
+    at::philox_simd_engine gen(4, 0, 0), words(4, 0, 0);
+    std::vector<uint32_t> k(1003);
+    at::uniform_int(gen, k.data(), k.size(), 1u << 10);
+    for (uint64_t i = 0; i < k.size(); i++)
+    {
+        uint32_t expected = words() >> 22;
+        if (k[i] != expected)
+        {
+            printf("uniform_int(2^10) is %u instead of %u at %lu\n", k[i], expected, i);
+            return;
+        }
+    }
+    try
+    {
+        at::uniform_int(gen, k.data(), k.size(), 0);
+        printf("uniform_int accepted a bound of 0\n");
+        return;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    printf("OK\n");
+}
+
+/**
+ * Set bits of bernoulli_bits against p for n elements, with the bytes and
+ * floats of twin engines matching the bits element for element
+ */
+template <typename engine_t>
+static bool check_bernoulli_engine(const char *engine_name, const engine_t &gen)
+{
+    const uint64_t n = (1 << 22) + 13;
+    const double probabilities[7] = {0.0, 1.0, 0.5, 0.1, 0.9, 1.0 / 3.0, 1e-4};
+    std::vector<uint32_t> bits((n + 31) / 32);
+    std::vector<uint8_t> bytes(n);
+    std::vector<float> floats(n);
+    for (double p : probabilities)
+    {
+        engine_t bits_gen = gen, bytes_gen = gen, floats_gen = gen;
+        at::bernoulli_bits(bits_gen, bits.data(), n, p);
+        at::bernoulli_bytes(bytes_gen, bytes.data(), n, p);
+        at::bernoulli_float(floats_gen, floats.data(), n, p, 2.0f);
+        if (bits.back() >> (n % 32))
+        {
+            printf("%s: bernoulli_bits(%g) set bits past n\n", engine_name, p);
+            return false;
+        }
+        uint64_t ones = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            uint32_t bit = (bits[i / 32] >> (i % 32)) & 1;
+            if (bytes[i] != bit || floats[i] != 2.0f * bit)
+            {
+                printf("%s: bernoulli(%g) element %lu is %u in bits, %u in bytes and %g in floats\n",
+                       engine_name, p, i, bit, bytes[i], floats[i]);
+                return false;
+            }
+            ones += bit;
+        }
+        // five standard deviations
+        double sigma = std::sqrt(n * p * (1 - p));
+        if (std::fabs(ones - n * p) > 5 * sigma)
+        {
+            printf("%s: bernoulli(%g) set %lu of %lu elements\n", engine_name, p, ones, n);
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_bernoulli()
+{
+    if (!check_bernoulli_engine("philox_simd", at::philox_simd_engine(12, 0, 0)) ||
+        !check_bernoulli_engine("philox", at::philox_engine(12, 0, 0)) ||
+        !check_bernoulli_engine("xoshiro256**", xoshiro256starstar_engine(12)) ||
+        !check_bernoulli_engine("pcg64", at::pcg_engine(0x853c49e6748fea9bULL, 12)))
+    {
+        return;
+    }
+    // p = 0.5 hands out the words themselves, other p compare one word per
+    // element, both in whole next32 blocks here
+    at::philox_simd_engine gen(5, 0, 0), words(5, 0, 0);
+    std::vector<uint32_t> bits(64);
+    at::bernoulli_bits(gen, bits.data(), 32 * bits.size(), 0.5);
+    for (uint64_t k = 0; k < bits.size(); k++)
+    {
+        uint32_t expected = words();
+        if (bits[k] != expected)
+        {
+            printf("bernoulli_bits(0.5) word %lu is %08x instead of %08x\n", k, bits[k], expected);
+            return;
+        }
+    }
+    const double p = 0.3;
+    const uint32_t threshold = static_cast<uint32_t>(std::llround(p * 4294967296.0));
+    at::bernoulli_bits(gen, bits.data(), 32 * bits.size(), p);
+    for (uint64_t i = 0; i < 32 * bits.size(); i++)
+    {
+        uint32_t expected = words() < threshold;
+        if (((bits[i / 32] >> (i % 32)) & 1) != expected)
+        {
+            printf("bernoulli_bits(%g) element %lu is not %u\n", p, i, expected);
+            return;
+        }
+    }
+    try
+    {
+        at::bernoulli_bits(gen, bits.data(), 32, 1.5);
+        printf("bernoulli_bits accepted p = 1.5\n");
+        return;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    printf("OK\n");
+}
+
+/**
+ * bernoulli_indices against p: increasing indices below n, their count, and
+ * the gaps between them against the geometric distribution
+ */
+template <typename engine_t>
+static bool check_bernoulli_indices_engine(const char *engine_name, engine_t gen)
+{
+    const uint64_t n = (1 << 22) + 13;
+    const double probabilities[4] = {0.2, 0.05, 0.01, 1e-4};
+    std::vector<uint64_t> indices;
+    for (double p : probabilities)
+    {
+        at::bernoulli_indices(gen, n, p, indices);
+        // gaps 0 to 9 and 10 or more for p = 0.2, the bins of the others scale with 1 / p
+        const int bins = 11;
+        double width = 0.2 / p;
+        uint64_t observed[bins] = {};
+        for (uint64_t k = 0; k < indices.size(); k++)
+        {
+            uint64_t previous = k ? indices[k - 1] + 1 : 0;
+            if (indices[k] < previous || indices[k] >= n)
+            {
+                printf("%s: bernoulli_indices(%g) has %lu after %lu\n", engine_name, p, indices[k], previous);
+                return false;
+            }
+            observed[std::min<uint64_t>(bins - 1, static_cast<uint64_t>((indices[k] - previous) / width))]++;
+        }
+        double sigma = std::sqrt(n * p * (1 - p));
+        if (std::fabs(indices.size() - n * p) > 5 * sigma)
+        {
+            printf("%s: bernoulli_indices(%g) selected %lu of %lu elements\n", engine_name, p, indices.size(), n);
+            return false;
+        }
+        // P(gap >= g) = (1 - p)^g, chi-square with 10 degrees of freedom, 29.6 is the 0.1% critical value
+        double chi2 = 0;
+        for (int b = 0; b < bins; b++)
+        {
+            double lo = std::ceil(b * width), hi = b == bins - 1 ? INFINITY : std::ceil((b + 1) * width);
+            double expected = indices.size() * (std::pow(1 - p, lo) - (std::isinf(hi) ? 0.0 : std::pow(1 - p, hi)));
+            chi2 += (observed[b] - expected) * (observed[b] - expected) / expected;
+        }
+        if (p >= 0.01 && chi2 > 29.6)
+        {
+            printf("%s: bernoulli_indices(%g) gaps are not geometric, chi-square %g\n", engine_name, p, chi2);
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_bernoulli_indices()
+{
+    if (!check_bernoulli_indices_engine("philox_simd", at::philox_simd_engine(13, 0, 0)) ||
+        !check_bernoulli_indices_engine("philox", at::philox_engine(13, 0, 0)) ||
+        !check_bernoulli_indices_engine("xoshiro256**", xoshiro256starstar_engine(13)) ||
+        !check_bernoulli_indices_engine("pcg64", at::pcg_engine(0x853c49e6748fea9bULL, 13)))
+    {
+        return;
+    }
+    at::philox_simd_engine gen(6, 0, 0);
+    std::vector<uint64_t> indices(3, 7);
+    at::bernoulli_indices(gen, 1000, 0.0, indices);
+    if (!indices.empty())
+    {
+        printf("bernoulli_indices(0) selected %lu elements\n", indices.size());
+        return;
+    }
+    at::bernoulli_indices(gen, 1000, 1.0, indices);
+    if (indices.size() != 1000 || indices[999] != 999)
+    {
+        printf("bernoulli_indices(1) selected %lu of 1000 elements\n", indices.size());
+        return;
+    }
+    // short arrays, where the first batch is all that is drawn
+    uint64_t selected = 0;
+    for (int trial = 0; trial < 100000; trial++)
+    {
+        at::bernoulli_indices(gen, 37, 0.1, indices);
+        selected += indices.size();
+        if (!indices.empty() && indices.back() >= 37)
+        {
+            printf("bernoulli_indices selected %lu of 37 elements\n", indices.back());
+            return;
+        }
+    }
+    if (std::fabs(selected - 370000.0) > 5 * std::sqrt(370000.0 * 0.9))
+    {
+        printf("bernoulli_indices(0.1) selected %lu of 3700000 elements\n", selected);
+        return;
+    }
+    try
+    {
+        at::bernoulli_indices(gen, 1000, -0.5, indices);
+        printf("bernoulli_indices accepted p = -0.5\n");
+        return;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    printf("OK\n");
+}
+
+/**
+ * Ranges of the mask against bernoulli_bits and bernoulli_float over the
+ * whole mask from philox_simd_engine(seed, subsequence, offset), see
+ * Note [Bernoulli mask ranges]
+ */
+void check_bernoulli_range()
+{
+    const uint64_t n = 50000, seed = 21, subsequence = 3, offset = 17;
+    std::vector<float> src(n);
+    std::mt19937 mt(8);
+    std::normal_distribution<float> normal;
+    for (float &x : src)
+    {
+        x = normal(mt);
+    }
+    const double ps[] = {0.0, 0.5, 0.3, 0.9, 1.0};
+    const uint64_t ranges[][2] = {{0, n}, {0, 1}, {5, 27}, {31, 33}, {32, 1024}, {1000, 1}, {1001, 4099}, {33, 40000}, {44000, 6000}, {49999, 1}};
+    for (double p : ps)
+    {
+        std::vector<uint32_t> bits((n + 31) / 32);
+        std::vector<float> floats(n);
+        at::philox_simd_engine bits_gen(seed, subsequence, offset), float_gen(seed, subsequence, offset);
+        at::bernoulli_bits(bits_gen, bits.data(), n, p);
+        at::bernoulli_float(float_gen, floats.data(), n, p, 2.5f);
+        for (const auto &range : ranges)
+        {
+            uint64_t begin = range[0], count = range[1];
+            std::vector<uint32_t> part((count + 31) / 32, 0xDEADBEEF);
+            std::vector<float> product(count);
+            at::bernoulli_bits_range(seed, subsequence, offset, part.data(), begin, count, p);
+            at::bernoulli_mul_range(seed, subsequence, offset, src.data() + begin, product.data(), begin, count, p, 2.5f);
+            for (uint64_t i = 0; i < part.size() * 32; i++)
+            {
+                uint64_t g = begin + i;
+                uint32_t expected = i < count ? (bits[g / 32] >> (g % 32)) & 1 : 0;
+                if (((part[i / 32] >> (i % 32)) & 1) != expected)
+                {
+                    printf("bernoulli_bits_range(p = %g, %lu, %lu) differs at element %lu\n", p, static_cast<unsigned long>(begin),
+                           static_cast<unsigned long>(count), static_cast<unsigned long>(g));
+                    return;
+                }
+            }
+            for (uint64_t i = 0; i < count; i++)
+            {
+                if (product[i] != src[begin + i] * floats[begin + i])
+                {
+                    printf("bernoulli_mul_range(p = %g, %lu, %lu) differs at element %lu\n", p, static_cast<unsigned long>(begin),
+                           static_cast<unsigned long>(count), static_cast<unsigned long>(begin + i));
+                    return;
+                }
+            }
+        }
+    }
+    printf("OK\n");
+}
+
+/**
+ * Chi-square of count samples of table against weights, outcomes of weight
+ * 0 must never come up and are left out of the sum
+ */
+static bool alias_chi_square(const std::vector<double> &weights, const std::vector<uint32_t> &samples, double &chi2)
+{
+    std::vector<uint64_t> observed(weights.size(), 0);
+    for (uint32_t k : samples)
+    {
+        if (k >= weights.size())
+        {
+            return false;
+        }
+        observed[k]++;
+    }
+    double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    chi2 = 0;
+    for (uint64_t k = 0; k < weights.size(); k++)
+    {
+        double expected = samples.size() * weights[k] / sum;
+        if (expected == 0)
+        {
+            if (observed[k])
+            {
+                return false;
+            }
+            continue;
+        }
+        chi2 += (observed[k] - expected) * (observed[k] - expected) / expected;
+    }
+    return true;
+}
+
+static std::vector<double> zipf_weights(uint32_t n)
+{
+    std::vector<double> weights(n);
+    for (uint32_t k = 0; k < n; k++)
+    {
+        weights[k] = 1.0 / (k + 1);
+    }
+    return weights;
+}
+
+template <typename engine_t>
+static bool check_alias_table_engine(const char *engine_name, engine_t gen)
+{
+    // chi-square 0.1% critical values for 5 and 999 degrees of freedom
+    const std::vector<double> small = {1, 2, 3, 4, 0, 10, 0.5};
+    const std::vector<double> zipf = zipf_weights(1000);
+    const double critical[2] = {20.5, 1143.0};
+    const std::vector<double> *weights[2] = {&small, &zipf};
+    std::vector<uint32_t> samples((1 << 22) + 5);
+    for (int w = 0; w < 2; w++)
+    {
+        at::alias_table table(*weights[w]);
+        table.sample(gen, samples.data(), samples.size());
+        double chi2;
+        if (!alias_chi_square(*weights[w], samples, chi2) || chi2 > critical[w])
+        {
+            printf("%s: alias_table of %lu weights, bulk chi-square %g\n", engine_name, weights[w]->size(), chi2);
+            return false;
+        }
+        for (uint32_t &k : samples)
+        {
+            k = table(gen);
+        }
+        if (!alias_chi_square(*weights[w], samples, chi2) || chi2 > critical[w])
+        {
+            printf("%s: alias_table of %lu weights, single draw chi-square %g\n", engine_name, weights[w]->size(), chi2);
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_alias_table()
+{
+    if (!check_alias_table_engine("philox_simd", at::philox_simd_engine(14, 0, 0)) ||
+        !check_alias_table_engine("philox", at::philox_engine(14, 0, 0)) ||
+        !check_alias_table_engine("xoshiro256**", xoshiro256starstar_engine(14)) ||
+        !check_alias_table_engine("pcg64", at::pcg_engine(0x853c49e6748fea9bULL, 14)))
+    {
+        return;
+    }
+    // next32's registers and the same words through the buffered path agree
+    at::alias_table table(zipf_weights(37));
+    at::philox_simd_engine gen(7, 0, 0);
+    at::urbg32<at::philox_simd_engine> words(gen);
+    std::vector<uint32_t> direct(1003), buffered(1003);
+    table.sample(gen, direct.data(), direct.size());
+    table.sample(words, buffered.data(), buffered.size());
+    if (direct != buffered)
+    {
+        printf("alias_table samples from philox_simd differ from its buffered words\n");
+        return;
+    }
+    at::alias_table one(std::vector<double>(1, 0.25));
+    one.sample(gen, direct.data(), direct.size());
+    if (std::count(direct.begin(), direct.end(), 0U) != static_cast<long>(direct.size()))
+    {
+        printf("alias_table of one weight returned something else\n");
+        return;
+    }
+    const std::vector<double> invalid[3] = {{}, {1, -1}, {0, 0}};
+    for (const std::vector<double> &weights : invalid)
+    {
+        try
+        {
+            at::alias_table bad(weights);
+            printf("alias_table accepted %lu invalid weights\n", weights.size());
+            return;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+    }
+    printf("OK\n");
+}
+
+/**
+ * randperm and shuffle give permutations that depend on n and the seed
+ * but not on the number of threads, and move elements between blocks of
+ * the array uniformly
+ */
+void check_shuffle()
+{
+    const uint64_t sizes[6] = {0, 1, 5, 1 << 16, (1 << 16) + 1, (1 << 22) + 3};
+    for (uint64_t n : sizes)
+    {
+        std::vector<uint32_t> reference(n), perm(n), seen(n);
+        at::randperm(reference.data(), n, 3);
+        for (uint64_t threads = 2; threads <= 8; threads *= 2)
+        {
+            at::randperm(perm.data(), n, 3, threads + 1);
+            if (perm != reference)
+            {
+                printf("randperm(%lu) on %lu threads differs from one thread\n", n, threads + 1);
+                return;
+            }
+        }
+        for (uint32_t i : perm)
+        {
+            if (i >= n || seen[i]++)
+            {
+                printf("randperm(%lu) is not a permutation\n", n);
+                return;
+            }
+        }
+        // shuffling 0, ..., n - 1 is the same permutation
+        std::vector<uint32_t> data(n);
+        std::iota(data.begin(), data.end(), 0);
+        at::shuffle(data.data(), n, 3, 4);
+        if (data != reference)
+        {
+            printf("shuffle(%lu) differs from randperm\n", n);
+            return;
+        }
+        at::randperm(perm.data(), n, 4, 4);
+        if (n > 5 && perm == reference)
+        {
+            printf("randperm(%lu) is the same for different seeds\n", n);
+            return;
+        }
+    }
+    // which 256th of the array the elements of each sixteenth end up in, finer
+    // than the 16 buckets, chi-square with 3825 degrees of freedom, 4101 is
+    // the 0.1% critical value. The second run is a single bucket of the same
+    // size, past kShuffleMaxFisherYates, as the buckets of n past 2^27 are
+    const uint64_t n = 1 << 20;
+    std::vector<uint32_t> perm(n);
+    double chi2 = 0;
+    for (int nested = 0; nested < 2; nested++)
+    {
+        if (nested)
+        {
+            std::iota(perm.begin(), perm.end(), 0);
+            at::detail::shuffle_bucket(perm.data(), n, 5, 1 << at::detail::kShuffleMaxBucketsLog2);
+            std::vector<uint32_t> sorted(perm);
+            std::sort(sorted.begin(), sorted.end());
+            for (uint64_t i = 0; i < n; i++)
+            {
+                if (sorted[i] != i)
+                {
+                    printf("shuffle_bucket(2^20) is not a permutation\n");
+                    return;
+                }
+            }
+        }
+        else
+        {
+            at::randperm(perm.data(), n, 5, 2);
+        }
+        std::vector<double> cells(4096, 0);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            cells[(perm[i] >> 16) * 256 + (i >> 12)]++;
+        }
+        chi2 = 0;
+        for (double observed : cells)
+        {
+            chi2 += (observed - n / 4096.0) * (observed - n / 4096.0) / (n / 4096.0);
+        }
+        if (chi2 > 4101)
+        {
+            printf("%s(2^20) moves elements unevenly, chi-square %g\n", nested ? "shuffle_bucket" : "randperm", chi2);
+            return;
+        }
+    }
+    // all 24 orders of 4 elements, chi-square with 23 degrees of freedom, 49.7 is the 0.1% critical value
+    std::vector<double> orders(256, 0);
+    const int trials = 240000;
+    for (int t = 0; t < trials; t++)
+    {
+        uint32_t p[4];
+        at::randperm(p, 4, t);
+        orders[p[0] * 64 + p[1] * 16 + p[2] * 4 + p[3]]++;
+    }
+    chi2 = 0;
+    int distinct = 0;
+    for (double observed : orders)
+    {
+        if (observed)
+        {
+            distinct++;
+            chi2 += (observed - trials / 24.0) * (observed - trials / 24.0) / (trials / 24.0);
+        }
+    }
+    if (distinct != 24 || chi2 > 49.7)
+    {
+        printf("randperm(4) gives %d orders unevenly, chi-square %g\n", distinct, chi2);
+        return;
+    }
+    printf("OK\n");
+}
+
+/**
+ * Chi-square of integer samples against log_pmf, with consecutive
+ * outcomes pooled until every bin expects at least 20 samples. Returns
+ * false if the statistic is above the 0.1% critical value, which comes
+ * from the Wilson-Hilferty approximation.
+ */
+template <typename log_pmf_t>
+static bool discrete_chi_square(const std::vector<uint32_t> &samples, uint32_t lo, uint32_t hi, const log_pmf_t &log_pmf, double &chi2, int &bins)
+{
+    std::vector<uint64_t> counts(hi - lo + 1, 0);
+    uint64_t below = 0, above = 0;
+    for (uint32_t k : samples)
+    {
+        if (k < lo)
+            below++;
+        else if (k > hi)
+            above++;
+        else
+            counts[k - lo]++;
+    }
+    std::vector<double> expected(hi - lo + 1);
+    double inside = 0;
+    for (uint32_t k = lo; k <= hi; k++)
+    {
+        expected[k - lo] = samples.size() * std::exp(log_pmf(k));
+        inside += expected[k - lo];
+    }
+    // both tails together, outside [lo, hi]
+    double outside = samples.size() - inside;
+    std::vector<double> bin_expected(1, 0), bin_observed(1, 0);
+    for (uint32_t k = lo; k <= hi; k++)
+    {
+        if (bin_expected.back() >= 20)
+        {
+            bin_expected.push_back(0);
+            bin_observed.push_back(0);
+        }
+        bin_expected.back() += expected[k - lo];
+        bin_observed.back() += counts[k - lo];
+    }
+    // an underfilled last bin joins the one before it
+    if (bin_expected.size() > 1 && bin_expected.back() < 20)
+    {
+        bin_expected[bin_expected.size() - 2] += bin_expected.back();
+        bin_observed[bin_observed.size() - 2] += bin_observed.back();
+        bin_expected.pop_back();
+        bin_observed.pop_back();
+    }
+    if (outside >= 1)
+    {
+        bin_expected.push_back(outside);
+        bin_observed.push_back(below + above);
+    }
+    else if (below + above > 5)
+    {
+        // samples where next to none are expected
+        chi2 = INFINITY;
+        bins = bin_expected.size();
+        return false;
+    }
+    chi2 = 0;
+    bins = bin_expected.size();
+    for (int b = 0; b < bins; b++)
+    {
+        chi2 += (bin_observed[b] - bin_expected[b]) * (bin_observed[b] - bin_expected[b]) / bin_expected[b];
+    }
+    if (bins < 2)
+    {
+        return chi2 < 1e-9;
+    }
+    double df = bins - 1, z = 3.09;
+    double critical = df * std::pow(1 - 2 / (9 * df) + z * std::sqrt(2 / (9 * df)), 3);
+    return chi2 <= critical;
+}
+
+template <typename engine_t>
+static bool check_distributions_engine(const char *engine_name, engine_t gen)
+{
+    const uint64_t count = (1 << 20) + 3;
+    // gamma moments, mean alpha and variance alpha, within five standard deviations
+    const float shapes[5] = {0.2f, 0.9f, 1.0f, 3.5f, 40.0f};
+    std::vector<float> x(count);
+    for (float alpha : shapes)
+    {
+        at::gamma_float(gen, x.data(), count, alpha, 2.0f);
+        double sum = 0, sum2 = 0;
+        for (float v : x)
+        {
+            if (!(v >= 0 && std::isfinite(v)))
+            {
+                printf("%s: gamma_float(%g) returned %g\n", engine_name, alpha, v);
+                return false;
+            }
+            sum += v / 2;
+            sum2 += (v / 2) * (v / 2);
+        }
+        double mean = sum / count, var = sum2 / count - mean * mean;
+        double mean_sigma = std::sqrt(alpha / count), var_sigma = alpha * std::sqrt((6 / alpha + 2) / count);
+        if (std::fabs(mean - alpha) > 5 * mean_sigma || std::fabs(var - alpha) > 5 * var_sigma)
+        {
+            printf("%s: gamma_float(%g) has mean %g and variance %g\n", engine_name, alpha, mean, var);
+            return false;
+        }
+    }
+    std::vector<uint32_t> k(count);
+    double chi2;
+    int bins;
+    const double means[7] = {0.0, 0.3, 4.0, 9.99, 10.0, 87.5, 250000.0};
+    for (double lambda : means)
+    {
+        at::poisson(gen, k.data(), count, lambda);
+        double spread = 8 * std::sqrt(lambda) + 10;
+        uint32_t lo = static_cast<uint32_t>(std::max(0.0, lambda - spread)), hi = static_cast<uint32_t>(lambda + spread);
+        auto log_pmf = [lambda](uint32_t j) { return lambda == 0 ? (j ? -INFINITY : 0.0) : j * std::log(lambda) - lambda - std::lgamma(j + 1.0); };
+        if (!discrete_chi_square(k, lo, hi, log_pmf, chi2, bins))
+        {
+            printf("%s: poisson(%g) chi-square %g over %d bins\n", engine_name, lambda, chi2, bins);
+            return false;
+        }
+    }
+    const std::pair<uint32_t, double> trials[8] = {{0, 0.5}, {20, 0.3}, {1000, 0.995}, {17, 1.0}, {1000, 0.5}, {200, 0.8}, {100000, 0.01}, {3000000000U, 0.25}};
+    for (const std::pair<uint32_t, double> &t : trials)
+    {
+        uint32_t n = t.first;
+        double p = t.second;
+        at::binomial(gen, k.data(), count, n, p);
+        double mean = n * p, spread = 8 * std::sqrt(n * p * (1 - p)) + 10;
+        uint32_t lo = static_cast<uint32_t>(std::max(0.0, mean - spread)), hi = static_cast<uint32_t>(std::min<double>(n, mean + spread));
+        auto log_pmf = [n, p](uint32_t j) {
+            if (p == 0 || p == 1)
+            {
+                return j == (p == 1 ? n : 0) ? 0.0 : -INFINITY;
+            }
+            return std::lgamma(n + 1.0) - std::lgamma(j + 1.0) - std::lgamma(n - j + 1.0) + j * std::log(p) + (n - j) * std::log1p(-p);
+        };
+        if (!discrete_chi_square(k, lo, hi, log_pmf, chi2, bins))
+        {
+            printf("%s: binomial(%u, %g) chi-square %g over %d bins\n", engine_name, n, p, chi2, bins);
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_distributions()
+{
+    if (!check_distributions_engine("philox_simd", at::philox_simd_engine(15, 0, 0)) ||
+        !check_distributions_engine("philox", at::philox_engine(15, 0, 0)) ||
+        !check_distributions_engine("xoshiro256**", xoshiro256starstar_engine(15)) ||
+        !check_distributions_engine("pcg64", at::pcg_engine(0x853c49e6748fea9bULL, 15)))
+    {
+        return;
+    }
+    // a word_buffer kept across calls gives the same samples as one call
+    {
+        at::philox_simd_engine a(9, 0, 0), b(9, 0, 0);
+        at::detail::word_buffer<at::philox_simd_engine> whole(a), split(b);
+        std::vector<float> xa(64), xb(64);
+        std::vector<uint32_t> ka(60), kb(60);
+        at::gamma_float(whole, xa.data(), 64, 2.5f);
+        at::poisson(whole, ka.data(), 20, 30.0);
+        at::poisson(whole, ka.data() + 20, 20, 3.0);
+        at::binomial(whole, ka.data() + 40, 20, 100, 0.3);
+        for (int j = 0; j < 64; j += 8)
+        {
+            at::gamma_float(split, xb.data() + j, 8, 2.5f);
+        }
+        for (int j = 0; j < 20; j += 4)
+        {
+            at::poisson(split, kb.data() + j, 4, 30.0);
+        }
+        at::poisson(split, kb.data() + 20, 5, 3.0);
+        at::poisson(split, kb.data() + 25, 15, 3.0);
+        for (int j = 40; j < 60; j += 4)
+        {
+            at::binomial(split, kb.data() + j, 4, 100, 0.3);
+        }
+        if (xa != xb || ka != kb)
+        {
+            printf("gamma_float, poisson or binomial through a kept word_buffer depend on how the calls are split\n");
+            return;
+        }
+    }
+    at::philox_simd_engine gen(8, 0, 0);
+    std::vector<uint32_t> k(10);
+    std::vector<float> x(10);
+    try
+    {
+        at::gamma_float(gen, x.data(), x.size(), 0.0f);
+        printf("gamma_float accepted a shape of 0\n");
+        return;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    try
+    {
+        at::poisson(gen, k.data(), k.size(), -1.0);
+        printf("poisson accepted a mean of -1\n");
+        return;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    try
+    {
+        at::binomial(gen, k.data(), k.size(), 10, 1.5);
+        printf("binomial accepted p = 1.5\n");
+        return;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    printf("OK\n");
+}
+
+/**
+ * Chi-square of samples from the normal (mean, stddev) truncated to [a, b]
+ * over 100 bins of equal probability, with 99 degrees of freedom. Returns
+ * false if a sample is outside [a, b].
+ */
+static bool truncated_normal_chi_square(const std::vector<float> &x, float mean, float stddev, float a, float b, double &chi2)
+{
+    // upper tail probabilities, accurate far from the mode on either side
+    auto upper = [&](double v) { return 0.5 * std::erfc((v - mean) / stddev * M_SQRT1_2); };
+    const double qa = upper(a), mass = qa - upper(b);
+    std::vector<uint64_t> observed(100, 0);
+    for (float v : x)
+    {
+        if (!(v >= a && v <= b))
+        {
+            return false;
+        }
+        int bin = static_cast<int>((qa - upper(v)) / mass * 100);
+        observed[std::min(std::max(bin, 0), 99)]++;
+    }
+    chi2 = 0;
+    const double expected = x.size() / 100.0;
+    for (uint64_t o : observed)
+    {
+        chi2 += (o - expected) * (o - expected) / expected;
+    }
+    return true;
+}
+
+/**
+ * Truncated normals stay inside their bounds, match the truncated
+ * distribution in the central, tail and exponential cases of Note
+ * [Truncated normals] and don't depend on the number of threads
+ */
+void check_truncated_normal()
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    // mean, stddev, a, b
+    const float cases[][4] = {
+        {0.0f, 1.0f, -2.0f, 2.0f},
+        {0.0f, 0.02f, -0.04f, 0.04f},
+        {0.0f, 1.0f, -inf, inf},
+        {1.0f, 2.0f, -0.5f, 9.0f},
+        {0.0f, 1.0f, 1.0f, 3.0f},
+        {1.0f, 2.0f, -3.0f, 0.0f},
+        {0.0f, 1.0f, -inf, -1.5f},
+        {0.0f, 1.0f, 2.9f, 2.95f},
+        {0.0f, 1.0f, 3.0f, inf},
+        {0.0f, 1.0f, -5.5f, -5.0f},
+        {2.0f, 0.5f, 6.0f, 100.0f},
+        {0.0f, 1.0f, 0.0f, 1e-4f},
+        {0.0f, 2.0f, -2e-6f, 0.0f},
+    };
+    // 0.1% critical value for 99 degrees of freedom
+    const double critical = 148.2;
+    const uint64_t n = 1 << 20;
+    std::vector<float> x(n), y(n);
+    for (const auto &c : cases)
+    {
+        at::truncated_normal_float(x.data(), n, 9, c[0], c[1], c[2], c[3]);
+        at::truncated_normal_float(y.data(), n, 9, c[0], c[1], c[2], c[3], 3);
+        if (x != y)
+        {
+            printf("truncated_normal_float(%g, %g, %g, %g) differs on 3 threads\n", c[0], c[1], c[2], c[3]);
+            return;
+        }
+        double chi2;
+        if (!truncated_normal_chi_square(x, c[0], c[1], c[2], c[3], chi2))
+        {
+            printf("truncated_normal_float(%g, %g, %g, %g) is out of bounds\n", c[0], c[1], c[2], c[3]);
+            return;
+        }
+        if (chi2 > critical)
+        {
+            printf("truncated_normal_float(%g, %g, %g, %g) chi-square %g\n", c[0], c[1], c[2], c[3], chi2);
+            return;
+        }
+    }
+    // narrow intervals next to the mean keep most of their outputs apart
+    const float narrow[][4] = {
+        {0.0f, 1.0f, 0.0f, 1e-4f},
+        {0.0f, 1.0f, -1e-6f, 0.0f},
+        {0.0f, 0.5f, 0.0f, 5e-7f},
+    };
+    for (const auto &c : narrow)
+    {
+        const uint64_t m = 1 << 16;
+        std::vector<float> z(m);
+        at::truncated_normal_float(z.data(), m, 12, c[0], c[1], c[2], c[3]);
+        std::sort(z.begin(), z.end());
+        uint64_t distinct = std::unique(z.begin(), z.end()) - z.begin();
+        if (distinct < m / 2)
+        {
+            printf("truncated_normal_float(%g, %g, %g, %g) gives only %lu distinct values of %lu\n", c[0], c[1], c[2], c[3],
+                   static_cast<unsigned long>(distinct), static_cast<unsigned long>(m));
+            return;
+        }
+    }
+    // erfinv against erf for x from -1 + 2^-24 to 1 - 2^-24, both
+    // polynomials included
+    for (int k = -23; k <= 23; k++)
+    {
+        double xs[8];
+        for (int j = 0; j < 8; j++)
+        {
+            double t = std::ldexp(1.0 + j / 8.0, -std::abs(k) - 1);
+            xs[j] = k < 0 ? -1.0 + t : (k == 0 ? (j - 4) / 4.5 : 1.0 - t);
+        }
+        __m256 xv = _mm256_setr_ps(xs[0], xs[1], xs[2], xs[3], xs[4], xs[5], xs[6], xs[7]);
+        float z[8];
+        _mm256_storeu_ps(z, at::detail::erfinv(xv, _mm256_sub_ps(_mm256_set1_ps(1.0f), xv), _mm256_add_ps(_mm256_set1_ps(1.0f), xv)));
+        for (int j = 0; j < 8; j++)
+        {
+            float xf = static_cast<float>(xs[j]);
+            // erf(z) against x, scaled by the slope of erf at z
+            double error = (std::erf(z[j]) - xf) / (M_2_SQRTPI * std::exp(-static_cast<double>(z[j]) * z[j]));
+            if (!std::isfinite(z[j]) || !(std::fabs(error) <= 4e-7 * std::max(1.0, std::fabs(static_cast<double>(z[j])))))
+            {
+                printf("erfinv(%.9g) = %.9g is off by %g\n", xf, z[j], error);
+                return;
+            }
+        }
+    }
+    // the scalar fallback of the exponential method on its own
+    const at::detail::truncated_normal_params tail(0.0f, 1.0f, 3.0f, inf);
+    xoshiro256starstar_engine gen(9);
+    at::detail::word_buffer<xoshiro256starstar_engine> words(gen);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        x[i] = static_cast<float>(at::detail::truncated_normal_exponential_scalar(tail, words));
+    }
+    double chi2;
+    if (!truncated_normal_chi_square(x, 0.0f, 1.0f, 3.0f, inf, chi2) || chi2 > critical)
+    {
+        printf("truncated normal exponential fallback chi-square %g\n", chi2);
+        return;
+    }
+    at::truncated_normal_float(gen, x.data(), n, 0.0f, 1.0f, 0.5f, 4.0f);
+    if (!truncated_normal_chi_square(x, 0.0f, 1.0f, 0.5f, 4.0f, chi2) || chi2 > critical)
+    {
+        printf("xoshiro256**: truncated_normal_float(0, 1, 0.5, 4) chi-square %g\n", chi2);
+        return;
+    }
+    const float invalid[][4] = {{0.0f, 0.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, NAN, 1.0f}, {inf, 1.0f, -1.0f, 1.0f}};
+    for (const auto &c : invalid)
+    {
+        try
+        {
+            at::truncated_normal_float(gen, x.data(), 8, c[0], c[1], c[2], c[3]);
+            printf("truncated_normal_float accepted (%g, %g, %g, %g)\n", c[0], c[1], c[2], c[3]);
+            return;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+    }
+    printf("OK\n");
+}
+
+/**
+ * The uniform a 16-bit piece of a word should give, see Note [Half
+ * precision output]
+ */
+template <typename format_t>
+static uint16_t reference_uniform_16(uint16_t piece, const at::detail::uniform_params<float> &p, bool open_closed)
+{
+    float x = std::ldexp(static_cast<float>(piece >> (16 - format_t::kDigits)), -format_t::kDigits);
+    if (open_closed)
+    {
+        x = 1.0f - x;
+    }
+    return format_t::from_float(std::min(std::max(std::fma(x, p.range, p.lo), p.lower), p.upper));
+}
+
+template <typename format_t>
+static bool check_half_format(const char *format_name,
+                              void (*uniform)(at::philox_simd_engine &, uint16_t *, uint64_t, float, float, at::uniform_interval),
+                              void (*normal)(at::philox_simd_engine &, uint16_t *, uint64_t, float, float))
+{
+    // every value converts back to itself, NaNs aside
+    for (uint32_t h = 0; h < 65536; h++)
+    {
+        float f = format_t::to_float(static_cast<uint16_t>(h));
+        if (!std::isnan(f) && format_t::from_float(f) != h)
+        {
+            printf("%s: 0x%04x doesn't convert back to itself\n", format_name, h);
+            return false;
+        }
+    }
+    // the vector conversion against the scalar one, on a sweep of floats
+    // that includes the ties, normal floats only
+    for (uint64_t x = 0x00800000; x < 0x7F800000 - 3 * 0x7FF; x += 0x1000 - 1)
+    {
+        float lanes[8];
+        uint16_t scalar[8], vector[8];
+        for (int i = 0; i < 8; i++)
+        {
+            uint32_t bits = static_cast<uint32_t>(x + (i & 3) * 0x7FF) | (i >= 4 ? 0x80000000U : 0);
+            memcpy(&lanes[i], &bits, sizeof(float));
+            scalar[i] = format_t::from_float(lanes[i]);
+        }
+        _mm_storeu_si128((__m128i *)vector, format_t::convert8(_mm256_loadu_ps(lanes)));
+        if (memcmp(scalar, vector, sizeof(scalar)) != 0)
+        {
+            printf("%s: converting %.9g to 16 bits differs between scalar and vector\n", format_name, lanes[0]);
+            return false;
+        }
+    }
+    // bulk fills against the scalar reference, on the words of a copy of the engine
+    const uint64_t n = 4096 + 37;
+    std::vector<uint16_t> out(n);
+    const float bounds[][2] = {{0.0f, 1.0f}, {-1.0f, 1.0f}, {0.1f, 0.7f}, {-3.0f, 5.0f}, {1000.0f, 1024.0f}};
+    for (const auto &b : bounds)
+    {
+        for (int open_closed = 0; open_closed < 2; open_closed++)
+        {
+            at::uniform_interval interval = open_closed ? at::uniform_interval::open_closed : at::uniform_interval::closed_open;
+            at::philox_simd_engine gen(21, 3, 0), copy = gen;
+            uniform(gen, out.data(), n, b[0], b[1], interval);
+            const at::detail::uniform_params<float> p = at::detail::uniform_16_params<format_t>(b[0], b[1], interval);
+            for (uint64_t i = 0; i < n; i += 2)
+            {
+                uint32_t word = copy();
+                for (uint64_t j = i; j < std::min(i + 2, n); j++)
+                {
+                    uint16_t piece = static_cast<uint16_t>(j == i ? word : word >> 16);
+                    if (out[j] != reference_uniform_16<format_t>(piece, p, open_closed))
+                    {
+                        printf("%s: uniform over (%g, %g) differs from the reference at %lu\n", format_name, b[0], b[1], j);
+                        return false;
+                    }
+                }
+            }
+            float lowest = format_t::to_float(out[0]), highest = lowest;
+            for (uint16_t h : out)
+            {
+                lowest = std::min(lowest, format_t::to_float(h));
+                highest = std::max(highest, format_t::to_float(h));
+            }
+            if (lowest < p.lower || highest > p.upper || (open_closed ? lowest == p.lo : highest == p.lo + p.range))
+            {
+                printf("%s: uniform over (%g, %g) reaches [%g, %g]\n", format_name, b[0], b[1], lowest, highest);
+                return false;
+            }
+        }
+    }
+    at::philox_simd_engine gen(22, 0, 0), copy = gen;
+    std::vector<float> reference(n);
+    normal(gen, out.data(), n, 1.0f, 3.0f);
+    at::normal_float(copy, reference.data(), n, 1.0f, 3.0f);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        if (out[i] != format_t::from_float(reference[i]))
+        {
+            printf("%s: normal differs from normal_float rounded at %lu\n", format_name, i);
+            return false;
+        }
+    }
+    try
+    {
+        uniform(gen, out.data(), n, 1.0f, 1.0001f, at::uniform_interval::closed_open);
+        printf("%s: uniform accepted bounds that round to the same value\n", format_name);
+        return false;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    return true;
+}
+
+/**
+ * fp16 and bfloat16 conversions and fills, see Note [Half precision output]
+ */
+void check_half()
+{
+    if (!check_half_format<at::detail::half_format>("fp16", at::uniform_half, at::normal_half) ||
+        !check_half_format<at::detail::bfloat16_format>("bfloat16", at::uniform_bfloat16, at::normal_bfloat16))
+    {
+        return;
+    }
+    // fp16 denormals, overflow and ties, which the sweep above skips
+    const float special[] = {5.96046448e-08f, 2.98023224e-08f, 2.98023259e-08f, 8.94069672e-08f, 6.1e-05f,
+                             65504.0f, 65519.0f, 65520.0f, INFINITY, -1e-7f, 1.00048828f, 1.00146484f};
+    const uint16_t expected[] = {0x0001, 0x0000, 0x0001, 0x0002, 0x03FF, 0x7BFF, 0x7BFF, 0x7C00, 0x7C00, 0x8002, 0x3C00, 0x3C02};
+    for (size_t i = 0; i < sizeof(special) / sizeof(special[0]); i++)
+    {
+        if (at::detail::float_to_half(special[i]) != expected[i])
+        {
+            printf("fp16: %.9g converts to 0x%04x instead of 0x%04x\n", special[i], at::detail::float_to_half(special[i]), expected[i]);
+            return;
+        }
+    }
+    printf("OK\n");
+}
+
+/**
+ * What stochastic rounding should give for x and its 16-bit piece, worked
+ * out from the two neighbours, see Note [Stochastic rounding]
+ */
+static uint16_t reference_stochastic_bfloat16(float x, uint16_t piece)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    uint32_t low = bits & 0xFFFF;
+    return static_cast<uint16_t>((bits >> 16) + (low > 0 && piece >= 65536 - low));
+}
+
+static uint16_t reference_stochastic_half(float x, uint16_t piece)
+{
+    uint16_t lower = at::detail::float_to_half_toward_zero(x);
+    double a = std::fabs(static_cast<double>(x));
+    if (!std::isfinite(x) || a >= 65504)
+    {
+        return lower;
+    }
+    double lo = std::fabs(at::detail::half_to_float(lower));
+    double hi = std::fabs(at::detail::half_to_float(static_cast<uint16_t>(lower + 1)));
+    double frac = (a - lo) / (hi - lo);
+    bool up = a < std::ldexp(1.0, -24) ? piece < frac * 65536 : piece >= (1 - frac) * 65536;
+    return static_cast<uint16_t>(lower + up);
+}
+
+static int8_t reference_stochastic_int8(float x, float scale, uint16_t piece)
+{
+    float q = x * (1.0f / scale);
+    if (std::isnan(q))
+    {
+        return 0;
+    }
+    float f = std::floor(q + piece * (1.0f / 65536.0f));
+    return static_cast<int8_t>(std::min(127.0f, std::max(-128.0f, f)));
+}
+
+/**
+ * Each rounding against the reference on the same pieces, the mean of
+ * many roundings against x, and the same results for any number of threads
+ * or any split of the stream
+ */
+void check_stochastic_rounding()
+{
+    const uint64_t n = (1 << 17) + 123;
+    const uint64_t seed = 31, offset = 1000;
+    // magnitudes from 2^-30 to 2^17 with both signs, and the special values
+    std::vector<float> src(n);
+    std::mt19937 mt(5);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        float m = std::ldexp(1.0f + (mt() >> 8) * (1.0f / 16777216.0f), static_cast<int>(mt() % 48) - 30);
+        src[i] = (mt() & 1) ? -m : m;
+    }
+    const float special[] = {0.0f, -0.0f, INFINITY, -INFINITY, NAN, 1.0f, 65504.0f, 65519.0f, 1e30f, 3.4e38f, 1e-40f, 1.5f, -12.7f};
+    std::copy(special, special + sizeof(special) / sizeof(special[0]), src.begin() + 77);
+    // the pieces of elements offset, offset + 1, ...
+    std::vector<uint16_t> pieces(offset + n + 1);
+    at::philox_simd_engine stream(seed, 0, 0);
+    for (uint64_t i = 0; i < pieces.size(); i += 2)
+    {
+        uint32_t word = stream();
+        pieces[i] = static_cast<uint16_t>(word);
+        if (i + 1 < pieces.size())
+        {
+            pieces[i + 1] = static_cast<uint16_t>(word >> 16);
+        }
+    }
+    std::vector<uint16_t> b(n), h(n), b3(n), h3(n);
+    std::vector<int8_t> q(n), q3(n);
+    at::stochastic_round_bfloat16(src.data(), b.data(), n, seed, offset);
+    at::stochastic_round_half(src.data(), h.data(), n, seed, offset);
+    at::stochastic_round_int8(src.data(), q.data(), n, 0.25f, seed, offset);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint16_t piece = pieces[offset + i];
+        bool nan = std::isnan(src[i]);
+        if (nan ? !std::isnan(at::detail::bfloat16_to_float(b[i])) : b[i] != reference_stochastic_bfloat16(src[i], piece))
+        {
+            printf("stochastic_round_bfloat16(%.9g) is 0x%04x, piece 0x%04x\n", src[i], b[i], piece);
+            return;
+        }
+        if (nan ? !std::isnan(at::detail::half_to_float(h[i])) : h[i] != reference_stochastic_half(src[i], piece))
+        {
+            printf("stochastic_round_half(%.9g) is 0x%04x instead of 0x%04x, piece 0x%04x\n", src[i], h[i], reference_stochastic_half(src[i], piece), piece);
+            return;
+        }
+        if (q[i] != reference_stochastic_int8(src[i], 0.25f, piece))
+        {
+            printf("stochastic_round_int8(%.9g) is %d, piece 0x%04x\n", src[i], q[i], piece);
+            return;
+        }
+    }
+    // 3 threads, and the same range as three calls split off the chunk boundaries
+    at::stochastic_round_bfloat16(src.data(), b3.data(), n, seed, offset, 3);
+    at::stochastic_round_half(src.data(), h3.data(), 1001, seed, offset, 3);
+    at::stochastic_round_half(src.data() + 1001, h3.data() + 1001, 70000, seed, offset + 1001, 3);
+    at::stochastic_round_half(src.data() + 71001, h3.data() + 71001, n - 71001, seed, offset + 71001, 3);
+    at::stochastic_round_int8(src.data(), q3.data(), n, 0.25f, seed, offset, 4);
+    if (b != b3 || h != h3 || q != q3)
+    {
+        printf("stochastic rounding depends on the threads or the split of the stream\n");
+        return;
+    }
+    // the mean of 2^18 roundings of x is x within 5 standard deviations
+    const uint64_t trials = 1 << 18;
+    const float xs[] = {1.0f + 0.3f / 1024, -1000.3f, 3e-6f, 2e-8f, 1.0f + 0.37f / 128, 0.537f};
+    std::vector<float> same(trials);
+    std::vector<uint16_t> out(trials);
+    std::vector<int8_t> out8(trials);
+    for (int k = 0; k < 6; k++)
+    {
+        std::fill(same.begin(), same.end(), xs[k]);
+        double sum = 0, lower, upper;
+        if (k < 4)
+        {
+            at::stochastic_round_half(same.data(), out.data(), trials, seed + k);
+            for (uint16_t v : out)
+                sum += at::detail::half_to_float(v);
+            uint16_t l = at::detail::float_to_half_toward_zero(xs[k]);
+            lower = at::detail::half_to_float(l);
+            upper = at::detail::half_to_float(static_cast<uint16_t>(l + 1));
+        }
+        else if (k == 4)
+        {
+            at::stochastic_round_bfloat16(same.data(), out.data(), trials, seed + k);
+            for (uint16_t v : out)
+                sum += at::detail::bfloat16_to_float(v);
+            uint32_t bits;
+            memcpy(&bits, &xs[k], sizeof(bits));
+            lower = at::detail::bfloat16_to_float(static_cast<uint16_t>(bits >> 16));
+            upper = at::detail::bfloat16_to_float(static_cast<uint16_t>((bits >> 16) + 1));
+        }
+        else
+        {
+            at::stochastic_round_int8(same.data(), out8.data(), trials, 0.1f, seed + k);
+            for (int8_t v : out8)
+                sum += v * 0.1;
+            lower = 0.5;
+            upper = 0.6;
+        }
+        double p = (xs[k] - lower) / (upper - lower);
+        double sigma = std::fabs(upper - lower) * (std::sqrt(p * (1 - p) / trials) + 1.0 / 65536);
+        if (std::fabs(sum / trials - xs[k]) > 5 * sigma)
+        {
+            printf("stochastic rounding of %.9g averages %.9g\n", xs[k], sum / trials);
+            return;
+        }
+    }
+    printf("OK\n");
+}
+
+/**
+ * The words of generate_transform against the engine's own stream, and the
+ * engine where the stream leaves it, see Note [Fused generate and transform]
+ */
+template <typename engine_t, typename draw_t>
+static bool check_generate_transform_engine(const char *name, const engine_t &start, const draw_t &draw, uint64_t n)
+{
+    engine_t fused = start, reference = start;
+    std::vector<uint32_t> words(n, 0), expected(n);
+    draw.transform(fused, words, n);
+    draw.stream(reference, expected.data(), n);
+    uint32_t after[2], expected_after[2];
+    draw.stream(fused, after, 2);
+    draw.stream(reference, expected_after, 2);
+    if (words != expected || after[0] != expected_after[0] || after[1] != expected_after[1])
+    {
+        printf("%s generate_transform(%lu) doesn't follow the stream\n", name, static_cast<unsigned long>(n));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * The register type of each vector engine's next32
+ */
+template <typename engine_t>
+struct next32_vec
+{
+    typedef typename engine_t::vec_t type;
+};
+
+template <>
+struct next32_vec<at::philox_simd_engine>
+{
+    typedef __m256i type;
+};
+
+template <>
+struct next32_vec<at::philox_simd_streams_engine>
+{
+    typedef __m256i type;
+};
+
+/**
+ * The vector engines, whose stream is next32 blocks drawn in full
+ */
+template <typename engine_t>
+struct next32_draw
+{
+    typedef typename next32_vec<engine_t>::type vec_t;
+    static const uint64_t kWords = 4 * sizeof(vec_t) / sizeof(uint32_t);
+
+    void transform(engine_t &gen, std::vector<uint32_t> &words, uint64_t n) const
+    {
+        gen.generate_transform(n, [&](uint64_t i, const vec_t(&block)[4], uint64_t count) {
+            uint32_t flat[kWords];
+            memcpy(flat, block, sizeof(flat));
+            std::copy(flat, flat + count, words.begin() + i);
+        });
+    }
+
+    void stream(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        vec_t block[4];
+        for (uint64_t i = 0; i < n; i += kWords)
+        {
+            gen.next32(block[0], block[1], block[2], block[3]);
+            uint32_t flat[kWords];
+            memcpy(flat, block, sizeof(flat));
+            std::copy(flat, flat + (n - i < kWords ? n - i : kWords), dst + i);
+        }
+    }
+};
+
+/**
+ * The scalar engines, whose stream is operator()
+ */
+template <typename engine_t, typename word_t>
+struct scalar_draw
+{
+    void transform(engine_t &gen, std::vector<uint32_t> &words, uint64_t n) const
+    {
+        gen.generate_transform(n, [&](uint64_t i, word_t word) { words[i] = static_cast<uint32_t>(word); });
+    }
+
+    void stream(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = static_cast<uint32_t>(gen());
+        }
+    }
+};
+
+struct xoshiro_draw : scalar_draw<xoshiro256starstar_engine, uint64_t>
+{
+    void stream(xoshiro256starstar_engine &gen, uint32_t *dst, uint64_t n) const
+    {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = static_cast<uint32_t>(gen.next());
+        }
+    }
+};
+
+void check_generate_transform()
+{
+    const uint64_t sizes[] = {0, 1, 3, 31, 32, 33, 63, 64, 65, 100, 1000, 4099};
+    // the low counter word wraps inside next32_unrolled's blocks
+    at::philox_simd_engine wrapping(5, 0, 4294967295ULL - 12);
+    at::philox_engine started(7, 3, 11);
+    started();
+    started();
+    started();
+    uint64_t seeds[8] = {1, 2, 3, 4, 5, 6, 7, 8}, subsequences[8] = {0, 1, 0, 1, 0, 1, 0, 1}, offsets[8] = {0, 5, 9, 2, 0, 7, 3, 1};
+    for (uint64_t n : sizes)
+    {
+        if (!check_generate_transform_engine("philox_simd_engine", at::philox_simd_engine(9, 2, 4), next32_draw<at::philox_simd_engine>(), n) ||
+            !check_generate_transform_engine("philox_simd_engine near a wrap", wrapping, next32_draw<at::philox_simd_engine>(), n) ||
+            !check_generate_transform_engine("philox_simd_streams_engine", at::philox_simd_streams_engine(seeds, subsequences, offsets),
+                                             next32_draw<at::philox_simd_streams_engine>(), n) ||
+            !check_generate_transform_engine("philox_vec_engine<4>", at::philox_vec_engine<4>(9, 2, 4),
+                                             next32_draw<at::philox_vec_engine<4>>(), n) ||
+            !check_generate_transform_engine("philox_vec_engine<8>", at::philox_vec_engine<8>(9, 2, 4),
+                                             next32_draw<at::philox_vec_engine<8>>(), n) ||
+            !check_generate_transform_engine("philox_vec_engine<16>", at::philox_vec_engine<16>(9, 2, 4),
+                                             next32_draw<at::philox_vec_engine<16>>(), n) ||
+            !check_generate_transform_engine("philox_engine", at::philox_engine(9, 2, 4), scalar_draw<at::philox_engine, uint32_t>(), n) ||
+            !check_generate_transform_engine("philox_engine mid block", started, scalar_draw<at::philox_engine, uint32_t>(), n) ||
+            !check_generate_transform_engine("pcg_engine", at::pcg_engine(9, 2), scalar_draw<at::pcg_engine, uint32_t>(), n) ||
+            !check_generate_transform_engine("mt19937_engine", at::mt19937_engine(9), scalar_draw<at::mt19937_engine, uint32_t>(), n) ||
+            !check_generate_transform_engine("xoshiro256starstar_engine", xoshiro256starstar_engine(9), xoshiro_draw(), n))
+        {
+            return;
+        }
+    }
+    // the values aren't reproducible, only how many there are
+    at::rdrand_engine rdrand;
+    uint64_t calls = 0;
+    rdrand.generate_transform(100, [&](uint64_t i, uint64_t) { calls += i == calls; });
+    if (calls != 100)
+    {
+        printf("rdrand_engine generate_transform(100) made %lu calls\n", static_cast<unsigned long>(calls));
+        return;
+    }
+    printf("OK\n");
+}
+
+/**
+ * fill_bytes of len bytes at an odd address against the words of
+ * reference, and the engine where the words leave it, see
+ * Note [Random bytes]
+ */
+template <typename engine_t, typename word_t, typename next_t>
+static bool check_fill_bytes_engine(const char *name, const engine_t &start, const next_t &next)
+{
+    const uint64_t lengths[] = {0, 1, 3, 4, 5, 7, 8, 9, 127, 128, 129, 255, 256, 257, 383, 1000, 4099};
+    for (uint64_t len : lengths)
+    {
+        engine_t gen = start, reference = start;
+        std::vector<uint8_t> bytes(len + 9, 0xA5), expected(len + 9, 0xA5);
+        gen.fill_bytes(bytes.data() + 1, len);
+        for (uint64_t i = 0; i < len; i += sizeof(word_t))
+        {
+            word_t word = next(reference);
+            memcpy(expected.data() + 1 + i, &word, std::min<uint64_t>(sizeof(word_t), len - i));
+        }
+        if (bytes != expected || next(gen) != next(reference))
+        {
+            printf("%s fill_bytes(%lu) doesn't follow the stream or writes past the end\n", name, static_cast<unsigned long>(len));
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * The words of a vector engine in next32 order
+ */
+template <typename engine_t>
+struct next32_words
+{
+    mutable std::vector<uint32_t> words;
+    mutable uint64_t pos = 0;
+
+    uint32_t operator()(engine_t &gen) const
+    {
+        if (pos == words.size())
+        {
+            words.resize(4 * engine_t::kLanes);
+            typename engine_t::vec_t block[4];
+            gen.next32(block[0], block[1], block[2], block[3]);
+            memcpy(words.data(), block, sizeof(block));
+            pos = 0;
+        }
+        return words[pos++];
+    }
+};
+
+void check_random_bytes()
+{
+    at::philox_simd_engine simd_started(4, 1, 2);
+    at::philox_engine started(4, 1, 2);
+    for (int i = 0; i < 5; i++)
+    {
+        simd_started();
+        started();
+    }
+    auto call = [](at::philox_simd_engine &gen) { return gen(); };
+    auto scalar_call = [](at::philox_engine &gen) { return gen(); };
+    auto pcg_call = [](at::pcg_engine &gen) { return static_cast<uint32_t>(gen()); };
+    auto mt19937_call = [](at::mt19937_engine &gen) { return gen(); };
+    auto xoshiro_call = [](xoshiro256starstar_engine &gen) { return gen.next(); };
+    if (!check_fill_bytes_engine<at::philox_simd_engine, uint32_t>("philox_simd_engine", at::philox_simd_engine(4, 1, 2), call) ||
+        !check_fill_bytes_engine<at::philox_simd_engine, uint32_t>("philox_simd_engine mid block", simd_started, call) ||
+        !check_fill_bytes_engine<at::philox_engine, uint32_t>("philox_engine", at::philox_engine(4, 1, 2), scalar_call) ||
+        !check_fill_bytes_engine<at::philox_engine, uint32_t>("philox_engine mid block", started, scalar_call) ||
+        !check_fill_bytes_engine<at::pcg_engine, uint32_t>("pcg_engine", at::pcg_engine(4, 1), pcg_call) ||
+        !check_fill_bytes_engine<at::mt19937_engine, uint32_t>("mt19937_engine", at::mt19937_engine(4), mt19937_call) ||
+        !check_fill_bytes_engine<xoshiro256starstar_engine, uint64_t>("xoshiro256starstar_engine", xoshiro256starstar_engine(4), xoshiro_call))
+    {
+        return;
+    }
+    // fresh words for every length, the vector engines drop the rest of the last block
+    const uint64_t lengths[] = {0, 1, 5, 63, 64, 65, 200, 1000};
+    for (uint64_t len : lengths)
+    {
+        at::philox_vec_engine<8> gen(4, 1, 2), reference(4, 1, 2);
+        std::vector<uint8_t> bytes(len + 1, 0xA5), expected(len + 1, 0xA5);
+        gen.fill_bytes(bytes.data(), len);
+        next32_words<at::philox_vec_engine<8>> words;
+        for (uint64_t i = 0; i < len; i += 4)
+        {
+            uint32_t word = words(reference);
+            memcpy(expected.data() + i, &word, std::min<uint64_t>(4, len - i));
+        }
+        if (bytes != expected || next32_words<at::philox_vec_engine<8>>()(gen) != next32_words<at::philox_vec_engine<8>>()(reference))
+        {
+            printf("philox_vec_engine<8> fill_bytes(%lu) doesn't follow the stream\n", static_cast<unsigned long>(len));
+            return;
+        }
+    }
+    at::rdrand_engine rdrand;
+    std::vector<uint8_t> bytes(21, 0xA5);
+    rdrand.fill_bytes(bytes.data(), 20);
+    if (bytes[20] != 0xA5)
+    {
+        printf("rdrand_engine fill_bytes(20) writes past the end\n");
+        return;
+    }
+    // random_bits of the engines without operator() gives their next32 words in order
+    at::philox_vec_engine<8> vec_a(6, 1, 2), vec_b(6, 1, 2);
+    at::philox_simd_streams_engine streams_a(6), streams_b(6);
+    std::vector<uint32_t> words(101), expected(128);
+    at::detail::random_bits(vec_a, words.data(), words.size());
+    vec_b.fill_bytes(expected.data(), 4 * words.size());
+    if (memcmp(words.data(), expected.data(), 4 * words.size()) != 0)
+    {
+        printf("random_bits(philox_vec_engine<8>) doesn't follow next32\n");
+        return;
+    }
+    at::detail::random_bits(streams_a, words.data(), words.size());
+    for (uint64_t i = 0; i < expected.size(); i += 32)
+    {
+        __m256i out[4];
+        streams_b.next32(out[0], out[1], out[2], out[3]);
+        memcpy(expected.data() + i, out, sizeof(out));
+    }
+    if (memcmp(words.data(), expected.data(), 4 * words.size()) != 0)
+    {
+        printf("random_bits(philox_simd_streams_engine) doesn't follow next32\n");
+        return;
+    }
+    printf("OK\n");
+}
+
+/**
+ * Binary UUIDs against the words of random_bits, hex UUIDs against the
+ * binary ones formatted by printf, see Note [Batch UUIDv4]
+ */
+void check_uuid()
+{
+    const uint64_t counts[] = {0, 1, 2, 7, 8, 9, 100, 1001};
+    for (uint64_t count : counts)
+    {
+        at::philox_simd_engine binary_gen(3, 0, 5), hex_gen(3, 0, 5), bits_gen(3, 0, 5);
+        std::vector<uint8_t> binary(16 * count + 1, 0xA5);
+        std::vector<char> hex(36 * count + 1, 'Z');
+        std::vector<uint32_t> words(4 * count);
+        at::uuid4_binary(binary_gen, binary.data(), count);
+        at::uuid4_hex(hex_gen, hex.data(), count);
+        at::detail::random_bits(bits_gen, words.data(), words.size());
+        if (binary[16 * count] != 0xA5 || hex[36 * count] != 'Z')
+        {
+            printf("uuid4 of %lu UUIDs writes past the end\n", static_cast<unsigned long>(count));
+            return;
+        }
+        const uint8_t *random = reinterpret_cast<const uint8_t *>(words.data());
+        for (uint64_t k = 0; k < count; k++)
+        {
+            const uint8_t *uuid = binary.data() + 16 * k;
+            for (int b = 0; b < 16; b++)
+            {
+                uint8_t expected = random[16 * k + b];
+                if (b == 6)
+                {
+                    expected = (expected & 0x0F) | 0x40;
+                }
+                else if (b == 8)
+                {
+                    expected = (expected & 0x3F) | 0x80;
+                }
+                if (uuid[b] != expected)
+                {
+                    printf("uuid4_binary byte %d of UUID %lu is 0x%02x instead of 0x%02x\n", b, static_cast<unsigned long>(k), uuid[b], expected);
+                    return;
+                }
+            }
+            char text[37];
+            snprintf(text, sizeof(text), "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x", uuid[0], uuid[1], uuid[2],
+                     uuid[3], uuid[4], uuid[5], uuid[6], uuid[7], uuid[8], uuid[9], uuid[10], uuid[11], uuid[12], uuid[13], uuid[14], uuid[15]);
+            if (memcmp(text, hex.data() + 36 * k, 36) != 0)
+            {
+                printf("uuid4_hex gives %.36s instead of %s\n", hex.data() + 36 * k, text);
+                return;
+            }
+        }
+    }
+    // the version nibble and the variant bits take no other values
+    const uint64_t count = 1 << 16;
+    std::vector<char> hex(36 * count);
+    at::philox_simd_engine gen(8, 0, 0);
+    at::uuid4_hex(gen, hex.data(), count);
+    uint64_t variants[4] = {0, 0, 0, 0};
+    for (uint64_t k = 0; k < count; k++)
+    {
+        const char *text = hex.data() + 36 * k;
+        const char *variant = strchr("89ab", text[19]);
+        if (text[14] != '4' || text[19] == '\0' || variant == nullptr)
+        {
+            printf("uuid4_hex gives %.36s\n", text);
+            return;
+        }
+        variants[variant - "89ab"]++;
+    }
+    for (uint64_t v : variants)
+    {
+        if (std::fabs(v - count / 4.0) > 5 * std::sqrt(count * 3 / 16.0))
+        {
+            printf("uuid4_hex variants are %lu %lu %lu %lu of %lu\n", static_cast<unsigned long>(variants[0]), static_cast<unsigned long>(variants[1]),
+                   static_cast<unsigned long>(variants[2]), static_cast<unsigned long>(variants[3]), static_cast<unsigned long>(count));
+            return;
+        }
+    }
+    printf("OK\n");
+}
+
+std::tuple<double, double, double, double> philox_global_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    at::philox_engine gen1(0, 0, 0);
+    std::mutex mutex;
+    uint64_t step = 128 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t local = 0;
+        at::detail::Array<uint32_t, 4> z;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            z = gen1.next();
+
+            local += z[0];
+            local += z[1];
+            local += z[2];
+            local += z[3];
+        }
+
+        y[thread_idx] = local;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    uint64_t step = 128 / 32;
+    std::vector<at::philox_engine> engines;
+    for (uint64_t i = 0; i < num_threads; ++i) {
+        engines.emplace_back(0, i, 0);
+    }
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t local = 0;
+        at::detail::Array<uint32_t, 4> z;
+        auto &gen1 = engines[thread_idx];
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            z = gen1.next();
+            local += z[0];
+            local += z[1];
+            local += z[2];
+            local += z[3];
+        }
+        y[thread_idx] = local;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+template <int N>
+static std::tuple<double, double, double, double> philox_unrolled_thread_local_instance(std::string name, uint64_t loop_count, uint64_t num_threads)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    uint64_t step = N * 128 / 32;
+    std::vector<at::philox_engine> engines;
+    for (uint64_t i = 0; i < num_threads; ++i) {
+        engines.emplace_back(0, i, 0);
+    }
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t local = 0;
+        at::detail::Array<uint32_t, 4> z[N];
+        auto &gen1 = engines[thread_idx];
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            gen1.next_unrolled<N>(z);
+            for (int u = 0; u < N; u++)
+            {
+                local += z[u][0];
+                local += z[u][1];
+                local += z[u][2];
+                local += z[u][3];
+            }
+        }
+        y[thread_idx] = local;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_x2_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_unrolled_thread_local_instance<2>(name, loop_count, num_threads);
+}
+
+std::tuple<double, double, double, double> philox_x4_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_unrolled_thread_local_instance<4>(name, loop_count, num_threads);
+}
+
+std::tuple<double, double, double, double> philox_simd_global_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    at::philox_simd_engine gen(0, 0, 0);
+    std::mutex mutex;
+    uint64_t step = 1024 / 32;
+
+    __m256i y[num_threads];
+    memset(y, 0, sizeof(y[0]) * num_threads);
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        __m256i a, b, c, d;
+        __m256i v = _mm256_set1_epi32(0);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            gen.next32(a, b, c, d);
+            v = _mm256_add_epi32(v, a);
+            v = _mm256_add_epi32(v, b);
+            v = _mm256_add_epi32(v, c);
+            v = _mm256_add_epi32(v, d);
+        }
+        y[thread_idx] = v;
+    },
+                           num_threads);
+
+    uint32_t x = 0;
+    uint32_t values[8];
+    for (uint64_t j = 0; j < num_threads; ++j)
+    {
+        _mm256_storeu_si256((__m256i *)values, y[j]);
+        for (int i = 0; i < 8; i++)
+        {
+            x += values[i];
+        }
+    }
+
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_simd_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    uint64_t step = 1024 / 32;
+    __m256i y[num_threads];
+    memset(y, 0, sizeof(y[0]) * num_threads);
+    std::vector<at::philox_simd_engine> engines;
+    for (uint64_t i = 0; i < num_threads; ++i)
+    {
+        engines.emplace_back(0, i, 0);
+    }
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        __m256i a, b, c, d;
+        __m256i v = _mm256_set1_epi32(0);
+        auto &gen = engines[thread_idx];
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+           
+            gen.next32(a, b, c, d);
+            v = _mm256_add_epi32(v, a);
+            v = _mm256_add_epi32(v, b);
+            v = _mm256_add_epi32(v, c);
+            v = _mm256_add_epi32(v, d);
+        }
+        y[thread_idx] = v;
+    },
+                           num_threads);
+    uint32_t x = 0;
+    uint32_t values[8];
+    for (uint64_t j = 0; j < num_threads; ++j)
+    {
+        _mm256_storeu_si256((__m256i *)values, y[j]);
+        for (int i = 0; i < 8; i++)
+        {
+            x += values[i];
+        }
+    }
+
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+template <int N>
+static std::tuple<double, double, double, double> philox_simd_unrolled_thread_local_instance(std::string name, uint64_t loop_count, uint64_t num_threads)
+{
+    uint64_t step = N * 1024 / 32;
+    __m256i y[num_threads];
+    memset(y, 0, sizeof(y[0]) * num_threads);
+    std::vector<at::philox_simd_engine> engines;
+    for (uint64_t i = 0; i < num_threads; ++i)
+    {
+        engines.emplace_back(0, i, 0);
+    }
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        __m256i out[N][4];
+        __m256i v = _mm256_set1_epi32(0);
+        auto &gen = engines[thread_idx];
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            gen.next32_unrolled<N>(out);
+            for (int u = 0; u < N; u++)
+            {
+                v = _mm256_add_epi32(v, out[u][0]);
+                v = _mm256_add_epi32(v, out[u][1]);
+                v = _mm256_add_epi32(v, out[u][2]);
+                v = _mm256_add_epi32(v, out[u][3]);
+            }
+        }
+        y[thread_idx] = v;
+    },
+                           num_threads);
+    uint32_t x = 0;
+    uint32_t values[8];
+    for (uint64_t j = 0; j < num_threads; ++j)
+    {
+        _mm256_storeu_si256((__m256i *)values, y[j]);
+        for (int i = 0; i < 8; i++)
+        {
+            x += values[i];
+        }
+    }
+
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_simd_x2_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_simd_unrolled_thread_local_instance<2>(name, loop_count, num_threads);
+}
+
+std::tuple<double, double, double, double> philox_simd_x4_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_simd_unrolled_thread_local_instance<4>(name, loop_count, num_threads);
+}
+
+template <int LANES>
+static std::tuple<double, double, double, double> philox_vec_thread_local_instance(std::string name, uint64_t loop_count, uint64_t num_threads)
+{
+    typedef typename at::philox_vec_engine<LANES>::vec_t vec_t;
+    uint64_t step = LANES * 128 / 32;
+    vec_t y[num_threads];
+    memset(y, 0, sizeof(y[0]) * num_threads);
+    std::vector<at::philox_vec_engine<LANES>> engines;
+    for (uint64_t i = 0; i < num_threads; ++i)
+    {
+        engines.emplace_back(0, i, 0);
+    }
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        vec_t a, b, c, d;
+        vec_t v = {};
+        auto &gen = engines[thread_idx];
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            gen.next32(a, b, c, d);
+            v += a;
+            v += b;
+            v += c;
+            v += d;
+        }
+        y[thread_idx] = v;
+    },
+                           num_threads);
+    uint32_t x = 0;
+    for (uint64_t j = 0; j < num_threads; ++j)
+    {
+        for (int i = 0; i < LANES; i++)
+        {
+            x += y[j][i];
+        }
+    }
+
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_vec4_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_vec_thread_local_instance<4>(name, loop_count, num_threads);
+}
+
+std::tuple<double, double, double, double> philox_vec8_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_vec_thread_local_instance<8>(name, loop_count, num_threads);
+}
+
+std::tuple<double, double, double, double> philox_vec16_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_vec_thread_local_instance<16>(name, loop_count, num_threads);
+}
+
+std::tuple<double, double, double, double> xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint64_t> y(num_threads, 0);
+    xoshiro256starstar_engine gen1(0);
+    std::mutex mutex;
+    uint64_t step = 64 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint64_t z = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            z += gen1.next();
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> at_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint64_t> y(num_threads, 0);
+    at::pcg gen1;
+    std::mutex mutex;
+    uint64_t step = 64 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint64_t z = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            z += gen1();
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    at::mt19937 gen1;
+    std::mutex mutex;
+    uint64_t step = 32 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t z = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            z += gen1();
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    std::mt19937 gen1;
+    std::mutex mutex;
+    uint64_t step = 32 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t z = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        {
+            z = gen1();
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> xoshiro256_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint64_t> y(num_threads, 0);
+    xoshiro256starstar_engine gen1(0);
+    std::mutex mutex;
+    uint64_t step = 64 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint64_t z = 0;
+        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(int k = 0; k < 1<<20; k++)
+            { 
+                z += gen1.next();
+            }
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> at_pcg_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint64_t> y(num_threads, 0);
+    at::pcg gen1;
+    std::mutex mutex;
+    uint64_t step = 64 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint64_t z = 0;
+        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(int k = 0; k < 1<<20; k++)
+            {
+                z += gen1();
+            }
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> at_mt19937_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    at::mt19937 gen1;
+    std::mutex mutex;
+    uint64_t step = 32 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t z = 0;
+        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(int k = 0; k < 1<<20; k++)
+            {
+                z += gen1();
+            }
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> std_mt19937_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    std::mt19937 gen1;
+    std::mutex mutex;
+    uint64_t step = 32 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t z = 0;
+        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(int k = 0; k < 1<<20; k++)
+            {
+                z = gen1();
+            }
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_global_instance_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> y(num_threads, 0);
+    at::philox_engine gen1(0, 0, 0);
+    std::mutex mutex;
+    uint64_t step = 128 / 32;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t local = 0;
+        at::detail::Array<uint32_t, 4> z;
+        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(int k = 0; k < 1<<20; k++)
+            {
+                z = gen1.next();
+
+                local += z[0];
+                local += z[1];
+                local += z[2];
+                local += z[3];
+            }
+        }
+
+        y[thread_idx] = local;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_simd_global_instance_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    at::philox_simd_engine gen(0, 0, 0);
+    std::mutex mutex;
+    uint64_t step = 1024 / 32;
+
+    __m256i y[num_threads];
+    memset(y, 0, sizeof(y[0]) * num_threads);
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        __m256i a, b, c, d;
+        __m256i v = _mm256_set1_epi32(0);
+        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(int k = 0; k < 1<<20; k++)
+            {
+                gen.next32(a, b, c, d);
+                v = _mm256_add_epi32(v, a);
+                v = _mm256_add_epi32(v, b);
+                v = _mm256_add_epi32(v, c);
+                v = _mm256_add_epi32(v, d);
+            }
+        }
+        y[thread_idx] = v;
+    },
+                           num_threads);
+
+    uint32_t x = 0;
+    uint32_t values[8];
+    for (uint64_t j = 0; j < num_threads; ++j)
+    {
+        _mm256_storeu_si256((__m256i *)values, y[j]);
+        for (int i = 0; i < 8; i++)
+        {
+            x += values[i];
+        }
+    }
+
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    // every stream has its own seed and offset and only STREAM_DRAWS randoms are drawn from it
+    std::vector<uint32_t> y(num_threads, 0);
+    uint64_t step = 128 / 32;
+    uint64_t streams_per_thread = loop_count / num_threads / STREAM_DRAWS;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint32_t local = 0;
+        at::detail::Array<uint32_t, 4> z;
+        uint64_t first = thread_idx * streams_per_thread;
+        for (uint64_t s = first; s < first + streams_per_thread; s++)
+        {
+            at::philox_engine gen1(s, 0, s);
+            for (uint64_t i = 0; i < STREAM_DRAWS; i += step)
+            {
+                z = gen1.next();
+                local += z[0];
+                local += z[1];
+                local += z[2];
+                local += z[3];
+            }
+        }
+        y[thread_idx] = local;
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    // same streams as philox_streams, eight of them in flight per engine
+    uint64_t step = 128 / 32;
+    uint64_t streams_per_thread = loop_count / num_threads / STREAM_DRAWS;
+    __m256i y[num_threads];
+    memset(y, 0, sizeof(y[0]) * num_threads);
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        __m256i a, b, c, d;
+        __m256i v = _mm256_set1_epi32(0);
+        at::philox_simd_streams_engine gen;
+        uint64_t first = thread_idx * streams_per_thread;
+        uint64_t last = first + streams_per_thread;
+        for (uint64_t s = first; s < last; s += at::philox_simd_streams_engine::kLanes)
+        {
+            int lanes = std::min<uint64_t>(at::philox_simd_streams_engine::kLanes, last - s);
+            for (int lane = 0; lane < lanes; lane++)
+            {
+                gen.set_stream(lane, s + lane, 0, s + lane);
+            }
+            __m256i keep = _mm256_cmpgt_epi32(_mm256_set1_epi32(lanes), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+            for (uint64_t i = 0; i < STREAM_DRAWS; i += step)
+            {
+                gen.next32(a, b, c, d);
+                // lanes past the last stream of this thread carry stale streams
+                a = _mm256_and_si256(a, keep);
+                b = _mm256_and_si256(b, keep);
+                c = _mm256_and_si256(c, keep);
+                d = _mm256_and_si256(d, keep);
+                v = _mm256_add_epi32(v, a);
+                v = _mm256_add_epi32(v, b);
+                v = _mm256_add_epi32(v, c);
+                v = _mm256_add_epi32(v, d);
+            }
+        }
+        y[thread_idx] = v;
+    },
+                           num_threads);
+    uint32_t x = 0;
+    uint32_t values[8];
+    for (uint64_t j = 0; j < num_threads; ++j)
+    {
+        _mm256_storeu_si256((__m256i *)values, y[j]);
+        for (int i = 0; i < 8; i++)
+        {
+            x += values[i];
+        }
+    }
+
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    return bench;
+}
+
+// grid of a PyTorch distribution kernel on an 80 SM GPU: 256 threads per block, 8 blocks per SM
+const at::philox_cuda_launch CUDA_LAUNCH = {640, 256};
+
+/**
+ * Fills loop_count elements the way a CUDA kernel with CUDA_LAUNCH would,
+ * every host thread taking an equal share of the CUDA threads.
+ */
+template <typename fill_t>
+static std::tuple<double, double, double, double> philox_cuda(std::string name, uint64_t loop_count, uint64_t num_threads, const fill_t &fill)
+{
+    // 15 spare elements so that out can start on a 64-byte boundary
+    std::vector<uint32_t> buffer(loop_count + 15);
+    uint32_t *out = reinterpret_cast<uint32_t *>((reinterpret_cast<uintptr_t>(buffer.data()) + 63) & ~uintptr_t(63));
+    uint64_t cuda_threads = CUDA_LAUNCH.threads();
+    // element e belongs to CUDA thread e % CUDA_LAUNCH.threads(), so shares of
+    // multiples of 16 CUDA threads are whole cache lines of out and host threads
+    // never share one
+    uint64_t per_thread = ((cuda_threads + num_threads - 1) / num_threads + 15) & ~15ULL;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint64_t first = std::min(thread_idx * per_thread, cuda_threads);
+        uint64_t last = std::min(first + per_thread, cuda_threads);
+        fill(out, loop_count, 67280421310721ULL, 0, CUDA_LAUNCH, first, last);
+    },
+                           num_threads);
+    uint32_t x = std::accumulate(out, out + loop_count, 0U);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << loop_count * sizeof(uint32_t) / std::get<2>(bench) / 1e9 << " GB/s" << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> philox_cuda_layout(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_cuda(name, loop_count, num_threads, [](uint32_t *dst, uint64_t numel, uint64_t seed, uint64_t offset,
+                                                         const at::philox_cuda_launch &launch, uint64_t first, uint64_t last) {
+        at::philox_cuda_fill(dst, numel, seed, offset, launch, first, last);
+    });
+}
+
+std::tuple<double, double, double, double> philox_cuda_layout_reference(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return philox_cuda(name, loop_count, num_threads, philox_cuda_fill_reference);
+}
+
+/**
+ * Fill functors for the real-valued benchmarks: fill(gen, dst, n) writes n reals to dst
+ */
+struct uniform_fill
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::uniform_float(gen, dst, n);
+    }
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, double *dst, uint64_t n) const
+    {
+        at::uniform_double(gen, dst, n);
+    }
+};
+
+struct box_muller_fill
+{
+    void operator()(at::philox_simd_engine &gen, float *dst, uint64_t n) const
+    {
+        at::normal_float(gen, dst, n);
+    }
+
+    void operator()(at::philox_simd_engine &gen, double *dst, uint64_t n) const
+    {
+        at::normal_double(gen, dst, n);
+    }
+};
+
+struct ziggurat_normal_fill
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::ziggurat_normal(gen, dst, n);
+    }
+};
+
+struct ziggurat_exponential_fill
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::ziggurat_exponential(gen, dst, n);
+    }
+};
+
+template <template <typename> class distribution_t>
+struct std_fill
+{
+    template <typename engine_t, typename real_t>
+    void operator()(engine_t &gen, real_t *dst, uint64_t n) const
+    {
+        distribution_t<real_t> dist;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = dist(gen);
+        }
+    }
+};
+
+struct uniform_int_fill
+{
+    uint32_t n;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t count) const
+    {
+        at::uniform_int(gen, dst, count, n);
+    }
+};
+
+struct std_uniform_int_fill
+{
+    uint32_t n;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t count) const
+    {
+        std::uniform_int_distribution<uint32_t> dist(0, n - 1);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            dst[i] = dist(gen);
+        }
+    }
+};
+
+struct bernoulli_bits_fill
+{
+    double p;
+
+    /**
+     * n mask elements packed into the first (n + 31) / 32 words of dst
+     */
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        at::bernoulli_bits(gen, dst, n, p);
+    }
+};
+
+struct bernoulli_fill
+{
+    double p;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint8_t *dst, uint64_t n) const
+    {
+        at::bernoulli_bytes(gen, dst, n, p);
+    }
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::bernoulli_float(gen, dst, n, p, static_cast<float>(1 / (1 - p)));
+    }
+};
+
+/**
+ * One 32-bit word and one compare per element
+ */
+struct naive_bernoulli_fill
+{
+    double p;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint8_t *dst, uint64_t n) const
+    {
+        const uint32_t threshold = static_cast<uint32_t>(std::llround(p * 4294967296.0));
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = at::detail::random_word(gen) < threshold;
+        }
+    }
+};
+
+struct std_bernoulli_fill
+{
+    double p;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint8_t *dst, uint64_t n) const
+    {
+        std::bernoulli_distribution dist(p);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = dist(gen);
+        }
+    }
+};
+
+/**
+ * Fills a per-thread buffer of UNIFORM_BUFFER values over and over until
+ * loop_count of them have been written, engines come from make_engine(thread_idx)
+ */
+template <typename value_t, typename make_engine_t, typename fill_t>
+static std::tuple<double, double, double, double> fill_values(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                              const make_engine_t &make_engine, const fill_t &fill, const char *unit)
+{
+    std::vector<double> y(num_threads, 0);
+    uint64_t per_thread = loop_count / num_threads;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        auto gen = make_engine(thread_idx);
+        std::vector<value_t> buffer(UNIFORM_BUFFER);
+        double z = 0;
+        for (uint64_t i = 0; i < per_thread; i += UNIFORM_BUFFER)
+        {
+            uint64_t count = std::min<uint64_t>(UNIFORM_BUFFER, per_thread - i);
+            fill(gen, buffer.data(), count);
+            z += buffer[0];
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    double x = std::accumulate(y.begin(), y.end(), 0.0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << per_thread / std::get<0>(bench) << " " << unit << "/s per thread" << std::endl;
+    return bench;
+}
+
+template <typename real_t, typename make_engine_t, typename fill_t>
+static std::tuple<double, double, double, double> fill_real(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                            const make_engine_t &make_engine, const fill_t &fill)
+{
+    return fill_values<real_t>(name, loop_count, num_threads, make_engine, fill, "reals");
+}
+
+static at::philox_simd_engine make_philox_simd(uint64_t thread_idx)
+{
+    return at::philox_simd_engine(0, thread_idx, 0);
+}
+
+static at::philox_engine make_philox(uint64_t thread_idx)
+{
+    return at::philox_engine(0, thread_idx, 0);
+}
+
+static xoshiro256starstar_engine make_xoshiro256(uint64_t thread_idx)
+{
+    return xoshiro256starstar_engine(thread_idx);
+}
+
+static at::pcg_engine make_pcg(uint64_t thread_idx)
+{
+    return at::pcg_engine(0x853c49e6748fea9bULL, thread_idx);
+}
+
+static std::mt19937 make_std_mt19937(uint64_t thread_idx)
+{
+    return std::mt19937(thread_idx);
+}
+
+static at::mt19937 make_at_mt19937(uint64_t thread_idx)
+{
+    return at::mt19937(thread_idx);
+}
+
+static at::rdrand_engine make_rdrand(uint64_t)
+{
+    return at::rdrand_engine();
+}
+
+/**
+ * Lane l of thread t's streams engine is subsequence 8 t + l of seed 0
+ */
+static at::philox_simd_streams_engine make_philox_simd_streams(uint64_t thread_idx)
+{
+    uint64_t seeds[at::philox_simd_streams_engine::kLanes] = {};
+    uint64_t subsequences[at::philox_simd_streams_engine::kLanes];
+    uint64_t offsets[at::philox_simd_streams_engine::kLanes] = {};
+    for (int l = 0; l < at::philox_simd_streams_engine::kLanes; l++)
+    {
+        subsequences[l] = thread_idx * at::philox_simd_streams_engine::kLanes + l;
+    }
+    return at::philox_simd_streams_engine(seeds, subsequences, offsets);
+}
+
+static at::philox_vec_engine<8> make_philox_vec8(uint64_t thread_idx)
+{
+    return at::philox_vec_engine<8>(0, thread_idx, 0);
+}
+
+/**
+ * The same engines wrapped for std:: distributions
+ */
+template <typename engine_t, engine_t (*make_engine)(uint64_t)>
+static at::urbg32<engine_t> make_urbg32(uint64_t thread_idx)
+{
+    return at::urbg32<engine_t>(make_engine(thread_idx));
+}
+
+std::tuple<double, double, double, double> uniform_float_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_philox_simd, uniform_fill());
+}
+
+std::tuple<double, double, double, double> uniform_float_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_xoshiro256, uniform_fill());
+}
+
+std::tuple<double, double, double, double> uniform_float_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_pcg, uniform_fill());
+}
+
+std::tuple<double, double, double, double> uniform_float_std(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_std_mt19937, std_fill<std::uniform_real_distribution>());
+}
+
+std::tuple<double, double, double, double> uniform_double_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<double>(name, loop_count, num_threads, make_philox_simd, uniform_fill());
+}
+
+std::tuple<double, double, double, double> uniform_double_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<double>(name, loop_count, num_threads, make_xoshiro256, uniform_fill());
+}
+
+std::tuple<double, double, double, double> uniform_double_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<double>(name, loop_count, num_threads, make_pcg, uniform_fill());
+}
+
+std::tuple<double, double, double, double> normal_float_box_muller(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_philox_simd, box_muller_fill());
+}
+
+std::tuple<double, double, double, double> normal_double_box_muller(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<double>(name, loop_count, num_threads, make_philox_simd, box_muller_fill());
+}
+
+std::tuple<double, double, double, double> std_normal_float_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>, std_fill<std::normal_distribution>());
+}
+
+std::tuple<double, double, double, double> std_normal_float_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_urbg32<at::philox_engine, make_philox>, std_fill<std::normal_distribution>());
+}
+
+std::tuple<double, double, double, double> std_normal_float_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_urbg32<xoshiro256starstar_engine, make_xoshiro256>, std_fill<std::normal_distribution>());
+}
+
+std::tuple<double, double, double, double> std_normal_float_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_urbg32<at::pcg_engine, make_pcg>, std_fill<std::normal_distribution>());
+}
+
+std::tuple<double, double, double, double> std_normal_float_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_std_mt19937, std_fill<std::normal_distribution>());
+}
+
+std::tuple<double, double, double, double> normal_float_ziggurat_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_philox_simd, ziggurat_normal_fill());
+}
+
+std::tuple<double, double, double, double> normal_float_ziggurat_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_xoshiro256, ziggurat_normal_fill());
+}
+
+std::tuple<double, double, double, double> normal_float_ziggurat_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_pcg, ziggurat_normal_fill());
+}
+
+std::tuple<double, double, double, double> exponential_float_ziggurat_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_philox_simd, ziggurat_exponential_fill());
+}
+
+std::tuple<double, double, double, double> exponential_float_ziggurat_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_xoshiro256, ziggurat_exponential_fill());
+}
+
+std::tuple<double, double, double, double> std_exponential_float_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_real<float>(name, loop_count, num_threads, make_std_mt19937, std_fill<std::exponential_distribution>());
+}
+
+std::tuple<double, double, double, double> uniform_int_6_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, uniform_int_fill{6}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_6_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, uniform_int_fill{6}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_6_std_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>, std_uniform_int_fill{6}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_6_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_uniform_int_fill{6}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_65536_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, uniform_int_fill{65536}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_65536_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, uniform_int_fill{65536}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_65536_std_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>, std_uniform_int_fill{65536}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_65536_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_uniform_int_fill{65536}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_1e9_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, uniform_int_fill{1000000000}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_1e9_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, uniform_int_fill{1000000000}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_1e9_std_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>, std_uniform_int_fill{1000000000}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_1e9_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_uniform_int_fill{1000000000}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, uniform_int_fill{2147483649U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, uniform_int_fill{2147483649U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_std_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>, std_uniform_int_fill{2147483649U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow31_plus_1_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_uniform_int_fill{2147483649U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, uniform_int_fill{4294967295U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, uniform_int_fill{4294967295U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_std_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>, std_uniform_int_fill{4294967295U}, "integers");
+}
+
+std::tuple<double, double, double, double> uniform_int_2pow32_minus_1_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_uniform_int_fill{4294967295U}, "integers");
+}
+
+std::tuple<double, double, double, double> bernoulli_bits_half_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, bernoulli_bits_fill{0.5}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_bits_tenth_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, bernoulli_bits_fill{0.1}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_bits_tenth_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, bernoulli_bits_fill{0.1}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_bytes_half_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_philox_simd, bernoulli_fill{0.5}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_bytes_tenth_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_philox_simd, bernoulli_fill{0.1}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_float_tenth_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, bernoulli_fill{0.1}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_bytes_tenth_naive_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_philox_simd, naive_bernoulli_fill{0.1}, "mask elements");
+}
+
+std::tuple<double, double, double, double> bernoulli_bytes_tenth_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_std_mt19937, std_bernoulli_fill{0.1}, "mask elements");
+}
+
+/**
+ * Indices of the ones of a mask, from a packed mask and a scan of its set bits
+ */
+struct dense_indices
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint64_t n, double p, std::vector<uint64_t> &indices, std::vector<uint32_t> &bits) const
+    {
+        at::bernoulli_bits(gen, bits.data(), n, p);
+        indices.clear();
+        for (uint64_t k = 0; k < bits.size(); k++)
+        {
+            for (uint32_t word = bits[k]; word; word &= word - 1)
+            {
+                indices.push_back(32 * k + __builtin_ctz(word));
+            }
+        }
+    }
+};
+
+struct geometric_indices
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint64_t n, double p, std::vector<uint64_t> &indices, std::vector<uint32_t> &) const
+    {
+        at::bernoulli_indices(gen, n, p, indices);
+    }
+};
+
+/**
+ * Selects from masks of size elements over and over until loop_count mask
+ * elements have been covered
+ */
+template <typename make_engine_t, typename select_t>
+static std::tuple<double, double, double, double> bernoulli_indices_size(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                                         const make_engine_t &make_engine, const select_t &select,
+                                                                         double p, uint64_t size)
+{
+    std::vector<double> y(num_threads, 0);
+    uint64_t per_thread = loop_count / num_threads;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        auto gen = make_engine(thread_idx);
+        std::vector<uint64_t> indices;
+        std::vector<uint32_t> bits((size + 31) / 32);
+        double z = 0;
+        for (uint64_t i = 0; i < per_thread; i += size)
+        {
+            select(gen, size, p, indices, bits);
+            z += indices.size();
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    double x = std::accumulate(y.begin(), y.end(), 0.0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << per_thread / std::get<0>(bench) << " mask elements/s per thread" << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow12_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.001, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow12_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.001, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow20_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.001, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_001_2pow20_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.001, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow12_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.01, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow12_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.01, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow20_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.01, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow20_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.01, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow12_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.05, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow12_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.05, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow20_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.05, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_05_2pow20_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.05, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow12_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.2, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow12_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.2, 1 << 12);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow20_geometric(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, geometric_indices(), 0.2, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_2_2pow20_dense(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_philox_simd, dense_indices(), 0.2, 1 << 20);
+}
+
+std::tuple<double, double, double, double> bernoulli_indices_0_01_2pow20_geometric_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return bernoulli_indices_size(name, loop_count, num_threads, make_xoshiro256, geometric_indices(), 0.01, 1 << 20);
+}
+
+struct alias_fill
+{
+    const at::alias_table *table;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t count) const
+    {
+        table->sample(gen, dst, count);
+    }
+};
+
+/**
+ * Binary search of uniform doubles in the cumulative distribution
+ */
+struct binary_search_fill
+{
+    const std::vector<double> *cdf;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t count) const
+    {
+        double u[at::kUniformBatch];
+        for (uint64_t i = 0; i < count; i += at::kUniformBatch)
+        {
+            uint64_t batch = std::min<uint64_t>(at::kUniformBatch, count - i);
+            at::uniform_double(gen, u, batch);
+            for (uint64_t j = 0; j < batch; j++)
+            {
+                dst[i + j] = std::upper_bound(cdf->begin(), cdf->end(), u[j]) - cdf->begin();
+            }
+        }
+    }
+};
+
+struct std_discrete_fill
+{
+    std::discrete_distribution<uint32_t>::param_type param;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t count) const
+    {
+        std::discrete_distribution<uint32_t> dist;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            dst[i] = dist(gen, param);
+        }
+    }
+};
+
+/**
+ * Samples from n categories with Zipf weights 1 / (k + 1), the alias table
+ * is built before timing starts
+ */
+template <typename make_engine_t>
+static std::tuple<double, double, double, double> weighted_alias(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                                 const make_engine_t &make_engine, uint32_t n)
+{
+    at::alias_table table(zipf_weights(n));
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_engine, alias_fill{&table}, "samples");
+}
+
+template <typename make_engine_t>
+static std::tuple<double, double, double, double> weighted_binary_search(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                                         const make_engine_t &make_engine, uint32_t n)
+{
+    std::vector<double> weights = zipf_weights(n);
+    std::vector<double> cdf(n);
+    std::partial_sum(weights.begin(), weights.end(), cdf.begin());
+    double total = cdf.back();
+    for (double &c : cdf)
+    {
+        c /= total;
+    }
+    // u < 1 then always lands in one of the n categories
+    cdf.back() = 1.0;
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_engine, binary_search_fill{&cdf}, "samples");
+}
+
+template <typename make_engine_t>
+static std::tuple<double, double, double, double> weighted_std_discrete(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                                        const make_engine_t &make_engine, uint32_t n)
+{
+    std::vector<double> weights = zipf_weights(n);
+    std_discrete_fill fill{std::discrete_distribution<uint32_t>::param_type(weights.begin(), weights.end())};
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_engine, fill, "samples");
+}
+
+std::tuple<double, double, double, double> weighted_1e3_alias_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_alias(name, loop_count, num_threads, make_philox_simd, 1000);
+}
+
+std::tuple<double, double, double, double> weighted_1e3_alias_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_alias(name, loop_count, num_threads, make_xoshiro256, 1000);
+}
+
+std::tuple<double, double, double, double> weighted_1e3_binary_search_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_binary_search(name, loop_count, num_threads, make_philox_simd, 1000);
+}
+
+std::tuple<double, double, double, double> weighted_1e3_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_std_discrete(name, loop_count, num_threads, make_std_mt19937, 1000);
+}
+
+std::tuple<double, double, double, double> weighted_1e6_alias_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_alias(name, loop_count, num_threads, make_philox_simd, 1000000);
+}
+
+std::tuple<double, double, double, double> weighted_1e6_alias_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_alias(name, loop_count, num_threads, make_xoshiro256, 1000000);
+}
+
+std::tuple<double, double, double, double> weighted_1e6_binary_search_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_binary_search(name, loop_count, num_threads, make_philox_simd, 1000000);
+}
+
+std::tuple<double, double, double, double> weighted_1e6_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return weighted_std_discrete(name, loop_count, num_threads, make_std_mt19937, 1000000);
+}
+
+/**
+ * Permutes loop_count elements once per trial. randperm and shuffle start
+ * their own threads, so the harness runs them from one thread and passes
+ * num_threads on.
+ */
+template <typename shuffle_t>
+static std::tuple<double, double, double, double> shuffle_elements(std::string name, uint64_t loop_count, const shuffle_t &shuffle)
+{
+    std::vector<uint32_t> data(loop_count);
+    std::iota(data.begin(), data.end(), 0);
+    auto bench = benchmark(name, loop_count, [&](uint64_t) { shuffle(data.data(), loop_count); }, 1);
+    std::cout << "Accumulated Y value is " << data[0] << std::endl;
+    std::cout << name << ": " << loop_count / std::get<0>(bench) << " elements/s" << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> randperm_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return shuffle_elements(name, loop_count, [&](uint32_t *data, uint64_t n) { at::randperm(data, n, 0, num_threads); });
+}
+
+std::tuple<double, double, double, double> shuffle_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return shuffle_elements(name, loop_count, [&](uint32_t *data, uint64_t n) { at::shuffle(data, n, 0, num_threads); });
+}
+
+std::tuple<double, double, double, double> std_shuffle_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t = 1)
+{
+    at::urbg32<at::philox_simd_engine> gen(make_philox_simd(0));
+    return shuffle_elements(name, loop_count, [&](uint32_t *data, uint64_t n) { std::shuffle(data, data + n, gen); });
+}
+
+std::tuple<double, double, double, double> std_shuffle_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t = 1)
+{
+    std::mt19937 gen(0);
+    return shuffle_elements(name, loop_count, [&](uint32_t *data, uint64_t n) { std::shuffle(data, data + n, gen); });
+}
+
+struct gamma_fill
+{
+    float alpha;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::gamma_float(gen, dst, n, alpha);
+    }
+};
+
+struct poisson_fill
+{
+    double lambda;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        at::poisson(gen, dst, n, lambda);
+    }
+};
+
+struct binomial_fill
+{
+    uint32_t trials;
+    double p;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        at::binomial(gen, dst, n, trials, p);
+    }
+};
+
+struct std_gamma_fill
+{
+    float alpha;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        std::gamma_distribution<float> dist(alpha);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = dist(gen);
+        }
+    }
+};
+
+struct std_poisson_fill
+{
+    double lambda;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        std::poisson_distribution<uint32_t> dist(lambda);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = dist(gen);
+        }
+    }
+};
+
+struct std_binomial_fill
+{
+    uint32_t trials;
+    double p;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        std::binomial_distribution<uint32_t> dist(trials, p);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            dst[i] = dist(gen);
+        }
+    }
+};
+
+std::tuple<double, double, double, double> gamma_0_5_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, gamma_fill{0.5f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_0_5_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_xoshiro256, gamma_fill{0.5f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_0_5_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_std_mt19937, std_gamma_fill{0.5f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_2_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, gamma_fill{2.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_2_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_xoshiro256, gamma_fill{2.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_2_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_std_mt19937, std_gamma_fill{2.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_20_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, gamma_fill{20.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_20_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_xoshiro256, gamma_fill{20.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> gamma_20_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_std_mt19937, std_gamma_fill{20.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_4_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, poisson_fill{4.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_4_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, poisson_fill{4.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_4_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_poisson_fill{4.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_100_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, poisson_fill{100.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_100_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, poisson_fill{100.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_100_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_poisson_fill{100.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_1e5_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, poisson_fill{100000.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_1e5_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, poisson_fill{100000.0}, "samples");
+}
+
+std::tuple<double, double, double, double> poisson_1e5_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_poisson_fill{100000.0}, "samples");
+}
+
+std::tuple<double, double, double, double> binomial_20_0_2_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, binomial_fill{20, 0.2}, "samples");
+}
+
+std::tuple<double, double, double, double> binomial_20_0_2_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, binomial_fill{20, 0.2}, "samples");
+}
+
+std::tuple<double, double, double, double> binomial_20_0_2_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_binomial_fill{20, 0.2}, "samples");
+}
+
+std::tuple<double, double, double, double> binomial_1000_0_4_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_philox_simd, binomial_fill{1000, 0.4}, "samples");
+}
+
+std::tuple<double, double, double, double> binomial_1000_0_4_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_xoshiro256, binomial_fill{1000, 0.4}, "samples");
+}
+
+std::tuple<double, double, double, double> binomial_1000_0_4_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint32_t>(name, loop_count, num_threads, make_std_mt19937, std_binomial_fill{1000, 0.4}, "samples");
+}
+
+struct truncated_normal_fill
+{
+    float mean, stddev, a, b;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::truncated_normal_float(gen, dst, n, mean, stddev, a, b);
+    }
+};
+
+/**
+ * Redraws a scalar normal until it lands in [a, b]
+ */
+struct rejection_truncated_normal_fill
+{
+    float mean, stddev, a, b;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        std::normal_distribution<float> dist(mean, stddev);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            float x;
+            do
+            {
+                x = dist(gen);
+            } while (!(x >= a && x <= b));
+            dst[i] = x;
+        }
+    }
+};
+
+// (mean, stddev, a, b): the default of trunc_normal_, a typical transformer
+// init, a one-sided interval and the tail beyond 3 stddev
+static const truncated_normal_fill truncated_2sigma{0.0f, 1.0f, -2.0f, 2.0f};
+static const truncated_normal_fill truncated_init{0.0f, 0.02f, -0.04f, 0.04f};
+static const truncated_normal_fill truncated_one_sided{0.0f, 1.0f, 1.0f, 3.0f};
+static const truncated_normal_fill truncated_tail{0.0f, 1.0f, 3.0f, INFINITY};
+
+std::tuple<double, double, double, double> truncated_normal_2sigma_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, truncated_2sigma, "samples");
+}
+
+std::tuple<double, double, double, double> truncated_normal_init_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, truncated_init, "samples");
+}
+
+std::tuple<double, double, double, double> truncated_normal_one_sided_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, truncated_one_sided, "samples");
+}
+
+std::tuple<double, double, double, double> truncated_normal_tail_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, truncated_tail, "samples");
+}
+
+std::tuple<double, double, double, double> truncated_normal_2sigma_rejection_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_urbg32<at::philox_simd_engine, make_philox_simd>,
+                              rejection_truncated_normal_fill{0.0f, 1.0f, -2.0f, 2.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> truncated_normal_2sigma_rejection_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_std_mt19937, rejection_truncated_normal_fill{0.0f, 1.0f, -2.0f, 2.0f}, "samples");
+}
+
+std::tuple<double, double, double, double> truncated_normal_one_sided_rejection_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_std_mt19937, rejection_truncated_normal_fill{0.0f, 1.0f, 1.0f, 3.0f}, "samples");
+}
+
+/**
+ * One seeded call filling all loop_count samples on num_threads threads,
+ * see Note [Truncated normals]
+ */
+std::tuple<double, double, double, double> truncated_normal_2sigma_seeded(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<float> data(loop_count);
+    auto bench = benchmark(name, loop_count, [&](uint64_t) { at::truncated_normal_float(data.data(), loop_count, 0, 0.0f, 1.0f, -2.0f, 2.0f, num_threads); }, 1);
+    std::cout << "Accumulated Y value is " << data[0] << std::endl;
+    std::cout << name << ": " << loop_count / std::get<0>(bench) << " samples/s" << std::endl;
+    return bench;
+}
+
+/**
+ * fill_values, also reporting the output written in GB/s
+ */
+template <typename value_t, typename make_engine_t, typename fill_t>
+static std::tuple<double, double, double, double> fill_bandwidth(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                                 const make_engine_t &make_engine, const fill_t &fill)
+{
+    auto bench = fill_values<value_t>(name, loop_count, num_threads, make_engine, fill, "values");
+    std::cout << name << ": " << (loop_count / num_threads) * sizeof(value_t) / std::get<0>(bench) / 1e9 << " GB/s per thread" << std::endl;
+    return bench;
+}
+
+template <typename format_t>
+struct uniform_16_fill
+{
+    void operator()(at::philox_simd_engine &gen, uint16_t *dst, uint64_t n) const
+    {
+        at::detail::uniform_16<format_t>(gen, dst, n, 0.0f, 1.0f, at::uniform_interval::closed_open);
+    }
+};
+
+template <typename format_t>
+struct normal_16_fill
+{
+    void operator()(at::philox_simd_engine &gen, uint16_t *dst, uint64_t n) const
+    {
+        at::detail::normal_16<format_t>(gen, dst, n, 0.0f, 1.0f);
+    }
+};
+
+/**
+ * float32 output converted in a second pass, what the direct fills replace
+ */
+template <typename format_t, typename fill_t>
+struct two_pass_16_fill
+{
+    fill_t fill;
+
+    void operator()(at::philox_simd_engine &gen, uint16_t *dst, uint64_t n) const
+    {
+        static thread_local std::vector<float> scratch;
+        scratch.resize(n);
+        fill(gen, scratch.data(), n);
+        uint64_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            _mm_storeu_si128((__m128i *)(dst + i), format_t::convert8(_mm256_loadu_ps(scratch.data() + i)));
+        }
+        for (; i < n; i++)
+        {
+            dst[i] = format_t::from_float(scratch[i]);
+        }
+    }
+};
+
+std::tuple<double, double, double, double> uniform_half_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, uniform_16_fill<at::detail::half_format>());
+}
+
+std::tuple<double, double, double, double> uniform_half_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, two_pass_16_fill<at::detail::half_format, uniform_fill>());
+}
+
+std::tuple<double, double, double, double> uniform_bfloat16_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, uniform_16_fill<at::detail::bfloat16_format>());
+}
+
+std::tuple<double, double, double, double> uniform_bfloat16_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, two_pass_16_fill<at::detail::bfloat16_format, uniform_fill>());
+}
+
+std::tuple<double, double, double, double> uniform_float32_bandwidth_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<float>(name, loop_count, num_threads, make_philox_simd, uniform_fill());
+}
+
+std::tuple<double, double, double, double> normal_half_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, normal_16_fill<at::detail::half_format>());
+}
+
+std::tuple<double, double, double, double> normal_half_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, two_pass_16_fill<at::detail::half_format, box_muller_fill>());
+}
+
+std::tuple<double, double, double, double> normal_bfloat16_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, normal_16_fill<at::detail::bfloat16_format>());
+}
+
+std::tuple<double, double, double, double> normal_bfloat16_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<uint16_t>(name, loop_count, num_threads, make_philox_simd, two_pass_16_fill<at::detail::bfloat16_format, box_muller_fill>());
+}
+
+std::tuple<double, double, double, double> normal_float32_bandwidth_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_bandwidth<float>(name, loop_count, num_threads, make_philox_simd, box_muller_fill());
+}
+
+/**
+ * Rounds a per-thread buffer of UNIFORM_BUFFER floats over and over until
+ * loop_count of them have been rounded, each thread its own part of the
+ * stream of seed 0, see Note [Stochastic rounding]
+ */
+template <typename out_t, typename round_t>
+static std::tuple<double, double, double, double> round_values(std::string name, uint64_t loop_count, uint64_t num_threads, const round_t &round)
+{
+    std::vector<double> y(num_threads, 0);
+    uint64_t per_thread = loop_count / num_threads;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        std::vector<float> src(UNIFORM_BUFFER);
+        std::mt19937 mt(thread_idx);
+        std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+        for (float &x : src)
+        {
+            x = dist(mt);
+        }
+        std::vector<out_t> dst(UNIFORM_BUFFER);
+        double z = 0;
+        for (uint64_t i = 0; i < per_thread; i += UNIFORM_BUFFER)
+        {
+            uint64_t count = std::min<uint64_t>(UNIFORM_BUFFER, per_thread - i);
+            round(src.data(), dst.data(), count, thread_idx * per_thread + i);
+            z += dst[0];
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    double x = std::accumulate(y.begin(), y.end(), 0.0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << per_thread / std::get<0>(bench) << " values/s per thread" << std::endl;
+    return bench;
+}
+
+struct stochastic_round_bfloat16_fused
+{
+    void operator()(const float *src, uint16_t *dst, uint64_t n, uint64_t offset) const
+    {
+        at::stochastic_round_bfloat16(src, dst, n, 0, offset);
+    }
+};
+
+struct stochastic_round_half_fused
+{
+    void operator()(const float *src, uint16_t *dst, uint64_t n, uint64_t offset) const
+    {
+        at::stochastic_round_half(src, dst, n, 0, offset);
+    }
+};
+
+struct stochastic_round_int8_fused
+{
+    void operator()(const float *src, int8_t *dst, uint64_t n, uint64_t offset) const
+    {
+        at::stochastic_round_int8(src, dst, n, 0.05f, 0, offset);
+    }
+};
+
+/**
+ * The random bits written out first and read back by the rounding, what
+ * the fused kernels replace. The pieces are the same, so is the result
+ */
+template <typename rounder_t>
+struct stochastic_round_two_pass
+{
+    rounder_t r;
+
+    void operator()(const float *src, typename rounder_t::out_t *dst, uint64_t n, uint64_t offset) const
+    {
+        static thread_local std::vector<uint32_t> bits;
+        bits.resize((n + offset % 64 + 63) / 64 * 32);
+        at::philox_simd_engine gen(0, 0, (offset / 64) * 8);
+        at::detail::random_bits(gen, bits.data(), bits.size());
+        const uint16_t *pieces = reinterpret_cast<const uint16_t *>(bits.data()) + offset % 64;
+        uint64_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            r.store8(src + i, dst + i, _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pieces + i))));
+        }
+        if (i < n)
+        {
+            float s[8] = {0};
+            uint16_t p[8] = {0};
+            typename rounder_t::out_t d[8];
+            std::copy(src + i, src + n, s);
+            std::copy(pieces + i, pieces + n, p);
+            r.store8(s, d, _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p)));
+            std::copy(d, d + (n - i), dst + i);
+        }
+    }
+};
+
+static stochastic_round_two_pass<at::detail::stochastic_int8> int8_two_pass()
+{
+    stochastic_round_two_pass<at::detail::stochastic_int8> round;
+    round.r.inv_scale = 1.0f / 0.05f;
+    return round;
+}
+
+std::tuple<double, double, double, double> stochastic_round_bfloat16_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return round_values<uint16_t>(name, loop_count, num_threads, stochastic_round_bfloat16_fused());
+}
+
+std::tuple<double, double, double, double> stochastic_round_bfloat16_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return round_values<uint16_t>(name, loop_count, num_threads, stochastic_round_two_pass<at::detail::stochastic_bfloat16>());
+}
+
+std::tuple<double, double, double, double> stochastic_round_half_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return round_values<uint16_t>(name, loop_count, num_threads, stochastic_round_half_fused());
+}
+
+std::tuple<double, double, double, double> stochastic_round_half_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return round_values<uint16_t>(name, loop_count, num_threads, stochastic_round_two_pass<at::detail::stochastic_half>());
+}
+
+std::tuple<double, double, double, double> stochastic_round_int8_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return round_values<int8_t>(name, loop_count, num_threads, stochastic_round_int8_fused());
+}
+
+std::tuple<double, double, double, double> stochastic_round_int8_two_pass_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return round_values<int8_t>(name, loop_count, num_threads, int8_two_pass());
+}
+
+/**
+ * One call rounding all loop_count values on num_threads threads
+ */
+std::tuple<double, double, double, double> stochastic_round_half_seeded(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<float> src(loop_count, 0.1f);
+    std::vector<uint16_t> dst(loop_count);
+    auto bench = benchmark(name, loop_count, [&](uint64_t) { at::stochastic_round_half(src.data(), dst.data(), loop_count, 0, 0, num_threads); }, 1);
+    std::cout << "Accumulated Y value is " << dst[0] << std::endl;
+    std::cout << name << ": " << loop_count / std::get<0>(bench) << " values/s" << std::endl;
+    return bench;
+}
+
+/**
+ * The input the transforms below read, UNIFORM_BUFFER floats shared by
+ * all threads
+ */
+static const float *transform_source()
+{
+    static const std::vector<float> src = [] {
+        std::vector<float> v(UNIFORM_BUFFER);
+        std::mt19937 mt(1);
+        std::normal_distribution<float> dist;
+        for (float &x : v)
+        {
+            x = dist(mt);
+        }
+        return v;
+    }();
+    return src.data();
+}
+
+/**
+ * Transforms of 8 words at a time, or one, see
+ * Note [Fused generate and transform]: a uniform in [-1, 1), dropout of
+ * src with probability 1/8 and src plus uniform noise in [-1/64, 1/64)
+ */
+struct scale_transform
+{
+    at::detail::uniform_params<float> p;
+
+    scale_transform() : p(-1.0f, 1.0f, at::uniform_interval::closed_open) {}
+
+    __m256 operator()(const float *, __m256i words) const
+    {
+        return at::detail::uniform_float_avx2<false>(words, p);
+    }
+
+    float operator()(const float *, uint32_t word) const
+    {
+        return at::detail::uniform_float_scalar<false>(word, p);
+    }
+};
+
+struct dropout_transform
+{
+    __m256 operator()(const float *src, __m256i words) const
+    {
+        __m256i keep = _mm256_cmpgt_epi32(_mm256_srli_epi32(words, 8), _mm256_set1_epi32((1 << 21) - 1));
+        return _mm256_and_ps(_mm256_castsi256_ps(keep), _mm256_mul_ps(_mm256_loadu_ps(src), _mm256_set1_ps(8.0f / 7.0f)));
+    }
+
+    float operator()(const float *src, uint32_t word) const
+    {
+        return (word >> 8) >= (1 << 21) ? *src * (8.0f / 7.0f) : 0.0f;
+    }
+};
+
+struct add_noise_transform
+{
+    at::detail::uniform_params<float> p;
+
+    add_noise_transform() : p(-1.0f / 64, 1.0f / 64, at::uniform_interval::closed_open) {}
+
+    __m256 operator()(const float *src, __m256i words) const
+    {
+        return _mm256_add_ps(_mm256_loadu_ps(src), at::detail::uniform_float_avx2<false>(words, p));
+    }
+
+    float operator()(const float *src, uint32_t word) const
+    {
+        return *src + at::detail::uniform_float_scalar<false>(word, p);
+    }
+};
+
+/**
+ * The transform applied to the words as generate_transform hands them over
+ */
+template <typename transform_t>
+struct fused_transform_fill
+{
+    transform_t transform;
+
+    void operator()(at::philox_simd_engine &gen, float *dst, uint64_t n) const
+    {
+        const float *src = transform_source();
+        gen.generate_transform(n, [&](uint64_t i, const __m256i(&words)[4], uint64_t count) {
+            if (count == 32)
+            {
+                for (int j = 0; j < 4; j++)
+                {
+                    _mm256_storeu_ps(dst + i + 8 * j, transform(src + i + 8 * j, words[j]));
+                }
+                return;
+            }
+            float s[32] = {0}, d[32];
+            std::copy(src + i, src + i + count, s);
+            for (int j = 0; j < 4; j++)
+            {
+                _mm256_storeu_ps(d + 8 * j, transform(s + 8 * j, words[j]));
+            }
+            std::copy(d, d + count, dst + i);
+        });
+    }
+
+    void operator()(at::philox_engine &gen, float *dst, uint64_t n) const
+    {
+        const float *src = transform_source();
+        gen.generate_transform(n, [&](uint64_t i, uint32_t word) { dst[i] = transform(src + i, word); });
+    }
+};
+
+/**
+ * The words written to a buffer by random_bits and transformed in a
+ * second vectorized pass, what generate_transform replaces
+ */
+template <typename transform_t>
+struct buffered_transform_fill
+{
+    transform_t transform;
+
+    template <typename engine_t>
+    void operator()(engine_t &gen, float *dst, uint64_t n) const
+    {
+        static thread_local std::vector<uint32_t> bits;
+        bits.resize(n);
+        at::detail::random_bits(gen, bits.data(), n);
+        const float *src = transform_source();
+        uint64_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            _mm256_storeu_ps(dst + i, transform(src + i, _mm256_loadu_si256((const __m256i *)(bits.data() + i))));
+        }
+        for (; i < n; i++)
+        {
+            dst[i] = transform(src + i, bits[i]);
+        }
+    }
+};
+
+std::tuple<double, double, double, double> transform_scale_fused_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, fused_transform_fill<scale_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_scale_buffered_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, buffered_transform_fill<scale_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_dropout_fused_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, fused_transform_fill<dropout_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_dropout_buffered_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, buffered_transform_fill<dropout_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_add_noise_fused_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, fused_transform_fill<add_noise_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_add_noise_buffered_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox_simd, buffered_transform_fill<add_noise_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_add_noise_fused_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox, fused_transform_fill<add_noise_transform>(), "values");
+}
+
+std::tuple<double, double, double, double> transform_add_noise_buffered_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<float>(name, loop_count, num_threads, make_philox, buffered_transform_fill<add_noise_transform>(), "values");
+}
+
+/**
+ * The backward pass of dropout with keep probability 0.9 over a tensor of
+ * loop_count elements, each thread taking its slice of the gradient, with
+ * the mask made again from (seed, offset) or read back from the one the
+ * forward pass stored, see Note [Bernoulli mask ranges]. -a and -b sweep
+ * the thread counts and the tensor sizes.
+ */
+template <typename backward_t>
+static std::tuple<double, double, double, double> dropout_backward(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                                   const backward_t &backward, uint64_t mask_bytes)
+{
+    std::vector<float> grad(loop_count, 1.0f), out(loop_count);
+    uint64_t per_thread = loop_count / num_threads;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        uint64_t begin = thread_idx * per_thread;
+        backward(grad.data() + begin, out.data() + begin, begin, per_thread);
+    },
+                           num_threads);
+    std::cout << "Accumulated Y value is " << std::accumulate(out.begin(), out.begin() + std::min<uint64_t>(loop_count, 1024), 0.0) << std::endl;
+    std::cout << name << ": " << loop_count / std::get<0>(bench) << " elements/s, " << mask_bytes / 1e6 << " MB of mask stored" << std::endl;
+    return bench;
+}
+
+static const double kDropoutKeep = 0.9;
+
+struct recompute_backward
+{
+    void operator()(const float *grad, float *out, uint64_t begin, uint64_t n) const
+    {
+        at::bernoulli_mul_range(0, 0, 0, grad, out, begin, n, kDropoutKeep, static_cast<float>(1.0 / kDropoutKeep));
+    }
+};
+
+struct stored_bits_backward
+{
+    const uint32_t *mask;
+
+    void operator()(const float *grad, float *out, uint64_t begin, uint64_t n) const
+    {
+        const float scale = static_cast<float>(1.0 / kDropoutKeep);
+        const __m256 scale_v = _mm256_set1_ps(scale);
+        uint64_t j = begin;
+        for (; j < begin + n && j % 8 != 0; j++)
+        {
+            out[j - begin] = grad[j - begin] * (((mask[j / 32] >> (j % 32)) & 1) ? scale : 0.0f);
+        }
+        for (; j + 8 <= begin + n; j += 8)
+        {
+            __m256 kept = at::detail::expand_floats(mask[j / 32] >> (j % 32), scale_v);
+            _mm256_storeu_ps(out + (j - begin), _mm256_mul_ps(kept, _mm256_loadu_ps(grad + (j - begin))));
+        }
+        for (; j < begin + n; j++)
+        {
+            out[j - begin] = grad[j - begin] * (((mask[j / 32] >> (j % 32)) & 1) ? scale : 0.0f);
+        }
+    }
+};
+
+struct stored_bytes_backward
+{
+    const uint8_t *mask;
+
+    void operator()(const float *grad, float *out, uint64_t begin, uint64_t n) const
+    {
+        const float scale = static_cast<float>(1.0 / kDropoutKeep);
+        const __m256 scale_v = _mm256_set1_ps(scale);
+        uint64_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(mask + begin + i)));
+            __m256 kept = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(bytes, _mm256_setzero_si256())), scale_v);
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(kept, _mm256_loadu_ps(grad + i)));
+        }
+        for (; i < n; i++)
+        {
+            out[i] = grad[i] * (mask[begin + i] ? scale : 0.0f);
+        }
+    }
+};
+
+std::tuple<double, double, double, double> dropout_backward_recompute_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return dropout_backward(name, loop_count, num_threads, recompute_backward(), 0);
+}
+
+std::tuple<double, double, double, double> dropout_backward_stored_bits(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint32_t> mask((loop_count + 31) / 32);
+    at::philox_simd_engine gen(0, 0, 0);
+    at::bernoulli_bits(gen, mask.data(), loop_count, kDropoutKeep);
+    return dropout_backward(name, loop_count, num_threads, stored_bits_backward{mask.data()}, mask.size() * sizeof(uint32_t));
+}
+
+std::tuple<double, double, double, double> dropout_backward_stored_bytes(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<uint8_t> mask(loop_count);
+    at::philox_simd_engine gen(0, 0, 0);
+    at::bernoulli_bytes(gen, mask.data(), loop_count, kDropoutKeep);
+    return dropout_backward(name, loop_count, num_threads, stored_bytes_backward{mask.data()}, mask.size());
+}
+
+struct bytes_fill
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint8_t *dst, uint64_t n) const
+    {
+        gen.fill_bytes(dst, n);
+    }
+};
+
+/**
+ * fill_bytes with every call one byte short of UNIFORM_BUFFER and one byte
+ * off alignment, so each one goes through the word by word tail
+ */
+struct unaligned_bytes_fill
+{
+    template <typename engine_t>
+    void operator()(engine_t &gen, uint8_t *dst, uint64_t n) const
+    {
+        gen.fill_bytes(dst + 1, n - 1);
+    }
+};
+
+std::tuple<double, double, double, double> fill_bytes_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_philox_simd, bytes_fill(), "bytes");
+}
+
+std::tuple<double, double, double, double> fill_bytes_unaligned_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_philox_simd, unaligned_bytes_fill(), "bytes");
+}
+
+std::tuple<double, double, double, double> fill_bytes_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_philox, bytes_fill(), "bytes");
+}
+
+std::tuple<double, double, double, double> fill_bytes_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_xoshiro256, bytes_fill(), "bytes");
+}
+
+std::tuple<double, double, double, double> fill_bytes_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return fill_values<uint8_t>(name, loop_count, num_threads, make_pcg, bytes_fill(), "bytes");
+}
+
+/**
+ * Makes loop_count UUIDs of size bytes each, 256 at a time into a per
+ * thread buffer, see Note [Batch UUIDv4]
+ */
+template <typename fill_t>
+static std::tuple<double, double, double, double> uuid_values(std::string name, uint64_t loop_count, uint64_t num_threads, const fill_t &fill, uint64_t size)
+{
+    const uint64_t batch = 256;
+    std::vector<double> y(num_threads, 0);
+    uint64_t per_thread = loop_count / num_threads;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        at::philox_simd_engine gen = make_philox_simd(thread_idx);
+        std::vector<uint8_t> buffer(batch * size);
+        double z = 0;
+        for (uint64_t i = 0; i < per_thread; i += batch)
+        {
+            fill(gen, buffer.data(), std::min(batch, per_thread - i));
+            z += buffer[0];
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    double x = std::accumulate(y.begin(), y.end(), 0.0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << per_thread / std::get<0>(bench) << " UUIDs/s per thread, " << per_thread * size / std::get<0>(bench) / 1e9
+              << " GB/s per thread" << std::endl;
+    return bench;
+}
+
+struct uuid4_binary_fill
+{
+    void operator()(at::philox_simd_engine &gen, uint8_t *dst, uint64_t count) const
+    {
+        at::uuid4_binary(gen, dst, count);
+    }
+};
+
+struct uuid4_hex_fill
+{
+    void operator()(at::philox_simd_engine &gen, uint8_t *dst, uint64_t count) const
+    {
+        at::uuid4_hex(gen, reinterpret_cast<char *>(dst), count);
+    }
+};
+
+/**
+ * The binary UUIDs formatted a character at a time from a table, what the
+ * pshufb formatting replaces
+ */
+struct uuid4_hex_table_fill
+{
+    void operator()(at::philox_simd_engine &gen, uint8_t *dst, uint64_t count) const
+    {
+        static const char digits[] = "0123456789abcdef";
+        uint8_t uuids[16 * 256];
+        at::uuid4_binary(gen, uuids, count);
+        for (uint64_t k = 0; k < count; k++)
+        {
+            char *text = reinterpret_cast<char *>(dst) + 36 * k;
+            for (int b = 0, c = 0; b < 16; b++)
+            {
+                if (b == 4 || b == 6 || b == 8 || b == 10)
+                {
+                    text[c++] = '-';
+                }
+                text[c++] = digits[uuids[16 * k + b] >> 4];
+                text[c++] = digits[uuids[16 * k + b] & 15];
+            }
+        }
+    }
+};
+
+std::tuple<double, double, double, double> uuid4_binary_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return uuid_values(name, loop_count, num_threads, uuid4_binary_fill(), 16);
+}
+
+std::tuple<double, double, double, double> uuid4_hex_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return uuid_values(name, loop_count, num_threads, uuid4_hex_fill(), 36);
+}
+
+std::tuple<double, double, double, double> uuid4_hex_table_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return uuid_values(name, loop_count, num_threads, uuid4_hex_table_fill(), 36);
+}
+
+/**
+ * Random projection: y = x r for a batch x of kProjectionBatch inputs of
+ * dimension M and an M x kProjectionDim Gaussian matrix r with
+ * M * kProjectionDim = loop_count. r is made kProjectionTileRows rows,
+ * 32 KB, at a time, tile t from subsequence t of seed 0, so any thread can
+ * make any tile and r is the same for any number of threads or order of
+ * work. The tiled run multiplies each tile while it is still in L1, the
+ * other makes all of its tiles first and then reads them back. Each thread
+ * takes a contiguous share of the tiles into its own y.
+ */
+constexpr uint64_t kProjectionBatch = 32;
+constexpr uint64_t kProjectionDim = 256;
+constexpr uint64_t kProjectionTileRows = 32;
+constexpr uint64_t kProjectionTile = kProjectionTileRows * kProjectionDim;
+
+static void projection_tile(uint64_t tile, float *dst)
+{
+    at::philox_simd_engine gen(0, tile, 0);
+    at::normal_float(gen, dst, kProjectionTile, 0.0f, 1.0f);
+}
+
+/**
+ * y += x[:, first, first + kProjectionTileRows) r, x having m columns,
+ * 64 columns of a row of y in registers at a time
+ */
+static void projection_multiply(const float *x, uint64_t m, uint64_t first, const float *r, float *y)
+{
+    for (uint64_t b = 0; b < kProjectionBatch; b++)
+    {
+        for (uint64_t k = 0; k < kProjectionDim; k += 64)
+        {
+            __m256 acc[8];
+            for (int u = 0; u < 8; u++)
+            {
+                acc[u] = _mm256_loadu_ps(y + b * kProjectionDim + k + 8 * u);
+            }
+            for (uint64_t t = 0; t < kProjectionTileRows; t++)
+            {
+                __m256 xv = _mm256_set1_ps(x[b * m + first + t]);
+                for (int u = 0; u < 8; u++)
+                {
+                    acc[u] = _mm256_fmadd_ps(xv, _mm256_loadu_ps(r + t * kProjectionDim + k + 8 * u), acc[u]);
+                }
+            }
+            for (int u = 0; u < 8; u++)
+            {
+                _mm256_storeu_ps(y + b * kProjectionDim + k + 8 * u, acc[u]);
+            }
+        }
+    }
+}
+
+/**
+ * Gaussians per second of one thread making tiles into a buffer that
+ * stays in L1, the best of three runs of up to 256 tiles
+ */
+static double projection_raw_rate(uint64_t tiles)
+{
+    std::vector<float> tile(kProjectionTile);
+    tiles = std::max<uint64_t>(1, std::min<uint64_t>(tiles, 256));
+    double best = std::numeric_limits<double>::infinity();
+    for (int run = 0; run < 3; run++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t t = 0; t < tiles; t++)
+        {
+            projection_tile(t, tile.data());
+        }
+        best = std::min(best, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+    return tiles * kProjectionTile / best;
+}
+
+template <typename run_t>
+static std::tuple<double, double, double, double> random_projection(std::string name, uint64_t loop_count, uint64_t num_threads, const run_t &run,
+                                                                    bool multiplies = true)
+{
+    const uint64_t tiles = loop_count / kProjectionTile;
+    const uint64_t m = tiles * kProjectionTileRows;
+    std::vector<float> x(kProjectionBatch * m);
+    std::mt19937 mt(2);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float &v : x)
+    {
+        v = dist(mt);
+    }
+    std::vector<std::vector<float>> y(num_threads, std::vector<float>(kProjectionBatch * kProjectionDim));
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        std::fill(y[thread_idx].begin(), y[thread_idx].end(), 0.0f);
+        run(x.data(), m, tiles * thread_idx / num_threads, tiles * (thread_idx + 1) / num_threads, y[thread_idx].data());
+    },
+                           num_threads);
+    double sum = 0;
+    for (const auto &part : y)
+    {
+        sum = std::accumulate(part.begin(), part.end(), sum);
+    }
+    double per_thread = static_cast<double>(tiles / num_threads * kProjectionTile);
+    double rate = per_thread / std::get<0>(bench);
+    std::cout << "Accumulated Y value is " << sum << std::endl;
+    std::cout << name << ": " << rate << " Gaussians/s per thread, ";
+    if (multiplies)
+    {
+        std::cout << 2 * kProjectionBatch * rate / 1e9 << " GFLOP/s per thread, ";
+    }
+    std::cout << rate / projection_raw_rate(tiles) << " of the raw engine throughput" << std::endl;
+    return bench;
+}
+
+struct tiled_projection
+{
+    void operator()(const float *x, uint64_t m, uint64_t first, uint64_t last, float *y) const
+    {
+        static thread_local std::vector<float> tile(kProjectionTile);
+        for (uint64_t t = first; t < last; t++)
+        {
+            projection_tile(t, tile.data());
+            projection_multiply(x, m, t * kProjectionTileRows, tile.data(), y);
+        }
+    }
+};
+
+/**
+ * The whole share of r made first, into memory allocated outside the
+ * timing
+ */
+struct full_matrix_projection
+{
+    std::vector<float> *r;
+
+    void operator()(const float *x, uint64_t m, uint64_t first, uint64_t last, float *y) const
+    {
+        float *share = r->data() + first * kProjectionTile;
+        for (uint64_t t = first; t < last; t++)
+        {
+            projection_tile(t, share + (t - first) * kProjectionTile);
+        }
+        for (uint64_t t = first; t < last; t++)
+        {
+            projection_multiply(x, m, t * kProjectionTileRows, share + (t - first) * kProjectionTile, y);
+        }
+    }
+};
+
+/**
+ * The tiles alone, made and thrown away, the throughput the other two are
+ * measured against
+ */
+struct generate_only_projection
+{
+    void operator()(const float *, uint64_t, uint64_t first, uint64_t last, float *y) const
+    {
+        static thread_local std::vector<float> tile(kProjectionTile);
+        for (uint64_t t = first; t < last; t++)
+        {
+            projection_tile(t, tile.data());
+            y[t % (kProjectionBatch * kProjectionDim)] += tile[0];
+        }
+    }
+};
+
+std::tuple<double, double, double, double> random_projection_tiled_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return random_projection(name, loop_count, num_threads, tiled_projection());
+}
+
+std::tuple<double, double, double, double> random_projection_full_matrix_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<float> r(loop_count / kProjectionTile * kProjectionTile);
+    return random_projection(name, loop_count, num_threads, full_matrix_projection{&r});
+}
+
+std::tuple<double, double, double, double> random_projection_generate_only_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return random_projection(name, loop_count, num_threads, generate_only_projection(), false);
+}
+
+/**
+ * Monte Carlo workloads: every draw goes through the transform a real
+ * consumer would apply, so the rates are samples of an application rather
+ * than words. Each workload fills a buffer of UNIFORM_BUFFER draws with
+ * fill(gen, dst, n) and reduces it with consume(src, n), which returns the
+ * sum of its samples. In thread-local mode each thread draws from its own
+ * make_engine(thread_idx). In global mode all threads share
+ * make_engine(0) and hold its mutex only while filling a buffer, so the
+ * transform of one buffer overlaps the draws of the others.
+ */
+constexpr float kOptionSpot = 100.0f;
+constexpr float kOptionStrike = 105.0f;
+constexpr float kOptionRate = 0.05f;
+constexpr float kOptionVolatility = 0.2f;
+constexpr float kOptionExpiry = 1.0f;
+constexpr uint64_t kWalkWords = 32;
+
+/**
+ * Points (u[2i], u[2i + 1]) in the unit square, a sample is 1 when the
+ * point falls inside the quarter circle, and pi is 4 times their mean
+ */
+struct pi_workload
+{
+    typedef float value_t;
+    static constexpr uint64_t kDraws = 2;
+
+    template <typename engine_t>
+    void fill(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::uniform_float(gen, dst, n);
+    }
+
+    double consume(const float *u, uint64_t n) const
+    {
+        uint64_t inside = 0;
+        for (uint64_t i = 0; i + 1 < n; i += 2)
+        {
+            inside += u[i] * u[i] + u[i + 1] * u[i + 1] < 1.0f;
+        }
+        return static_cast<double>(inside);
+    }
+
+    void report(const std::string &name, double mean) const
+    {
+        std::cout << name << ": pi is " << 4 * mean << ", off by " << 4 * mean - M_PI << std::endl;
+    }
+};
+
+/**
+ * A European call under geometric Brownian motion, one ziggurat normal z
+ * per path: S_T = S_0 exp((r - sigma^2 / 2) T + sigma sqrt(T) z), the
+ * sample is max(S_T - K, 0) and the price is its discounted mean. S_T is
+ * eight paths at a time with the exp from SIMDMath.h.
+ */
+struct option_workload
+{
+    typedef float value_t;
+    static constexpr uint64_t kDraws = 1;
+
+    template <typename engine_t>
+    void fill(engine_t &gen, float *dst, uint64_t n) const
+    {
+        at::ziggurat_normal(gen, dst, n);
+    }
+
+    double consume(const float *z, uint64_t n) const
+    {
+        const float drift = (kOptionRate - 0.5f * kOptionVolatility * kOptionVolatility) * kOptionExpiry;
+        const float vol = kOptionVolatility * std::sqrt(kOptionExpiry);
+        __m256 sum = _mm256_setzero_ps();
+        uint64_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 spot = _mm256_mul_ps(_mm256_set1_ps(kOptionSpot),
+                                        at::simd::exp(_mm256_fmadd_ps(_mm256_set1_ps(vol), _mm256_loadu_ps(z + i), _mm256_set1_ps(drift))));
+            sum = _mm256_add_ps(sum, _mm256_max_ps(_mm256_sub_ps(spot, _mm256_set1_ps(kOptionStrike)), _mm256_setzero_ps()));
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, sum);
+        double total = 0;
+        for (float lane : lanes)
+        {
+            total += lane;
+        }
+        for (; i < n; i++)
+        {
+            total += std::max(kOptionSpot * std::exp(drift + vol * z[i]) - kOptionStrike, 0.0f);
+        }
+        return total;
+    }
+
+    void report(const std::string &name, double mean) const
+    {
+        double discount = std::exp(-kOptionRate * kOptionExpiry);
+        double vol = kOptionVolatility * std::sqrt(kOptionExpiry);
+        double d1 = (std::log(kOptionSpot / kOptionStrike) + (kOptionRate + 0.5 * kOptionVolatility * kOptionVolatility) * kOptionExpiry) / vol;
+        double d2 = d1 - vol;
+        double exact = kOptionSpot * 0.5 * std::erfc(-d1 / M_SQRT2) - kOptionStrike * discount * 0.5 * std::erfc(-d2 / M_SQRT2);
+        std::cout << name << ": price is " << discount * mean << ", Black-Scholes " << exact << std::endl;
+    }
+};
+
+/**
+ * A walk of 32 * kWalkWords steps of +-1, one per bit, so a word moves the
+ * walker 2 popcount(word) - 32. The sample is the squared distance from the
+ * start, whose mean is the number of steps.
+ */
+struct walk_workload
+{
+    typedef uint32_t value_t;
+    static constexpr uint64_t kDraws = kWalkWords;
+
+    template <typename engine_t>
+    void fill(engine_t &gen, uint32_t *dst, uint64_t n) const
+    {
+        at::detail::random_bits(gen, dst, n);
+    }
+
+    double consume(const uint32_t *words, uint64_t n) const
+    {
+        double total = 0;
+        for (uint64_t i = 0; i + kWalkWords <= n; i += kWalkWords)
+        {
+            int64_t position = 0;
+            for (uint64_t j = 0; j < kWalkWords; j++)
+            {
+                position += 2 * __builtin_popcount(words[i + j]) - 32;
+            }
+            total += static_cast<double>(position * position);
+        }
+        return total;
+    }
+
+    void report(const std::string &name, double mean) const
+    {
+        std::cout << name << ": mean squared distance over steps is " << mean / (32 * kWalkWords) << std::endl;
+    }
+};
+
+template <typename workload_t, typename engine_t>
+static double monte_carlo_samples(const workload_t &workload, engine_t &gen, std::mutex *mutex, uint64_t draws)
+{
+    std::vector<typename workload_t::value_t> buffer(UNIFORM_BUFFER);
+    double z = 0;
+    for (uint64_t i = 0; i < draws; i += UNIFORM_BUFFER)
+    {
+        uint64_t count = std::min<uint64_t>(UNIFORM_BUFFER, draws - i);
+        if (mutex)
+        {
+            std::lock_guard<std::mutex> lock(*mutex);
+            workload.fill(gen, buffer.data(), count);
+        }
+        else
+        {
+            workload.fill(gen, buffer.data(), count);
+        }
+        z += workload.consume(buffer.data(), count);
+    }
+    return z;
+}
+
+template <typename workload_t, typename make_engine_t>
+static std::tuple<double, double, double, double> monte_carlo(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                              const make_engine_t &make_engine, const workload_t &workload, bool global)
+{
+    std::vector<double> y(num_threads, 0);
+    uint64_t per_thread = loop_count / num_threads;
+    auto shared = make_engine(0);
+    std::mutex mutex;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        if (global)
+        {
+            y[thread_idx] = monte_carlo_samples(workload, shared, &mutex, per_thread);
+        }
+        else
+        {
+            auto gen = make_engine(thread_idx);
+            y[thread_idx] = monte_carlo_samples(workload, gen, nullptr, per_thread);
+        }
+    },
+                           num_threads);
+    double x = std::accumulate(y.begin(), y.end(), 0.0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    uint64_t samples = per_thread / workload_t::kDraws;
+    workload.report(name, x / (samples * num_threads));
+    std::cout << name << ": " << samples / std::get<0>(bench) << " samples/s per thread" << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_xoshiro256, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_pcg, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_std_mt19937, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_at_mt19937, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_rdrand, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd_streams, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_philox_vec8(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_vec8, pi_workload(), false);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_xoshiro256, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_pcg, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_std_mt19937, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_at_mt19937, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_rdrand, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd_streams, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> monte_carlo_pi_global_philox_vec8(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_vec8, pi_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_xoshiro256, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_pcg, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_std_mt19937, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_at_mt19937, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_rdrand, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd_streams, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_philox_vec8(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_vec8, option_workload(), false);
+}
+
+std::tuple<double, double, double, double> european_option_global_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_xoshiro256, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_pcg, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_std_mt19937, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_at_mt19937, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_rdrand, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd_streams, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> european_option_global_philox_vec8(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_vec8, option_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_xoshiro256, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_pcg, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_std_mt19937, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_at_mt19937, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_rdrand, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd_streams, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_philox_vec8(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_vec8, walk_workload(), false);
+}
+
+std::tuple<double, double, double, double> random_walk_global_philox_simd(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_philox(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_xoshiro256, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_pcg, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_std_mt19937, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_at_mt19937, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_rdrand, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_philox_simd_streams(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_simd_streams, walk_workload(), true);
+}
+
+std::tuple<double, double, double, double> random_walk_global_philox_vec8(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return monte_carlo(name, loop_count, num_threads, make_philox_vec8, walk_workload(), true);
+}
+
+/**
+ * Applies fn to a per-thread buffer of MATH_BUFFER inputs in [lo, hi] over
+ * and over until loop_count results have been computed
+ */
+template <math_isa ISA, typename real_t, typename fn_t>
+static std::tuple<double, double, double, double> simd_math(std::string name, uint64_t loop_count, uint64_t num_threads,
+                                                            const fn_t &fn, double lo, double hi, bool geometric = false)
+{
+    std::vector<double> y(num_threads, 0);
+    uint64_t per_thread = loop_count / num_threads;
+    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
+        std::vector<real_t> x = math_sweep<real_t>(lo, hi, MATH_BUFFER, geometric);
+        std::vector<real_t> result(MATH_BUFFER);
+        double z = 0;
+        for (uint64_t i = 0; i < per_thread; i += MATH_BUFFER)
+        {
+            math_map<ISA>(fn, x.data(), result.data(), MATH_BUFFER);
+            z += result[i / MATH_BUFFER % MATH_BUFFER];
+        }
+        y[thread_idx] = z;
+    },
+                           num_threads);
+    double x = std::accumulate(y.begin(), y.end(), 0.0);
+    std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << per_thread / std::get<0>(bench) << " results/s per thread" << std::endl;
+    return bench;
+}
+
+std::tuple<double, double, double, double> simd_math_log_float_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, float>(name, loop_count, num_threads, math_log(), 1e-3, 1e3, true);
+}
+
+std::tuple<double, double, double, double> simd_math_log_float_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, float>(name, loop_count, num_threads, math_log(), 1e-3, 1e3, true);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_log_float_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, float>(name, loop_count, num_threads, math_log(), 1e-3, 1e3, true);
+}
+#endif
+
+std::tuple<double, double, double, double> simd_math_log_double_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, double>(name, loop_count, num_threads, math_log(), 1e-3, 1e3, true);
+}
+
+std::tuple<double, double, double, double> simd_math_log_double_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, double>(name, loop_count, num_threads, math_log(), 1e-3, 1e3, true);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_log_double_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, double>(name, loop_count, num_threads, math_log(), 1e-3, 1e3, true);
+}
+#endif
+
+std::tuple<double, double, double, double> simd_math_exp_float_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, float>(name, loop_count, num_threads, math_exp(), -50, 50);
+}
+
+std::tuple<double, double, double, double> simd_math_exp_float_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, float>(name, loop_count, num_threads, math_exp(), -50, 50);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_exp_float_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, float>(name, loop_count, num_threads, math_exp(), -50, 50);
+}
+#endif
+
+std::tuple<double, double, double, double> simd_math_exp_double_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, double>(name, loop_count, num_threads, math_exp(), -50, 50);
+}
+
+std::tuple<double, double, double, double> simd_math_exp_double_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, double>(name, loop_count, num_threads, math_exp(), -50, 50);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_exp_double_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, double>(name, loop_count, num_threads, math_exp(), -50, 50);
+}
+#endif
+
+std::tuple<double, double, double, double> simd_math_sincos_float_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, float>(name, loop_count, num_threads, math_sincos<2>(), -100, 100);
+}
+
+std::tuple<double, double, double, double> simd_math_sincos_float_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, float>(name, loop_count, num_threads, math_sincos<2>(), -100, 100);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sincos_float_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, float>(name, loop_count, num_threads, math_sincos<2>(), -100, 100);
+}
+#endif
+
+std::tuple<double, double, double, double> simd_math_sincos_double_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, double>(name, loop_count, num_threads, math_sincos<2>(), -100, 100);
+}
+
+std::tuple<double, double, double, double> simd_math_sincos_double_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, double>(name, loop_count, num_threads, math_sincos<2>(), -100, 100);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sincos_double_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, double>(name, loop_count, num_threads, math_sincos<2>(), -100, 100);
+}
+#endif
+
+std::tuple<double, double, double, double> simd_math_sqrt_float_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, float>(name, loop_count, num_threads, math_sqrt(), 1e-3, 1e3, true);
+}
+
+std::tuple<double, double, double, double> simd_math_sqrt_float_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx2, float>(name, loop_count, num_threads, math_sqrt(), 1e-3, 1e3, true);
+}
+
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sqrt_float_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, float>(name, loop_count, num_threads, math_sqrt(), 1e-3, 1e3, true);
+}
+#endif
 
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+std::tuple<double, double, double, double> simd_math_sqrt_double_libm(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::libm, double>(name, loop_count, num_threads, math_sqrt(), 1e-3, 1e3, true);
 }
 
-std::tuple<double, double, double, double> philox_simd_thread_local_instance(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> simd_math_sqrt_double_avx2(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
-    uint64_t step = 1024 / 32;
-    __m256i y[num_threads];
-    memset(y, 0, sizeof(y[0]) * num_threads);
-    std::vector<at::philox_simd_engine> engines;
-    for (uint64_t i = 0; i < num_threads; ++i)
-    {
-        engines.emplace_back(0, i, 0);
-    }
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        __m256i a, b, c, d;
-        __m256i v = _mm256_set1_epi32(0);
-        auto &gen = engines[thread_idx];
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
-        {
-           
-            gen.next32(a, b, c, d);
-            v = _mm256_add_epi32(v, a);
-            v = _mm256_add_epi32(v, b);
-            v = _mm256_add_epi32(v, c);
-            v = _mm256_add_epi32(v, d);
-        }
-        y[thread_idx] = v;
-    },
-                           num_threads);
-    uint32_t x = 0;
-    uint32_t values[8];
-    for (uint64_t j = 0; j < num_threads; ++j)
-    {
-        _mm256_storeu_si256((__m256i *)values, y[j]);
-        for (int i = 0; i < 8; i++)
-        {
-            x += values[i];
-        }
-    }
+    return simd_math<math_isa::avx2, double>(name, loop_count, num_threads, math_sqrt(), 1e-3, 1e3, true);
+}
 
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+#ifdef __AVX512F__
+std::tuple<double, double, double, double> simd_math_sqrt_double_avx512(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return simd_math<math_isa::avx512, double>(name, loop_count, num_threads, math_sqrt(), 1e-3, 1e3, true);
 }
+#endif
 
-std::tuple<double, double, double, double> xoshiro256(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+static inline void sobol_generate(at::sobol_engine &gen, float *dst, uint64_t num_points)
 {
-    std::vector<uint64_t> y(num_threads, 0);
-    xoshiro256starstar_engine gen1(0);
-    std::mutex mutex;
-    uint64_t step = 64 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint64_t z = 0;
-        std::lock_guard<std::mutex> lock(mutex);
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
-        {
-            z += gen1.next();
-        }
-        y[thread_idx] = z;
-    },
-                           num_threads);
-    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    gen.generate_float(dst, num_points);
 }
 
-std::tuple<double, double, double, double> at_pcg(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+static inline void sobol_generate(at::sobol_engine &gen, double *dst, uint64_t num_points)
 {
-    std::vector<uint64_t> y(num_threads, 0);
-    at::pcg gen1;
-    std::mutex mutex;
-    uint64_t step = 64 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint64_t z = 0;
-        std::lock_guard<std::mutex> lock(mutex);
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
-        {
-            z += gen1();
-        }
-        y[thread_idx] = z;
-    },
-                           num_threads);
-    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    gen.generate_double(dst, num_points);
 }
 
-std::tuple<double, double, double, double> at_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+template <typename real_t>
+static std::tuple<double, double, double, double> sobol_thread_local(std::string name, uint64_t loop_count, uint64_t num_threads, uint32_t dims)
 {
-    std::vector<uint32_t> y(num_threads, 0);
-    at::mt19937 gen1;
-    std::mutex mutex;
-    uint64_t step = 32 / 32;
+    // loop_count counts coordinates, every thread walks its own block of points
+    uint64_t points_per_thread = loop_count / num_threads / dims;
+    std::vector<at::sobol_engine> engines;
+    std::vector<std::vector<real_t>> buffers(num_threads, std::vector<real_t>(SOBOL_BATCH_POINTS * dims));
+    for (uint64_t i = 0; i < num_threads; ++i)
+    {
+        engines.emplace_back(dims, i * points_per_thread);
+    }
+    std::vector<real_t> y(num_threads, 0);
     auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t z = 0;
-        std::lock_guard<std::mutex> lock(mutex);
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
+        real_t local = 0;
+        auto &gen = engines[thread_idx];
+        real_t *buffer = buffers[thread_idx].data();
+        gen.skip_to(thread_idx * points_per_thread);
+        for (uint64_t p = 0; p < points_per_thread; p += SOBOL_BATCH_POINTS)
         {
-            z += gen1();
+            uint64_t n = std::min(SOBOL_BATCH_POINTS, points_per_thread - p);
+            sobol_generate(gen, buffer, n);
+            local += buffer[0] + buffer[n * dims - 1];
         }
-        y[thread_idx] = z;
+        y[thread_idx] = local;
     },
                            num_threads);
-    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
+    real_t x = std::accumulate(y.begin(), y.end(), real_t(0));
     std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << points_per_thread / std::get<0>(bench) << " points/s per thread (values/s per dimension), "
+              << points_per_thread * dims / std::get<0>(bench) << " values/s per thread" << std::endl;
     return bench;
 }
 
-std::tuple<double, double, double, double> std_mt19937(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> sobol_16_float(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
-    std::vector<uint32_t> y(num_threads, 0);
-    std::mt19937 gen1;
-    std::mutex mutex;
-    uint64_t step = 32 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t z = 0;
-        std::lock_guard<std::mutex> lock(mutex);
-        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
-        {
-            z = gen1();
-        }
-        y[thread_idx] = z;
-    },
-                           num_threads);
-    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    return sobol_thread_local<float>(name, loop_count, num_threads, 16);
 }
 
-std::tuple<double, double, double, double> xoshiro256_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> sobol_1024_float(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
-    std::vector<uint64_t> y(num_threads, 0);
-    xoshiro256starstar_engine gen1(0);
-    std::mutex mutex;
-    uint64_t step = 64 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint64_t z = 0;
-        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            for(int k = 0; k < 1<<20; k++)
-            { 
-                z += gen1.next();
-            }
-        }
-        y[thread_idx] = z;
-    },
-                           num_threads);
-    uint64_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    return sobol_thread_local<float>(name, loop_count, num_threads, 1024);
 }
 
-std::tuple<double, double, double, double> at_pcg_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> sobol_1024_double(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    return sobol_thread_local<double>(name, loop_count, num_threads, 1024);
+}
+
+std::tuple<double, double, double, double> rdrand_thread_local(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
     std::vector<uint64_t> y(num_threads, 0);
-    at::pcg gen1;
-    std::mutex mutex;
     uint64_t step = 64 / 32;
+    std::vector<at::rdrand_engine> engines(num_threads);
     auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
         uint64_t z = 0;
-        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        auto &gen1 = engines[thread_idx];
+        for (uint64_t i = 0; i < loop_count / num_threads; i += step)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            for(int k = 0; k < 1<<20; k++)
-            {
-                z += gen1();
-            }
+            z += gen1();
         }
         y[thread_idx] = z;
     },
                            num_threads);
     uint64_t x = std::accumulate(y.begin(), y.end(), 0);
     std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << std::get<0>(bench) * 1e9 / (loop_count / num_threads / step) << " ns per 64-bit draw" << std::endl;
     return bench;
 }
 
-std::tuple<double, double, double, double> at_mt19937_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+/**
+ * Seeds one philox engine per RANDOMS_PER_SEED randoms from seed_fn(thread_idx)
+ * and draws a block from it, which is the seeding pattern of short-lived
+ * per-request generators.
+ */
+template <typename seed_fn_t>
+static std::tuple<double, double, double, double> seeding(std::string name, uint64_t loop_count, uint64_t num_threads, const seed_fn_t &seed_fn)
 {
     std::vector<uint32_t> y(num_threads, 0);
-    at::mt19937 gen1;
-    std::mutex mutex;
-    uint64_t step = 32 / 32;
+    uint64_t seeds_per_thread = std::max<uint64_t>(loop_count / num_threads / RANDOMS_PER_SEED, 1);
     auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t z = 0;
-        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
+        uint32_t local = 0;
+        for (uint64_t i = 0; i < seeds_per_thread; i++)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            for(int k = 0; k < 1<<20; k++)
-            {
-                z += gen1();
-            }
+            at::philox_engine gen1(seed_fn(thread_idx), thread_idx, 0);
+            local += gen1.next()[0];
         }
-        y[thread_idx] = z;
+        y[thread_idx] = local;
     },
                            num_threads);
     uint32_t x = std::accumulate(y.begin(), y.end(), 0);
     std::cout << "Accumulated Y value is " << x << std::endl;
+    std::cout << name << ": " << std::get<0>(bench) * 1e9 / seeds_per_thread << " ns per seeded generator, "
+              << seeds_per_thread / std::get<0>(bench) << " generators/s per thread" << std::endl;
     return bench;
 }
 
-std::tuple<double, double, double, double> std_mt19937_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> seeding_rdseed(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
-    std::vector<uint32_t> y(num_threads, 0);
-    std::mt19937 gen1;
-    std::mutex mutex;
-    uint64_t step = 32 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t z = 0;
-        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            for(int k = 0; k < 1<<20; k++)
-            {
-                z = gen1();
-            }
-        }
-        y[thread_idx] = z;
-    },
-                           num_threads);
-    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    return seeding(name, loop_count, num_threads, [](uint64_t) { return at::hardware_seed(); });
 }
 
-std::tuple<double, double, double, double> philox_global_instance_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> seeding_rdrand(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
-    std::vector<uint32_t> y(num_threads, 0);
-    at::philox_engine gen1(0, 0, 0);
-    std::mutex mutex;
-    uint64_t step = 128 / 32;
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        uint32_t local = 0;
-        at::detail::Array<uint32_t, 4> z;
-        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            for(int k = 0; k < 1<<20; k++)
-            {
-                z = gen1.next();
-
-                local += z[0];
-                local += z[1];
-                local += z[2];
-                local += z[3];
-            }
-        }
-
-        y[thread_idx] = local;
-    },
-                           num_threads);
-    uint32_t x = std::accumulate(y.begin(), y.end(), 0);
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+    return seeding(name, loop_count, num_threads, [](uint64_t) { return at::rdrand64(); });
 }
 
-std::tuple<double, double, double, double> philox_simd_global_instance_chunking(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+std::tuple<double, double, double, double> seeding_getrandom(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
 {
-    at::philox_simd_engine gen(0, 0, 0);
-    std::mutex mutex;
-    uint64_t step = 1024 / 32;
-
-    __m256i y[num_threads];
-    memset(y, 0, sizeof(y[0]) * num_threads);
-    auto bench = benchmark(name, loop_count, [&](uint64_t thread_idx) {
-        __m256i a, b, c, d;
-        __m256i v = _mm256_set1_epi32(0);
-        for (uint64_t i = 0; i < (loop_count / num_threads)>>20; i += step)
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            for(int k = 0; k < 1<<20; k++)
-            {
-                gen.next32(a, b, c, d);
-                v = _mm256_add_epi32(v, a);
-                v = _mm256_add_epi32(v, b);
-                v = _mm256_add_epi32(v, c);
-                v = _mm256_add_epi32(v, d);
-            }
-        }
-        y[thread_idx] = v;
-    },
-                           num_threads);
+    return seeding(name, loop_count, num_threads, [](uint64_t) { return at::getrandom64(); });
+}
 
-    uint32_t x = 0;
-    uint32_t values[8];
-    for (uint64_t j = 0; j < num_threads; ++j)
+std::tuple<double, double, double, double> seeding_random_device(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    std::vector<std::unique_ptr<std::random_device>> devices;
+    for (uint64_t i = 0; i < num_threads; ++i)
     {
-        _mm256_storeu_si256((__m256i *)values, y[j]);
-        for (int i = 0; i < 8; i++)
-        {
-            x += values[i];
-        }
+        devices.emplace_back(new std::random_device());
     }
+    return seeding(name, loop_count, num_threads, [&](uint64_t thread_idx) {
+        std::random_device &rd = *devices[thread_idx];
+        return (static_cast<uint64_t>(rd()) << 32) | rd();
+    });
+}
 
-    std::cout << "Accumulated Y value is " << x << std::endl;
-    return bench;
+std::tuple<double, double, double, double> seeding_splitmix64(std::string name, uint64_t loop_count = 134217728UL, uint64_t num_threads = 1)
+{
+    // software baseline: seeds derived from one hardware seed per thread
+    std::vector<uint64_t> states(num_threads);
+    for (uint64_t i = 0; i < num_threads; ++i)
+    {
+        states[i] = at::hardware_seed();
+    }
+    return seeding(name, loop_count, num_threads, [&](uint64_t thread_idx) { return splitmix64(states[thread_idx]); });
 }
@@ -1,4 +1,7 @@
+#pragma once
+
 #include <stdint.h>
+#include <string.h>
 #include "splitmix64.h"
 
 // Modified from
@@ -38,4 +41,23 @@ uint64_t next(void) {
     return result_starstar;
 }
 
+// writes len bytes of the next values of next() to dst, see
+// Note [Random bytes] in PhiloxSIMD.h
+void fill_bytes(void* dst, uint64_t len) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (uint64_t i = 0; i < len; i += 8) {
+        uint64_t word = next();
+        memcpy(out + i, &word, len - i < 8 ? len - i : 8);
+    }
+}
+
+// hands the next n values of next() to fn(i, word), see
+// Note [Fused generate and transform] in PhiloxSIMD.h
+template <typename fn_t>
+void generate_transform(uint64_t n, const fn_t& fn) {
+    for (uint64_t i = 0; i < n; i++) {
+        fn(i, next());
+    }
+}
+
 };